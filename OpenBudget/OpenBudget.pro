@@ -14,17 +14,35 @@ SOURCES += \
     addcategorydialog.cpp \
     addsubcategorydialog.cpp \
     addtransactiondialog.cpp \
+    asyncdatabase.cpp \
+    balancepyramid.cpp \
     budget.cpp \
+    budgetdialog.cpp \
+    budgetengine.cpp \
+    categorycache.cpp \
+    categorymodel.cpp \
+    changenotifier.cpp \
+    currencydelegate.cpp \
     database.cpp \
     deletetransactiondialog.cpp \
+    downsampler.cpp \
+    durabilityprofile.cpp \
+    importdialog.cpp \
     linechartdialog.cpp \
     linkbutton.cpp \
     logindialog.cpp \
     main.cpp \
     mainwindow.cpp \
+    money.cpp \
+    passwordhasher.cpp \
     passwordresetdialog.cpp \
     registerdialog.cpp \
+    schemamigrator.cpp \
+    session.cpp \
+    statementimporter.cpp \
+    statementparser.cpp \
     transaction.cpp \
+    transactiontablemodel.cpp \
     user.cpp \
     userlogin.cpp
 
@@ -33,17 +51,36 @@ HEADERS += \
     addcategorydialog.h \
     addsubcategorydialog.h \
     addtransactiondialog.h \
+    asyncdatabase.h \
+    balancepyramid.h \
+    boundedqueue.h \
     budget.h \
+    budgetdialog.h \
+    budgetengine.h \
+    categorycache.h \
+    categorymodel.h \
+    changenotifier.h \
+    currencydelegate.h \
     database.h \
     deletetransactiondialog.h \
+    downsampler.h \
+    durabilityprofile.h \
+    importdialog.h \
     linechartdialog.h \
     linkbutton.h \
     logindialog.h \
     mainwindow.h \
+    money.h \
+    passwordhasher.h \
     passwordresetdialog.h \
     position.h \
     registerdialog.h \
+    schemamigrator.h \
+    session.h \
+    statementimporter.h \
+    statementparser.h \
     transaction.h \
+    transactiontablemodel.h \
     user.h \
     userlogin.h
 
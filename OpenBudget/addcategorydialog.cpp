@@ -1,16 +1,21 @@
 #include "addcategorydialog.h"
 #include <QMessageBox>
-#include "database.h"
+#include "asyncdatabase.h"
+#include "session.h"
+
+namespace {
+// Outcome of adding a category on the database thread.
+enum class AddResult { Added, Exists, Failed };
+} // namespace
 
 /**
- * @brief Allows user to add a category to the database.
+ * @brief Allows the logged in user to add a category to the database.
  * 
- * @param userID ID of the user adding the category.
  * @param parent Pointer to the parent widget.
  */
-AddCategoryDialog::AddCategoryDialog(int userID, QWidget *parent)
+AddCategoryDialog::AddCategoryDialog(QWidget *parent)
     : QDialog{parent}
-    , m_userID{userID}
+    , m_userID{Session::getInstance()->userID()}
 {
     setWindowTitle("Add Category");
 
@@ -33,7 +38,7 @@ AddCategoryDialog::AddCategoryDialog(int userID, QWidget *parent)
     // Button Box
     QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok
                                                        | QDialogButtonBox::Cancel);
-    QPushButton *addButton = buttonBox->button(QDialogButtonBox::Ok);
+    addButton = buttonBox->button(QDialogButtonBox::Ok);
 
     // Set the text for the add button
     addButton->setText("Add");
@@ -53,16 +58,13 @@ AddCategoryDialog::AddCategoryDialog(int userID, QWidget *parent)
 
 /**
  * @brief Attempts to insert a new category into the database.
+ *        The name is checked and the category created on the database thread.
  */
 void AddCategoryDialog::addCategory()
 {
     // Get the category name from the line edit
     QString categoryName = categoryNameLineEdit->text();
 
-    // Create a database instance
-    Database *db;
-    db = Database::getInstance();
-
     // Check if the category name is empty
     if (categoryName.isEmpty()) {
         // Display an error message
@@ -70,26 +72,37 @@ void AddCategoryDialog::addCategory()
         return;
     }
 
-    // Check if the category name already exists
-    QMap<int, QString> categories = db->getCategoryNames(m_userID);
-    if (categories.values().contains(categoryName)) {
-        // Clear the line edit
-        categoryNameLineEdit->clear();
-        // Display an error message
-        QMessageBox::critical(this, "Error", "Category name already exists.");
-        return;
-    }
-
-    // Add the category to the database
-    if (db->createCategory(categoryName, m_userID)) {
-        // If the category was added successfully, show a success message
-        QMessageBox::information(this, "Success", "Category added.");
-        // Emit the categoryAdded signal
-        emit categoryAdded();
-        // Close the dialog
-        accept();
-    } else {
-        // Display an error message
-        QMessageBox::critical(this, "Error", "Category could not be added.");
-    }
+    // Disable the add button until the category has been added
+    addButton->setEnabled(false);
+
+    // Add the category unless the name already exists
+    int userID = m_userID;
+    AsyncDatabase *db = AsyncDatabase::getInstance();
+    db->run([categoryName, userID](Database &db) {
+          if (db.findCategoryID(userID, categoryName)) {
+              return AddResult::Exists;
+          }
+          return db.createCategory(categoryName, userID) ? AddResult::Added : AddResult::Failed;
+      })
+        .then(this, [this](AddResult result) {
+            // Allow another attempt
+            addButton->setEnabled(true);
+
+            if (result == AddResult::Exists) {
+                // Clear the line edit
+                categoryNameLineEdit->clear();
+                // Display an error message
+                QMessageBox::critical(this, "Error", "Category name already exists.");
+            } else if (result == AddResult::Added) {
+                // If the category was added successfully, show a success message
+                QMessageBox::information(this, "Success", "Category added.");
+                // Emit the categoryAdded signal
+                emit categoryAdded();
+                // Close the dialog
+                accept();
+            } else {
+                // Display an error message
+                QMessageBox::critical(this, "Error", "Category could not be added.");
+            }
+        });
 }
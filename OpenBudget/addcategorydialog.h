@@ -15,7 +15,7 @@ class AddCategoryDialog : public QDialog
     Q_OBJECT
 
 public:
-    AddCategoryDialog(int userID, QWidget *parent = nullptr);
+    AddCategoryDialog(QWidget *parent = nullptr);
 
 signals:
     void categoryAdded(); // Signal to indicate that a category has been added.
@@ -25,6 +25,7 @@ private slots:
 
 private:
     QLineEdit *categoryNameLineEdit;
+    QPushButton *addButton = nullptr;
 
 private:
     int m_userID;
@@ -1,16 +1,22 @@
 #include "addsubcategorydialog.h"
 #include <QMessageBox>
-#include "database.h"
+#include "categorymodel.h"
+#include "asyncdatabase.h"
+#include "session.h"
+
+namespace {
+// Outcome of adding a subcategory on the database thread.
+enum class AddResult { Added, Exists, Failed };
+} // namespace
 
 /**
- * @brief Allows the user to add a subcategory to the database.
+ * @brief Allows the logged in user to add a subcategory to the database.
  * 
- * @param userID ID of the user adding the subcategory.
  * @param parent Pointer to the parent widget.
  */
-AddSubcategoryDialog::AddSubcategoryDialog(int userID, QWidget *parent)
+AddSubcategoryDialog::AddSubcategoryDialog(QWidget *parent)
     : QDialog{parent}
-    , m_userID{userID}
+    , m_userID{Session::getInstance()->userID()}
 {
     setWindowTitle("Add Category");
 
@@ -27,11 +33,11 @@ AddSubcategoryDialog::AddSubcategoryDialog(int userID, QWidget *parent)
     // Combo box for category names
     categoryCombo = new QComboBox();
 
-    // Add default item to categoryCombo
-    categoryCombo->addItem("Select a category", -1);
-
-    // Load categories from the database
-    loadCategories();
+    // Show the shared categories after the default item and Deposit
+    categoryCombo->setModel(CategoryModel::withPlaceholders(m_userID,
+                                                            {{"Select a category", -1},
+                                                             {"Deposit", 0}},
+                                                            this));
 
     // Add widgets to the layout
     layout->addWidget(subcategoryNameLineEdit);
@@ -43,7 +49,7 @@ AddSubcategoryDialog::AddSubcategoryDialog(int userID, QWidget *parent)
     // Button Box
     QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok
                                                        | QDialogButtonBox::Cancel);
-    QPushButton *addButton = buttonBox->button(QDialogButtonBox::Ok);
+    addButton = buttonBox->button(QDialogButtonBox::Ok);
 
     // Set the text for the add button
     addButton->setText("Add");
@@ -64,6 +70,7 @@ AddSubcategoryDialog::AddSubcategoryDialog(int userID, QWidget *parent)
 
 /**
  * @brief Attempts to insert a new subcategory into the database.
+ *        The name is checked and the subcategory created on the database thread.
  */
 void AddSubcategoryDialog::addSubcategory()
 {
@@ -73,10 +80,6 @@ void AddSubcategoryDialog::addSubcategory()
     // Get the category ID from the combo box
     int categoryID = categoryCombo->currentData().toInt();
 
-    // Create a database instance
-    Database *db;
-    db = Database::getInstance();
-
     // Check if the category name is empty
     if (subcategoryName.isEmpty()) {
         // Display an error message
@@ -84,51 +87,38 @@ void AddSubcategoryDialog::addSubcategory()
         return;
     }
 
-    // Check if the subcategory name already exists
-    QMap<int, QString> subcategories = db->getSubcategoryNames(m_userID, categoryID);
-    if (subcategories.values().contains(subcategoryName)) {
-        // Clear the line edit
-        subcategoryNameLineEdit->clear();
-        // Display an error message
-        QMessageBox::critical(this, "Error", "Subategory name already exists.");
-        return;
-    }
-
-    // Add the category to the database
-    if (db->createSubcategory(subcategoryName, m_userID, categoryID)) {
-        // If the category was added successfully, show a success message
-        QMessageBox::information(this, "Success", "Category added.");
-        // Emit the categoryAdded signal
-        emit subcategoryAdded();
-        // Close the dialog
-        accept();
-    } else {
-        // Display an error message
-        QMessageBox::critical(this, "Error", "Category could not be added.");
-    }
-}
-
-/**
- * @brief Retrieves the user's categories from the database and 
- *        adds them to the category combo box.
- */
-void AddSubcategoryDialog::loadCategories()
-{
-    // Get user's categories from database
-    Database *db = Database::getInstance();
-    QMap<int, QString> categories = db->getCategoryNames(m_userID);
-
-    // Clear the combo box
-    categoryCombo->clear();
-
-    // Add a default item
-    categoryCombo->addItem("Select a category", -1);
-
-    // Add Deposit item
-    categoryCombo->addItem("Deposit", 0);
-
-    // Add the categories and their ID's to the combo box
-    for (auto category = categories.begin(); category != categories.end(); ++category) {
-        categoryCombo->addItem(category.value(), category.key());
-    }
+    // Disable the add button until the subcategory has been added
+    addButton->setEnabled(false);
+
+    // Add the subcategory unless the name already exists in the category
+    int userID = m_userID;
+    AsyncDatabase *db = AsyncDatabase::getInstance();
+    db->run([subcategoryName, userID, categoryID](Database &db) {
+          if (db.findSubcategoryID(userID, categoryID, subcategoryName)) {
+              return AddResult::Exists;
+          }
+          return db.createSubcategory(subcategoryName, userID, categoryID) ? AddResult::Added
+                                                                           : AddResult::Failed;
+      })
+        .then(this, [this](AddResult result) {
+            // Allow another attempt
+            addButton->setEnabled(true);
+
+            if (result == AddResult::Exists) {
+                // Clear the line edit
+                subcategoryNameLineEdit->clear();
+                // Display an error message
+                QMessageBox::critical(this, "Error", "Subategory name already exists.");
+            } else if (result == AddResult::Added) {
+                // If the category was added successfully, show a success message
+                QMessageBox::information(this, "Success", "Category added.");
+                // Emit the categoryAdded signal
+                emit subcategoryAdded();
+                // Close the dialog
+                accept();
+            } else {
+                // Display an error message
+                QMessageBox::critical(this, "Error", "Category could not be added.");
+            }
+        });
 }
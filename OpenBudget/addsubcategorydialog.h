@@ -16,7 +16,7 @@ class AddSubcategoryDialog : public QDialog
     Q_OBJECT
 
 public:
-    AddSubcategoryDialog(int userID, QWidget *parent = nullptr);
+    AddSubcategoryDialog(QWidget *parent = nullptr);
 
 signals:
     void subcategoryAdded(); // Signal to indicate that a category has been added.
@@ -29,9 +29,6 @@ private:
     QComboBox *categoryCombo = nullptr;
     QPushButton *addButton = nullptr;
 
-private:
-    void loadCategories(); // Load categories from the database.
-
 private:
     int m_userID;
 };
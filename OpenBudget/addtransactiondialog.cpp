@@ -1,17 +1,18 @@
 #include "addtransactiondialog.h"
 #include <QMessageBox>
-#include "database.h"
+#include "asyncdatabase.h"
+#include "categorymodel.h"
+#include "session.h"
 #include "transaction.h"
 
 /**
- * @brief Allows the user to add a new transaction to the database.
+ * @brief Allows the logged in user to add a new transaction to the database.
  * 
  * @param parent Pointer to the parent widget.
- * @param userID ID of the user adding the transaction.
  */
-AddTransactionDialog::AddTransactionDialog(QWidget *parent, int userID)
+AddTransactionDialog::AddTransactionDialog(QWidget *parent)
     : QDialog{parent}
-    , m_userID{userID}
+    , m_userID{Session::getInstance()->userID()}
 {
     setWindowTitle("Add Transaction");
 
@@ -33,8 +34,15 @@ AddTransactionDialog::AddTransactionDialog(QWidget *parent, int userID)
     QValidator *validator = new QDoubleValidator(0.0, 1000000.0, 2, amountLineEdit);
     amountLineEdit->setValidator(validator);
 
-    // Add categories and subcategories to the combo boxes (replace with actual data)
-    loadCategories();
+    // Show the shared categories after the default item and Deposit
+    categoryCombo->setModel(CategoryModel::withPlaceholders(m_userID,
+                                                            {{"Select a category", -1},
+                                                             {"Deposit", 0}},
+                                                            this));
+    // Show the selected category's subcategories; no selection means no subcategory
+    subcategoryComboBox->setModel(CategoryModel::forUser(m_userID));
+    subcategoryComboBox->setPlaceholderText("None");
+    subcategoryComboBox->setCurrentIndex(-1);
     // Disable subcategory combobox until a category is selected
     subcategoryComboBox->setEnabled(false);
 
@@ -93,45 +101,53 @@ AddTransactionDialog::AddTransactionDialog(QWidget *parent, int userID)
 void AddTransactionDialog::addTransaction()
 {
     // Get the transaction values from the widgets
-    double amount = amountLineEdit->text().toDouble();
+    std::optional<Money> amount = Money::fromString(amountLineEdit->text());
     QString description = descriptionTextEdit->toPlainText();
-    QString date = dateEdit->date().toString("MM/dd/yyyy");
+    QDate date = dateEdit->date();
     int category = categoryCombo->currentData().toInt();
-    int subcategory = subcategoryComboBox->currentData().toInt();
+    // No subcategory is selected when the combo box shows its placeholder
+    int subcategory = subcategoryComboBox->currentIndex() == -1
+                          ? 0
+                          : subcategoryComboBox->currentData().toInt();
     bool isDeposit = false;
 
+    // If the amount could not be read, there is nothing to add
+    if (!amount) {
+        QMessageBox::critical(this, "Error", "The amount is not valid. Please try again.");
+        return;
+    }
+
     // If category is 1, then it is a deposit
     if (category == 0) {
         isDeposit = true;
     }
-    // If subcategory is -1, then set it to 0
-    if (subcategory == -1) {
-        subcategory = 0;
-    }
+
+    // Disable the add button until the transaction has been added
+    addButton->setEnabled(false);
 
     // Add the transaction to the database
-    Database *db = Database::getInstance();
-    Transaction *transaction = db->createTransaction(amount,
-                                                     description,
-                                                     date,
-                                                     category,
-                                                     subcategory,
-                                                     m_userID,
-                                                     isDeposit);
-    // If the transaction was added successfully
-    if (transaction != nullptr) {
-        // Create a message box to notify the user.
-        QMessageBox::information(this, "Success", "The transaction was added successfully.");
-        // Emit the transactionAdded signal
-        emit transactionAdded();
-        // Close the dialog
-        accept();
-    } else {
-        // If the transaction was not added successfully, display an error message
-        QMessageBox::critical(this,
-                              "Error",
-                              "The transaction could not be added. Please try again.");
-    }
+    AsyncDatabase *db = AsyncDatabase::getInstance();
+    db->createTransaction(*amount, description, date, category, subcategory, m_userID, isDeposit)
+        .then(this, [this](const std::optional<Transaction> &transaction) {
+            // If the transaction was added successfully
+            if (transaction) {
+                // Create a message box to notify the user.
+                QMessageBox::information(this,
+                                         "Success",
+                                         "The transaction was added successfully.");
+                // Emit the transactionAdded signal
+                emit transactionAdded();
+                // Close the dialog
+                accept();
+            } else {
+                // If the transaction was not added successfully, display an error message
+                QMessageBox::critical(this,
+                                      "Error",
+                                      "The transaction could not be added. Please try again.");
+                // Allow another attempt
+                enableAddButton();
+            }
+        });
 }
 
 /**
@@ -143,30 +159,6 @@ void AddTransactionDialog::cancelAddTransaction()
     reject();
 }
 
-/**
- * @brief Retrieves the user's categories from the database and 
- *        adds them to the category combo box.
- */
-void AddTransactionDialog::loadCategories()
-{
-    // Get user's categories from database
-    Database *db = Database::getInstance();
-    QMap<int, QString> categories = db->getCategoryNames(m_userID);
-
-    // Clear the combo box
-    categoryCombo->clear();
-
-    // Add a default item
-    categoryCombo->addItem("Select a category", -1);
-    // Add deposit category
-    categoryCombo->addItem("Deposit", 0);
-
-    // Add the categories and their ID's to the combo box
-    for (auto category = categories.begin(); category != categories.end(); ++category) {
-        categoryCombo->addItem(category.value(), category.key());
-    }
-}
-
 /**
  * @brief When the user selects a category, enable/disable the subcategory combo box and add button.
  */
@@ -182,37 +174,17 @@ void AddTransactionDialog::categoryChanged()
     if (categoryID <= 0) {
         // Disable the subcategory combo box
         subcategoryComboBox->setEnabled(false);
+        subcategoryComboBox->setCurrentIndex(-1);
     } else {
         // Enable the subcategory combo box
         subcategoryComboBox->setEnabled(true);
 
-        // Load the subcategories for the selected category
-        loadSubcategories(categoryID);
-    }
-}
-
-/**
- * @brief Retrieves the subcategories for the given category ID from the database and
- *        add them to the subcategory combo box.
- *        
- * @param categoryID The ID of the category to get subcategories for.
- */
-void AddTransactionDialog::loadSubcategories(int categoryID)
-{
-    // Get user's subcategories from database
-    Database *db = Database::getInstance();
-    QMap<int, QString> subcategories = db->getSubcategoryNames(m_userID, categoryID);
-
-    // Clear the combo box
-    subcategoryComboBox->clear();
-
-    // Add a default item
-    subcategoryComboBox->addItem("None", -1);
-
-    // Add the subcategories and their ID's to the combo box
-    for (auto subcategory = subcategories.begin(); subcategory != subcategories.end();
-         ++subcategory) {
-        subcategoryComboBox->addItem(subcategory.value(), subcategory.key());
+        // Show the subcategories of the selected category, loading them on first use
+        CategoryModel *model = CategoryModel::forUser(m_userID);
+        QModelIndex category = model->categoryIndex(categoryID);
+        model->loadSubcategories(category);
+        subcategoryComboBox->setRootModelIndex(category);
+        subcategoryComboBox->setCurrentIndex(-1);
     }
 }
 
@@ -21,7 +21,7 @@ class AddTransactionDialog : public QDialog
     Q_OBJECT
 
 public:
-    AddTransactionDialog(QWidget *parent, int userID);
+    AddTransactionDialog(QWidget *parent);
 
 signals:
     void transactionAdded(); // Signal to indicate that a transaction has been added.
@@ -40,10 +40,6 @@ private:
     QComboBox *subcategoryComboBox = nullptr;
     QPushButton *addButton = nullptr;
 
-private:
-    void loadCategories();                  // Load categories from the database.
-    void loadSubcategories(int categoryID); // Load subcategories from the database.
-
 private:
     int m_userID;
 };
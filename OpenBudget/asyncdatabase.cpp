@@ -0,0 +1,330 @@
+#include "asyncdatabase.h"
+#include <QCoreApplication>
+
+// Singleton instance of AsyncDatabase.
+AsyncDatabase *AsyncDatabase::INSTANCE = nullptr;
+
+/**
+ * @brief AsyncDatabase singleton instance getter.
+ *        The instance belongs to the application and is shut down with it.
+ * @return AsyncDatabase singleton instance.
+ */
+AsyncDatabase *AsyncDatabase::getInstance()
+{
+    if (!INSTANCE) {
+        INSTANCE = new AsyncDatabase(QCoreApplication::instance());
+    }
+
+    return INSTANCE;
+}
+
+/**
+ * @brief Starts the worker thread and opens its database connection.
+ * @param parent Pointer to the parent object.
+ */
+AsyncDatabase::AsyncDatabase(QObject *parent)
+    : QObject{parent}
+{
+    // Create and migrate the schema on this thread before the worker connects.
+    Database::getInstance();
+
+    // Create the worker context and move it to the worker thread.
+    m_worker = new QObject();
+    m_worker->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::finished, m_worker, &QObject::deleteLater);
+    m_thread.setObjectName("DatabaseWorker");
+    m_thread.start();
+
+    // Start at most one reader per pooled connection left after the worker's, so a reader
+    // never waits for a connection. A reader returns its connection when its thread expires.
+    m_readers.setMaxThreadCount(Database::MAX_CONNECTIONS - 2);
+
+    // Lease the worker's connection on the worker thread, ahead of any queued call.
+    QMetaObject::invokeMethod(
+        m_worker,
+        [this]() { m_database = Database::getInstance(); },
+        Qt::QueuedConnection);
+
+    // Checkpoint the WAL periodically, so it does not grow between SQLite's own checkpoints.
+    int checkpointInterval = Database::durabilitySettings().checkpointInterval;
+    if (checkpointInterval > 0) {
+        m_checkpointTimer.setInterval(checkpointInterval);
+        connect(&m_checkpointTimer, &QTimer::timeout, this, &AsyncDatabase::checkpoint);
+        m_checkpointTimer.start();
+    }
+}
+
+/**
+ * @brief Finishes the queued calls, closes the worker's connection and stops the thread.
+ */
+AsyncDatabase::~AsyncDatabase()
+{
+    // Stop checkpointing periodically.
+    m_checkpointTimer.stop();
+
+    // Finish the reads; their threads return their connections as the pool is destroyed.
+    m_readers.waitForDone();
+
+    // Return the connection to the pool from the thread that opened it, after every queued
+    // call. Emptying the WAL first leaves the database in a single file.
+    QMetaObject::invokeMethod(
+        m_worker,
+        [this]() {
+            if (m_database) {
+                m_database->checkpoint(CheckpointMode::Truncate);
+            }
+            Database::releaseInstance();
+            m_database = nullptr;
+        },
+        Qt::BlockingQueuedConnection);
+
+    // Stop the worker thread.
+    m_thread.quit();
+    m_thread.wait();
+
+    // Forget the singleton instance.
+    if (INSTANCE == this) {
+        INSTANCE = nullptr;
+    }
+}
+
+/**
+ * @brief Retrieves a user on the worker thread.
+ * @param userID The ID of the user.
+ * @return Future of the User; std::nullopt if the user does not exist.
+ */
+QFuture<std::optional<User>> AsyncDatabase::getUser(int userID)
+{
+    return run([userID](Database &db) { return db.getUser(userID); });
+}
+
+/**
+ * @brief Retrieves a user login on the worker thread.
+ * @param username The username of the user.
+ * @return Future of the user login; std::nullopt if the user login does not exist.
+ */
+QFuture<std::optional<UserLogin>> AsyncDatabase::getUserLogin(const QString &username)
+{
+    return run([username](Database &db) { return db.getUserLogin(username); });
+}
+
+/**
+ * @brief Retrieves the login and profile of a username on the worker thread.
+ * @param username The username of the user.
+ * @return Future of the account; std::nullopt if the username is not registered.
+ */
+QFuture<std::optional<Account>> AsyncDatabase::authenticate(const QString &username)
+{
+    return run([username](Database &db) { return db.authenticate(username); });
+}
+
+/**
+ * @brief Creates a user and their login on the worker thread.
+ * @param firstName The first name of the user.
+ * @param lastName The last name of the user.
+ * @param position The position of the user.
+ * @param username The username.
+ * @param passwordHash The hash of the password.
+ * @param accessLevel The access level.
+ * @param email The email of the user.
+ * @return Future of the new account, or why it could not be created.
+ */
+QFuture<RegistrationResult> AsyncDatabase::registerAccount(const QString &firstName,
+                                                           const QString &lastName,
+                                                           Position position,
+                                                           const QString &username,
+                                                           const QString &passwordHash,
+                                                           AccessLevel accessLevel,
+                                                           const QString &email)
+{
+    return run([=](Database &db) {
+        return db.registerAccount(firstName,
+                                  lastName,
+                                  position,
+                                  username,
+                                  passwordHash,
+                                  accessLevel,
+                                  email);
+    });
+}
+
+/**
+ * @brief Retrieves one page of a user's ledger on a reader thread.
+ * @param userID The ID of the user.
+ * @param categoryID The ID of the category; -1 pages through every category.
+ * @param cursor The position to page from.
+ * @param limit The maximum number of transactions to return.
+ * @param direction Whether to return the transactions after or before the cursor.
+ * @return Future of the transactions in ledger order.
+ */
+QFuture<QVector<Transaction>> AsyncDatabase::getLedgerPage(int userID,
+                                                           int categoryID,
+                                                           const LedgerCursor &cursor,
+                                                           int limit,
+                                                           PageDirection direction)
+{
+    return read([=](Database &db) {
+        return db.getLedgerPage(userID, categoryID, cursor, limit, direction);
+    });
+}
+
+/**
+ * @brief Searches a user's transaction descriptions on a reader thread.
+ * @param userID The ID of the user.
+ * @param text The search text.
+ * @param limit The maximum number of transactions to return.
+ * @param offset The number of ranked transactions to skip.
+ * @return Future of the matching transactions, most relevant first.
+ */
+QFuture<QVector<Transaction>> AsyncDatabase::searchTransactions(int userID,
+                                                                const QString &text,
+                                                                int limit,
+                                                                int offset)
+{
+    return read([=](Database &db) { return db.searchTransactions(userID, text, limit, offset); });
+}
+
+/**
+ * @brief Retrieves a user's monthly totals from the monthly rollup on the worker thread.
+ * @param userID The ID of the user.
+ * @param from A date in the first month.
+ * @param to A date in the last month.
+ * @param categoryID The ID of the category; -1 returns every category.
+ * @param bySubcategory Whether to split each category's totals by subcategory.
+ * @return Future of the totals ordered by month, category and subcategory.
+ */
+QFuture<QVector<MonthlyTotal>> AsyncDatabase::getMonthlyTotals(int userID,
+                                                               const QDate &from,
+                                                               const QDate &to,
+                                                               int categoryID,
+                                                               bool bySubcategory)
+{
+    return run([=](Database &db) {
+        return db.getMonthlyTotals(userID, from, to, categoryID, bySubcategory);
+    });
+}
+
+/**
+ * @brief Retrieves a user's total per category from the monthly rollup on the worker thread.
+ * @param userID The ID of the user.
+ * @param from A date in the first month.
+ * @param to A date in the last month.
+ * @return Future of the map of category IDs to totals.
+ */
+QFuture<QMap<int, Money>> AsyncDatabase::getCategoryTotals(int userID,
+                                                           const QDate &from,
+                                                           const QDate &to)
+{
+    return run([=](Database &db) { return db.getCategoryTotals(userID, from, to); });
+}
+
+/**
+ * @brief Retrieves a user's categories, from the CategoryCache if the user's tree is cached and
+ *        on the worker thread otherwise.
+ * @param userID The ID of the user.
+ * @return Future of the map of category ID's to names.
+ */
+QFuture<QMap<int, QString>> AsyncDatabase::getCategoryNames(int userID)
+{
+    // Serve the names from memory.
+    if (std::optional<CategoryTree> tree = CategoryCache::instance().tree(userID)) {
+        return readyFuture(tree->categories);
+    }
+
+    return run([userID](Database &db) { return db.getCategoryNames(userID); });
+}
+
+/**
+ * @brief Retrieves a category's subcategories, from the CategoryCache if the user's tree is
+ *        cached and on the worker thread otherwise.
+ * @param userID The ID of the user.
+ * @param categoryID The ID of the parent category.
+ * @return Future of the map of subcategory ID's to names.
+ */
+QFuture<QMap<int, QString>> AsyncDatabase::getSubcategoryNames(int userID, int categoryID)
+{
+    // Serve the names from memory.
+    if (std::optional<CategoryTree> tree = CategoryCache::instance().tree(userID)) {
+        return readyFuture(tree->subcategories.value(categoryID));
+    }
+
+    return run([userID, categoryID](Database &db) {
+        return db.getSubcategoryNames(userID, categoryID);
+    });
+}
+
+/**
+ * @brief Creates a transaction on the worker thread.
+ * @param amount The amount of the transaction.
+ * @param description The description of the transaction.
+ * @param date The date of the transaction.
+ * @param categoryID The ID of the category.
+ * @param subcategoryID The ID of the subcategory.
+ * @param userID The ID of the user.
+ * @param isDeposit Whether the transaction is a deposit.
+ * @return Future of the created transaction; std::nullopt if it could not be created.
+ */
+QFuture<std::optional<Transaction>> AsyncDatabase::createTransaction(Money amount,
+                                                                     const QString &description,
+                                                                     const QDate &date,
+                                                                     int categoryID,
+                                                                     int subcategoryID,
+                                                                     int userID,
+                                                                     bool isDeposit)
+{
+    return run([=](Database &db) {
+        return db.createTransaction(amount,
+                                    description,
+                                    date,
+                                    categoryID,
+                                    subcategoryID,
+                                    userID,
+                                    isDeposit);
+    });
+}
+
+/**
+ * @brief Inserts a batch of transactions on the worker thread.
+ * @param userID The ID of the user.
+ * @param drafts The transactions to insert.
+ * @return Future of the ID or error of each draft.
+ */
+QFuture<TransactionBatchResult> AsyncDatabase::createTransactions(
+    int userID, const QVector<TransactionDraft> &drafts)
+{
+    return run([userID, drafts](Database &db) { return db.createTransactions(userID, drafts); });
+}
+
+/**
+ * @brief Deletes a transaction on the worker thread.
+ * @param transactionID The ID of the transaction.
+ * @return Future of whether the transaction was deleted.
+ */
+QFuture<bool> AsyncDatabase::deleteTransaction(int transactionID)
+{
+    return run([transactionID](Database &db) { return db.deleteTransaction(transactionID); });
+}
+
+/**
+ * @brief Retrieves the settings in effect on the worker's connection.
+ * @return Future of the settings.
+ */
+QFuture<DurabilitySettings> AsyncDatabase::activeSettings()
+{
+    return run([](Database &db) { return db.activeSettings(); });
+}
+
+/**
+ * @brief Checkpoints the WAL on the worker thread without waiting for readers.
+ *        A checkpoint is skipped while the previous one is still queued behind other calls.
+ */
+void AsyncDatabase::checkpoint()
+{
+    if (m_checkpointQueued) {
+        return;
+    }
+    m_checkpointQueued = true;
+
+    run([](Database &db) { return db.checkpoint(CheckpointMode::Passive); })
+        .then(this, [this](bool) { m_checkpointQueued = false; });
+}
@@ -0,0 +1,196 @@
+#ifndef ASYNCDATABASE_H
+#define ASYNCDATABASE_H
+
+#include <QFuture>
+#include <QObject>
+#include <QPromise>
+#include <QThread>
+#include <QThreadPool>
+#include <QTimer>
+#include <memory>
+#include <type_traits>
+#include "database.h"
+
+/**
+ * @brief The AsyncDatabase class runs Database operations on a dedicated worker thread so the
+ *        GUI thread never waits on SQLite. The worker leases its own connection to the database
+ *        file from the Database pool; calls are queued to it in order and their results are
+ *        delivered as QFutures. Read-only calls that do not need ordering with the writes run
+ *        on reader threads instead, each with its own pooled connection, so they do not wait
+ *        behind the writes.
+ */
+class AsyncDatabase : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Singleton instance getter.
+    static AsyncDatabase *getInstance();
+
+    /* Users */
+
+    // Get user by userID; the result is std::nullopt if user not found.
+    QFuture<std::optional<User>> getUser(int userID);
+
+    // Get user login by username; the result is std::nullopt if user login not found.
+    QFuture<std::optional<UserLogin>> getUserLogin(const QString &username);
+
+    // Get the login and profile of a username; see Database::authenticate.
+    QFuture<std::optional<Account>> authenticate(const QString &username);
+
+    // Create a user and their login atomically; see Database::registerAccount.
+    QFuture<RegistrationResult> registerAccount(const QString &firstName,
+                                                const QString &lastName,
+                                                Position position,
+                                                const QString &username,
+                                                const QString &passwordHash,
+                                                AccessLevel accessLevel,
+                                                const QString &email);
+
+    /* Retrieval Methods */
+
+    // Get a page of the user's ledger on a reader thread; see Database::getLedgerPage.
+    QFuture<QVector<Transaction>> getLedgerPage(int userID,
+                                                int categoryID,
+                                                const LedgerCursor &cursor,
+                                                int limit,
+                                                PageDirection direction = PageDirection::Forward);
+
+    // Search the user's transaction descriptions on a reader thread; see
+    // Database::searchTransactions.
+    QFuture<QVector<Transaction>> searchTransactions(int userID,
+                                                     const QString &text,
+                                                     int limit,
+                                                     int offset = 0);
+
+    // Get the user's monthly totals; see Database::getMonthlyTotals.
+    QFuture<QVector<MonthlyTotal>> getMonthlyTotals(int userID,
+                                                    const QDate &from,
+                                                    const QDate &to,
+                                                    int categoryID = -1,
+                                                    bool bySubcategory = false);
+
+    // Get the user's total per category; see Database::getCategoryTotals.
+    QFuture<QMap<int, Money>> getCategoryTotals(int userID, const QDate &from, const QDate &to);
+
+    // Get all category names by userID; cached names are returned without the worker.
+    QFuture<QMap<int, QString>> getCategoryNames(int userID);
+
+    // Get all subcategory names by categoryID; cached names are returned without the worker.
+    QFuture<QMap<int, QString>> getSubcategoryNames(int userID, int categoryID);
+
+    /* Insertion Methods */
+
+    // Insert transaction; the result is std::nullopt if it failed to be created.
+    QFuture<std::optional<Transaction>> createTransaction(Money amount,
+                                                          const QString &description,
+                                                          const QDate &date,
+                                                          int categoryID,
+                                                          int subcategoryID,
+                                                          int userID,
+                                                          bool isDeposit = false);
+
+    // Insert a batch of the user's transactions; see Database::createTransactions.
+    QFuture<TransactionBatchResult> createTransactions(int userID,
+                                                       const QVector<TransactionDraft> &drafts);
+
+    /* Deletion Methods */
+
+    // Delete transaction; the result is true if it was deleted.
+    QFuture<bool> deleteTransaction(int transactionID);
+
+    /* Durability */
+
+    // Get the settings in effect on the worker's connection.
+    QFuture<DurabilitySettings> activeSettings();
+
+    // Run a function with the worker's Database on the worker thread.
+    // Functions that are still queued when their future is canceled are skipped.
+    template<typename Function>
+    QFuture<std::invoke_result_t<Function, Database &>> run(Function function);
+
+    // Run a read-only function with a reader thread's pooled Database. Reads run alongside the
+    // worker's writes and see what was committed when they start, so they are not ordered
+    // with calls queued to the worker. Canceled functions that have not started are skipped.
+    template<typename Function>
+    QFuture<std::invoke_result_t<Function, Database &>> read(Function function);
+
+private:
+    explicit AsyncDatabase(QObject *parent);
+
+    // Get a future that already holds a result.
+    template<typename T>
+    static QFuture<T> readyFuture(T value);
+    ~AsyncDatabase();
+
+    // Singleton instance of AsyncDatabase.
+    static AsyncDatabase *INSTANCE;
+
+    // Checkpoint the WAL on the worker thread.
+    void checkpoint();
+
+    QThread m_thread;                // The worker thread.
+    QThreadPool m_readers;           // Reader threads; each leases a pooled connection.
+    QObject *m_worker = nullptr;     // Lives on the worker thread; calls are queued to it.
+    Database *m_database = nullptr;  // The worker's pooled connection; used on the worker only.
+    QTimer m_checkpointTimer;        // Checkpoints the WAL periodically.
+    bool m_checkpointQueued = false; // Whether a periodic checkpoint is waiting to run.
+};
+
+template<typename Function>
+QFuture<std::invoke_result_t<Function, Database &>> AsyncDatabase::run(Function function)
+{
+    using Result = std::invoke_result_t<Function, Database &>;
+
+    // The promise is shared with the queued call, which fulfils it on the worker thread.
+    auto promise = std::make_shared<QPromise<Result>>();
+    QFuture<Result> future = promise->future();
+    promise->start();
+
+    QMetaObject::invokeMethod(
+        m_worker,
+        [this, promise, function = std::move(function)]() mutable {
+            // Skip work nobody is waiting for.
+            if (!promise->isCanceled()) {
+                promise->addResult(function(*m_database));
+            }
+            promise->finish();
+        },
+        Qt::QueuedConnection);
+
+    return future;
+}
+
+template<typename Function>
+QFuture<std::invoke_result_t<Function, Database &>> AsyncDatabase::read(Function function)
+{
+    using Result = std::invoke_result_t<Function, Database &>;
+
+    // The promise is shared with the pooled task, which fulfils it on a reader thread.
+    auto promise = std::make_shared<QPromise<Result>>();
+    QFuture<Result> future = promise->future();
+    promise->start();
+
+    m_readers.start([promise, function = std::move(function)]() mutable {
+        // Skip work nobody is waiting for.
+        if (!promise->isCanceled()) {
+            promise->addResult(function(*Database::getInstance()));
+        }
+        promise->finish();
+    });
+
+    return future;
+}
+
+template<typename T>
+QFuture<T> AsyncDatabase::readyFuture(T value)
+{
+    QPromise<T> promise;
+    QFuture<T> future = promise.future();
+    promise.start();
+    promise.addResult(std::move(value));
+    promise.finish();
+    return future;
+}
+
+#endif // ASYNCDATABASE_H
@@ -0,0 +1,128 @@
+#include "balancepyramid.h"
+
+/**
+ * @brief Finds the first day of the bucket a date falls in.
+ * @param date The date.
+ * @param level The level of the bucket.
+ * @return The first day of the bucket.
+ */
+QDate BalancePyramid::bucketStart(const QDate &date, PyramidLevel level)
+{
+    switch (level) {
+    case PyramidLevel::Day:
+        return date;
+    case PyramidLevel::Week:
+        return date.addDays(1 - date.dayOfWeek());
+    case PyramidLevel::Month:
+        return QDate(date.year(), date.month(), 1);
+    case PyramidLevel::Year:
+        return QDate(date.year(), 1, 1);
+    }
+
+    return date;
+}
+
+/**
+ * @brief Finds the first day of the bucket after the one a date falls in.
+ * @param date The date.
+ * @param level The level of the bucket.
+ * @return The first day of the next bucket.
+ */
+QDate BalancePyramid::nextBucketStart(const QDate &date, PyramidLevel level)
+{
+    QDate start = bucketStart(date, level);
+
+    switch (level) {
+    case PyramidLevel::Day:
+        return start.addDays(1);
+    case PyramidLevel::Week:
+        return start.addDays(7);
+    case PyramidLevel::Month:
+        return start.addMonths(1);
+    case PyramidLevel::Year:
+        return start.addYears(1);
+    }
+
+    return start.addDays(1);
+}
+
+/**
+ * @brief Picks the level to chart a range of dates at.
+ *        Months and years are counted at their shortest, so the count is never exceeded.
+ * @param from The first date of the range.
+ * @param to The last date of the range.
+ * @param maxBuckets The most buckets the range may span, usually one per pixel.
+ * @return The finest level that fits; years if none does.
+ */
+PyramidLevel BalancePyramid::levelFor(const QDate &from, const QDate &to, int maxBuckets)
+{
+    qint64 days = from.daysTo(to) + 1;
+
+    // Each bucket a range touches at either end may be partly outside it.
+    if (days <= maxBuckets) {
+        return PyramidLevel::Day;
+    }
+    if (days / 7 + 2 <= maxBuckets) {
+        return PyramidLevel::Week;
+    }
+    if (days / 28 + 2 <= maxBuckets) {
+        return PyramidLevel::Month;
+    }
+
+    return PyramidLevel::Year;
+}
+
+/**
+ * @brief Builds the SQL expression that maps a day to the first day of its bucket.
+ *        Days are stored as days since 1970-01-01, which was a Thursday.
+ * @param level The level of the bucket.
+ * @param day SQL expression for the epoch day.
+ * @return SQL expression for the epoch day of the bucket.
+ */
+QString BalancePyramid::bucketSql(PyramidLevel level, const QString &day)
+{
+    switch (level) {
+    case PyramidLevel::Day:
+        return day;
+    case PyramidLevel::Week:
+        // Go back to Monday; the remainder is made positive for days before 1970.
+        return QString("(%1 - ((%1 + 3) % 7 + 7) % 7)").arg(day);
+    case PyramidLevel::Month:
+        return QString("(CAST(strftime('%s', %1 * 86400, 'unixepoch', 'start of month') "
+                       "AS INTEGER) / 86400)")
+            .arg(day);
+    case PyramidLevel::Year:
+        return QString("(CAST(strftime('%s', %1 * 86400, 'unixepoch', 'start of year') "
+                       "AS INTEGER) / 86400)")
+            .arg(day);
+    }
+
+    return day;
+}
+
+/**
+ * @brief Builds the statement that aggregates transactions into a level of the pyramid.
+ *        Each transaction's bucket is computed once, and a window over the bucket's rows in
+ *        ledger order gives its first and last balances along with the extremes.
+ * @param level The level to fill.
+ * @param condition SQL condition on Transactions selecting the rows to aggregate; every
+ *        bucket it touches must be selected whole.
+ * @return The INSERT statement.
+ */
+QString BalancePyramid::fillSql(PyramidLevel level, const QString &condition)
+{
+    return QString("INSERT INTO BalancePyramid "
+                   "(userID, level, bucket, open, close, low, high, count) "
+                   "SELECT DISTINCT userID, %1, bucket, "
+                   "FIRST_VALUE(balance) OVER bucketRows, LAST_VALUE(balance) OVER bucketRows, "
+                   "MIN(balance) OVER bucketRows, MAX(balance) OVER bucketRows, "
+                   "COUNT(*) OVER bucketRows "
+                   "FROM (SELECT userID, transactionDate, transactionID, balance, "
+                   "%2 AS bucket FROM Transactions %3) "
+                   "WINDOW bucketRows AS (PARTITION BY userID, bucket "
+                   "ORDER BY transactionDate, transactionID "
+                   "ROWS BETWEEN UNBOUNDED PRECEDING AND UNBOUNDED FOLLOWING)")
+        .arg(QString::number(int(level)),
+             bucketSql(level, "transactionDate"),
+             condition.isEmpty() ? QString() : "WHERE " + condition);
+}
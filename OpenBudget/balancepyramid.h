@@ -0,0 +1,56 @@
+#ifndef BALANCEPYRAMID_H
+#define BALANCEPYRAMID_H
+
+#include <QDate>
+#include <QString>
+#include "money.h"
+
+// Size of the buckets a level of the balance pyramid aggregates; weeks start on Monday.
+enum class PyramidLevel : int { Day, Week, Month, Year };
+
+// The balances after a user's transactions in one bucket of the balance pyramid.
+struct BalanceBucket
+{
+    QDate start;   // The first day of the bucket.
+    Money open;    // The balance after the bucket's first transaction.
+    Money close;   // The balance after its last transaction.
+    Money low;     // The lowest balance after one of its transactions.
+    Money high;    // The highest balance after one of its transactions.
+    int count = 0; // Number of transactions.
+};
+
+/**
+ * @brief The BalancePyramid class describes the buckets of the balance pyramid, the table that
+ *        holds the open, close, low and high balance of every user's transactions per day,
+ *        week, month and year. Charts read the level whose buckets match their resolution, so
+ *        the rows read depend on the width of the chart rather than on the size of the ledger.
+ *        Database keeps the table current as transactions are written, and SchemaMigrator
+ *        fills it, both with the SQL built here.
+ */
+class BalancePyramid
+{
+public:
+    // Every level, finest first.
+    static constexpr PyramidLevel LEVELS[] = {PyramidLevel::Day,
+                                              PyramidLevel::Week,
+                                              PyramidLevel::Month,
+                                              PyramidLevel::Year};
+
+    // Get the first day of the bucket a date falls in.
+    static QDate bucketStart(const QDate &date, PyramidLevel level);
+
+    // Get the first day of the bucket after the one a date falls in.
+    static QDate nextBucketStart(const QDate &date, PyramidLevel level);
+
+    // Get the finest level with at most maxBuckets buckets from one date through another.
+    static PyramidLevel levelFor(const QDate &from, const QDate &to, int maxBuckets);
+
+    // SQL expression for the epoch day of the bucket of an epoch day expression.
+    static QString bucketSql(PyramidLevel level, const QString &day);
+
+    // SQL statement inserting a level's buckets of the transactions matching a condition.
+    // An empty condition inserts the buckets of every transaction.
+    static QString fillSql(PyramidLevel level, const QString &condition);
+};
+
+#endif // BALANCEPYRAMID_H
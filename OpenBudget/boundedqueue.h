@@ -0,0 +1,75 @@
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <deque>
+#include <optional>
+
+/**
+ * @brief The BoundedQueue class passes items between threads with a fixed capacity.
+ *        Producers wait while the queue is full, so a fast stage cannot run ahead of a slow
+ *        one and memory stays bounded. Closing the queue lets consumers drain what is left
+ *        and makes any further push fail.
+ */
+template<typename T>
+class BoundedQueue
+{
+public:
+    explicit BoundedQueue(qsizetype capacity)
+        : m_capacity{capacity}
+    {}
+
+    // Add an item, waiting while the queue is full.
+    // Returns false if the queue was closed.
+    bool push(T item)
+    {
+        QMutexLocker locker(&m_mutex);
+        while (qsizetype(m_items.size()) >= m_capacity && !m_closed) {
+            m_notFull.wait(&m_mutex);
+        }
+        if (m_closed) {
+            return false;
+        }
+        m_items.push_back(std::move(item));
+        m_notEmpty.wakeOne();
+        return true;
+    }
+
+    // Take the next item, waiting while the queue is empty.
+    // Returns std::nullopt once the queue is closed and empty.
+    std::optional<T> pop()
+    {
+        QMutexLocker locker(&m_mutex);
+        while (m_items.empty() && !m_closed) {
+            m_notEmpty.wait(&m_mutex);
+        }
+        if (m_items.empty()) {
+            return std::nullopt;
+        }
+        std::optional<T> item{std::move(m_items.front())};
+        m_items.pop_front();
+        m_notFull.wakeOne();
+        return item;
+    }
+
+    // Stop accepting items and wake every waiting producer and consumer.
+    void close()
+    {
+        QMutexLocker locker(&m_mutex);
+        m_closed = true;
+        m_notEmpty.wakeAll();
+        m_notFull.wakeAll();
+    }
+
+private:
+    const qsizetype m_capacity; // Maximum number of queued items.
+    bool m_closed = false;      // Whether the queue stopped accepting items.
+    std::deque<T> m_items;      // Queued items, oldest first.
+    QMutex m_mutex;
+    QWaitCondition m_notEmpty;
+    QWaitCondition m_notFull;
+};
+
+#endif // BOUNDEDQUEUE_H
@@ -6,28 +6,58 @@
  * @return Budget object.
  */
 Budget::Budget()
-    : m_categoryID{0}
+    : m_budgetID{0}
+    , m_categoryID{0}
     , m_subcategoryID{0}
-    , m_amount{0.0}
+    , m_amount{}
     , m_userID{0}
 {}
 
+/**
+ * @brief Stores budget information for existing budgets.
+ *
+ * @param budgetID The budget's ID.
+ * @param categoryID The budget's category ID.
+ * @param subcategoryID The budget's subcategory ID; 0 budgets the whole category.
+ * @param amount The budget's monthly amount.
+ * @param userID The budget's userID.
+ * @return Budget object.
+ */
+Budget::Budget(int budgetID, int categoryID, int subcategoryID, Money amount, int userID)
+    : m_budgetID{budgetID}
+    , m_categoryID{categoryID}
+    , m_subcategoryID{subcategoryID}
+    , m_amount{amount}
+    , m_userID{userID}
+{}
+
 /**
  * @brief Budget constructor for category and subcategory.
  *
  * @param categoryID The budget's category ID.
- * @param subcategoryID The budget's subcategory ID.
- * @param amount The budget's amount.
+ * @param subcategoryID The budget's subcategory ID; 0 budgets the whole category.
+ * @param amount The budget's monthly amount.
  * @param userID The budget's userID.
  * @return Budget object.
  */
-Budget::Budget(int categoryID, int subcategoryID, double amount, int userID)
-    : m_categoryID{categoryID}
+Budget::Budget(int categoryID, int subcategoryID, Money amount, int userID)
+    : m_budgetID{0}
+    , m_categoryID{categoryID}
     , m_subcategoryID{subcategoryID}
     , m_amount{amount}
     , m_userID{userID}
 {}
 
+/**
+ * @brief Getter for budgetID.
+ *
+ * @return The budget's ID; 0 if it is not stored yet.
+ */
+int Budget::budgetID() const
+{
+    return m_budgetID;
+}
+
 /**
  * @brief Getter for categoryID.
  *
@@ -53,7 +83,7 @@ int Budget::subcategoryID() const
  *
  * @return The budget's amount.
  */
-double Budget::amount() const
+Money Budget::amount() const
 {
     return m_amount;
 }
@@ -68,6 +98,16 @@ int Budget::userID() const
     return m_userID;
 }
 
+/**
+ * @brief Setter for budgetID.
+ *
+ * @param budgetID The budget's ID.
+ */
+void Budget::setBudgetID(const int &budgetID)
+{
+    m_budgetID = budgetID;
+}
+
 /**
  * @brief Setter for categoryID.
  *
@@ -93,7 +133,7 @@ void Budget::setSubcategoryID(const int &subcategoryID)
  *
  * @param amount The budget's amount.
  */
-void Budget::setAmount(const double &amount)
+void Budget::setAmount(const Money &amount)
 {
     m_amount = amount;
 }
@@ -116,9 +156,10 @@ void Budget::setUserID(const int &userID)
 QString Budget::toString() const
 {
     QString budgetString;
+    budgetString += "Budget ID: " + QString::number(m_budgetID) + "\n";
     budgetString += "Category ID: " + QString::number(m_categoryID) + "\n";
     budgetString += "Subcategory ID: " + QString::number(m_subcategoryID) + "\n";
-    budgetString += "Amount: " + QString::number(m_amount) + "\n";
+    budgetString += "Amount: " + m_amount.toString() + "\n";
     budgetString += "User ID: " + QString::number(m_userID) + "\n";
     return budgetString;
 }
@@ -2,32 +2,43 @@
 #define BUDGET_H
 
 #include <QString>
+#include "money.h"
 
+/**
+ * @brief The Budget class is the amount a user plans to spend on a category, or on one of its
+ *        subcategories, each month.
+ */
 class Budget
 {
 public:
     Budget();
-    Budget(int categoryID, int subcategoryID, double amount, int userID);
+    // Constructor for budgets retrieved from database.
+    Budget(int budgetID, int categoryID, int subcategoryID, Money amount, int userID);
+    // Constructor for budgets created by the user.
+    Budget(int categoryID, int subcategoryID, Money amount, int userID);
 
     // Retrieve budget details.
+    int budgetID() const;
     int categoryID() const;
     int subcategoryID() const;
-    double amount() const;
+    Money amount() const;
     int userID() const;
 
     // Set budget details.
+    void setBudgetID(const int &budgetID);
     void setCategoryID(const int &categoryID);
     void setSubcategoryID(const int &subcategoryID);
-    void setAmount(const double &amount);
+    void setAmount(const Money &amount);
     void setUserID(const int &userID);
 
     // To string.
     QString toString() const;
 
 private:
+    int m_budgetID;
     int m_categoryID;
     int m_subcategoryID;
-    double m_amount;
+    Money m_amount;
     int m_userID;
 };
 
@@ -0,0 +1,345 @@
+#include "budgetdialog.h"
+#include <QHeaderView>
+#include <QMessageBox>
+#include "asyncdatabase.h"
+#include "categorymodel.h"
+#include "session.h"
+
+/**
+ * @brief Shows the logged in user's budgets and this month's spending against them, and lets
+ *        the user set or delete the budget of a category or subcategory.
+ *
+ * @param parent Pointer to the parent widget.
+ */
+BudgetDialog::BudgetDialog(QWidget *parent)
+    : QDialog{parent}
+    , m_userID{Session::getInstance()->userID()}
+    , m_engine{BudgetEngine::forUser(m_userID)}
+{
+    setWindowTitle("Budgets");
+    resize(640, 480);
+
+    // Create main layout
+    QVBoxLayout *mainLayout = new QVBoxLayout();
+
+    // Budgets Group Box
+    QGroupBox *tableGroupBox = new QGroupBox(m_engine->month().toString("MMMM yyyy"));
+    QVBoxLayout *tableLayout = new QVBoxLayout();
+
+    // Table of budgets; rows are selected whole
+    budgetTable = new QTableWidget(0, 5);
+    budgetTable->setHorizontalHeaderLabels(
+        {"Category", "Subcategory", "Budget", "Spent", "Remaining"});
+    budgetTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    budgetTable->verticalHeader()->setVisible(false);
+    budgetTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    budgetTable->setSelectionMode(QAbstractItemView::SingleSelection);
+    budgetTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    tableLayout->addWidget(budgetTable);
+    tableGroupBox->setLayout(tableLayout);
+
+    // Budget Details Group Box
+    QGroupBox *formGroupBox = new QGroupBox("Budget Details");
+    QFormLayout *formLayout = new QFormLayout();
+
+    // Widgets for the form
+    categoryCombo = new QComboBox();
+    subcategoryComboBox = new QComboBox();
+    amountLineEdit = new QLineEdit();
+
+    // Set input constraints for amountLineEdit
+    QValidator *validator = new QDoubleValidator(0.0, 1000000.0, 2, amountLineEdit);
+    amountLineEdit->setValidator(validator);
+
+    // Show the shared categories after the default item
+    categoryCombo->setModel(
+        CategoryModel::withPlaceholders(m_userID, {{"Select a category", -1}}, this));
+    // Show the selected category's subcategories; no selection budgets the whole category
+    subcategoryComboBox->setModel(CategoryModel::forUser(m_userID));
+    subcategoryComboBox->setPlaceholderText("Whole category");
+    subcategoryComboBox->setCurrentIndex(-1);
+    subcategoryComboBox->setEnabled(false);
+
+    // Add widgets to the form layout
+    formLayout->addRow("Category:", categoryCombo);
+    formLayout->addRow("Subcategory:", subcategoryComboBox);
+    formLayout->addRow("Monthly Budget:", amountLineEdit);
+    formGroupBox->setLayout(formLayout);
+
+    // Button Box
+    QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Close);
+    saveButton = buttonBox->addButton("Save", QDialogButtonBox::ActionRole);
+    deleteButton = buttonBox->addButton("Delete", QDialogButtonBox::ActionRole);
+    saveButton->setEnabled(false);
+    deleteButton->setEnabled(false);
+
+    // Save or delete the budget when the buttons are clicked
+    connect(saveButton, &QPushButton::clicked, this, &BudgetDialog::saveBudget);
+    connect(deleteButton, &QPushButton::clicked, this, &BudgetDialog::deleteBudget);
+    // Close the dialog when the close button is clicked
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    // Show the subcategories of the selected category
+    connect(categoryCombo,
+            QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this,
+            &BudgetDialog::categoryChanged);
+    // Enable the save button once an amount is entered
+    connect(amountLineEdit, &QLineEdit::textChanged, this, &BudgetDialog::enableButtons);
+    // Fill the form from the selected budget
+    connect(budgetTable,
+            &QTableWidget::itemSelectionChanged,
+            this,
+            &BudgetDialog::budgetSelected);
+    // Show the statuses whenever spending or budgets change
+    connect(m_engine, &BudgetEngine::changed, this, &BudgetDialog::refreshTable);
+    // Names of categories read after the table was filled are shown once they arrive
+    connect(CategoryModel::forUser(m_userID),
+            &QAbstractItemModel::rowsInserted,
+            this,
+            &BudgetDialog::refreshTable);
+
+    // Add the group boxes and button box to the main layout
+    mainLayout->addWidget(tableGroupBox);
+    mainLayout->addWidget(formGroupBox);
+    mainLayout->addWidget(buttonBox);
+
+    // Set the main layout for the dialog
+    setLayout(mainLayout);
+
+    // Show the statuses the engine already has
+    refreshTable();
+}
+
+/**
+ * @brief Creates the budget of the selected category or subcategory, or changes its amount
+ *        if it already has one. The table is updated when the engine reports the change.
+ */
+void BudgetDialog::saveBudget()
+{
+    // Get the budget values from the widgets
+    std::optional<Money> amount = Money::fromString(amountLineEdit->text());
+    int categoryID = categoryCombo->currentData().toInt();
+    // No subcategory is selected when the combo box shows its placeholder
+    int subcategoryID = subcategoryComboBox->currentIndex() == -1
+                            ? 0
+                            : subcategoryComboBox->currentData().toInt();
+
+    // If the amount could not be read, there is nothing to save
+    if (!amount || categoryID <= 0) {
+        QMessageBox::critical(this, "Error", "The budget is not valid. Please try again.");
+        return;
+    }
+
+    // Change the existing budget, or create one
+    std::optional<Budget> existing = m_engine->findBudget(categoryID, subcategoryID);
+    int userID = m_userID;
+    Money value = *amount;
+
+    // Disable the save button until the budget has been saved
+    saveButton->setEnabled(false);
+
+    AsyncDatabase *db = AsyncDatabase::getInstance();
+    db->run([existing, categoryID, subcategoryID, value, userID](Database &db) {
+          if (existing) {
+              Budget budget = *existing;
+              budget.setAmount(value);
+              return db.updateBudget(budget);
+          }
+          return db.createBudget(categoryID, subcategoryID, value, userID).has_value();
+      })
+        .then(this, [this](bool saved) {
+            // If the budget was not saved, display an error message
+            if (!saved) {
+                QMessageBox::critical(this,
+                                      "Error",
+                                      "The budget could not be saved. Please try again.");
+            }
+            // Allow another budget to be saved
+            enableButtons();
+        });
+}
+
+/**
+ * @brief Deletes the budget of the selected row.
+ *        The row is removed when the engine reports the change.
+ */
+void BudgetDialog::deleteBudget()
+{
+    // Get the selected budget
+    QList<QTableWidgetItem *> selected = budgetTable->selectedItems();
+    if (selected.isEmpty()) {
+        return;
+    }
+    int budgetID = budgetTable->item(selected.first()->row(), 0)->data(Qt::UserRole).toInt();
+
+    // Disable the delete button until the budget has been deleted
+    deleteButton->setEnabled(false);
+
+    AsyncDatabase *db = AsyncDatabase::getInstance();
+    db->run([budgetID](Database &db) { return db.deleteBudget(budgetID); })
+        .then(this, [this](bool deleted) {
+            // If the budget was not deleted, display an error message
+            if (!deleted) {
+                QMessageBox::critical(this,
+                                      "Error",
+                                      "The budget could not be deleted. Please try again.");
+            }
+            // Allow another attempt
+            enableButtons();
+        });
+}
+
+/**
+ * @brief When the user selects a category, show its subcategories.
+ */
+void BudgetDialog::categoryChanged()
+{
+    // Get the category ID from the combo box
+    int categoryID = categoryCombo->currentData().toInt();
+
+    // If the ID is 0 or less, then the user selected the default item
+    if (categoryID <= 0) {
+        subcategoryComboBox->setEnabled(false);
+        subcategoryComboBox->setCurrentIndex(-1);
+    } else {
+        subcategoryComboBox->setEnabled(true);
+
+        // Show the subcategories of the selected category, loading them on first use
+        CategoryModel *model = CategoryModel::forUser(m_userID);
+        QModelIndex category = model->categoryIndex(categoryID);
+        model->loadSubcategories(category);
+        subcategoryComboBox->setRootModelIndex(category);
+        subcategoryComboBox->setCurrentIndex(-1);
+    }
+
+    enableButtons();
+}
+
+/**
+ * @brief Fills the form with the selected budget, so its amount can be changed.
+ */
+void BudgetDialog::budgetSelected()
+{
+    enableButtons();
+
+    // Get the selected budget
+    QList<QTableWidgetItem *> selected = budgetTable->selectedItems();
+    if (selected.isEmpty()) {
+        return;
+    }
+    int budgetID = budgetTable->item(selected.first()->row(), 0)->data(Qt::UserRole).toInt();
+    std::optional<BudgetStatus> status = m_engine->status(budgetID);
+    if (!status) {
+        return;
+    }
+    const Budget &budget = status->budget;
+
+    // Select the budget's category, then its subcategory
+    categoryCombo->setCurrentIndex(categoryCombo->findData(budget.categoryID()));
+    int subcategoryRow = subcategoryComboBox->findData(budget.subcategoryID());
+    subcategoryComboBox->setCurrentIndex(budget.subcategoryID() == 0 ? -1 : subcategoryRow);
+    amountLineEdit->setText(budget.amount().toString());
+}
+
+/**
+ * @brief Enables the save button when a category and amount are given, and the delete button
+ *        when a budget is selected.
+ */
+void BudgetDialog::enableButtons()
+{
+    int categoryID = categoryCombo->currentData().toInt();
+    saveButton->setEnabled(categoryID > 0 && amountLineEdit->hasAcceptableInput());
+    deleteButton->setEnabled(!budgetTable->selectedItems().isEmpty());
+}
+
+/**
+ * @brief Fills the table with the engine's statuses. Budgets that are over are shown in red.
+ */
+void BudgetDialog::refreshTable()
+{
+    // Keep the selected budget selected
+    int selectedID = -1;
+    QList<QTableWidgetItem *> selected = budgetTable->selectedItems();
+    if (!selected.isEmpty()) {
+        selectedID = budgetTable->item(selected.first()->row(), 0)->data(Qt::UserRole).toInt();
+    }
+
+    QVector<BudgetStatus> statuses = m_engine->statuses();
+    QSignalBlocker blocker(budgetTable);
+    budgetTable->setRowCount(statuses.size());
+
+    for (int row = 0; row < statuses.size(); ++row) {
+        const BudgetStatus &status = statuses.at(row);
+        const Budget &budget = status.budget;
+
+        // One item per column; the category item holds the budget's ID
+        QTableWidgetItem *items[] = {
+            new QTableWidgetItem(categoryName(budget.categoryID())),
+            new QTableWidgetItem(subcategoryName(budget.categoryID(), budget.subcategoryID())),
+            new QTableWidgetItem(budget.amount().toString()),
+            new QTableWidgetItem(status.spent.toString()),
+            new QTableWidgetItem(status.remaining().toString()),
+        };
+        items[0]->setData(Qt::UserRole, budget.budgetID());
+
+        for (int column = 0; column < 5; ++column) {
+            // Amounts are right-aligned
+            if (column >= 2) {
+                items[column]->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            }
+            if (status.isOverBudget()) {
+                items[column]->setForeground(Qt::red);
+            }
+            budgetTable->setItem(row, column, items[column]);
+        }
+
+        if (budget.budgetID() == selectedID) {
+            budgetTable->selectRow(row);
+        }
+    }
+
+    enableButtons();
+}
+
+/**
+ * @brief Gets the name of a category from the shared category model.
+ * @param categoryID The ID of the category.
+ * @return The name; empty until the categories are read.
+ */
+QString BudgetDialog::categoryName(int categoryID) const
+{
+    CategoryModel *model = CategoryModel::forUser(m_userID);
+    return model->categoryIndex(categoryID).data().toString();
+}
+
+/**
+ * @brief Gets the name of a subcategory from the shared category model, loading the
+ *        category's subcategories on first use.
+ * @param categoryID The ID of the parent category.
+ * @param subcategoryID The ID of the subcategory; 0 for the whole category.
+ * @return The name; empty until the subcategories are read.
+ */
+QString BudgetDialog::subcategoryName(int categoryID, int subcategoryID) const
+{
+    // A budget without a subcategory covers the whole category
+    if (subcategoryID == 0) {
+        return "All";
+    }
+
+    CategoryModel *model = CategoryModel::forUser(m_userID);
+    QModelIndex category = model->categoryIndex(categoryID);
+    if (!category.isValid()) {
+        return QString();
+    }
+    model->loadSubcategories(category);
+
+    // Find the subcategory among the category's children
+    for (int row = 0; row < model->rowCount(category); ++row) {
+        QModelIndex subcategory = model->index(row, 0, category);
+        if (subcategory.data(CategoryModel::IDRole).toInt() == subcategoryID) {
+            return subcategory.data().toString();
+        }
+    }
+
+    return QString();
+}
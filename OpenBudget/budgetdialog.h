@@ -0,0 +1,47 @@
+#ifndef BUDGETDIALOG_H
+#define BUDGETDIALOG_H
+
+#include <QComboBox>
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QGroupBox>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QVBoxLayout>
+#include "budgetengine.h"
+
+class BudgetDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    BudgetDialog(QWidget *parent);
+
+private slots:
+    void saveBudget();        // Create or change the budget of the selected category.
+    void deleteBudget();      // Delete the budget of the selected row.
+    void categoryChanged();   // Show the selected category's subcategories.
+    void budgetSelected();    // Fill the form from the selected row.
+    void enableButtons();     // Enable the buttons when their input is valid.
+    void refreshTable();      // Show the engine's statuses.
+
+private:
+    // Get the name shown for a budget's category and subcategory.
+    QString categoryName(int categoryID) const;
+    QString subcategoryName(int categoryID, int subcategoryID) const;
+
+    QTableWidget *budgetTable = nullptr;
+    QComboBox *categoryCombo = nullptr;
+    QComboBox *subcategoryComboBox = nullptr;
+    QLineEdit *amountLineEdit = nullptr;
+    QPushButton *saveButton = nullptr;
+    QPushButton *deleteButton = nullptr;
+
+private:
+    int m_userID;
+    BudgetEngine *m_engine = nullptr;
+};
+
+#endif // BUDGETDIALOG_H
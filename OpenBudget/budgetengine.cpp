@@ -0,0 +1,247 @@
+#include "budgetengine.h"
+#include <QCoreApplication>
+#include <QDebug>
+#include <QPair>
+#include "asyncdatabase.h"
+
+/**
+ * @brief Gets the shared engine of a user's budgets, creating it on first use.
+ *        The engines belong to the application.
+ * @param userID The ID of the user.
+ * @return The user's engine.
+ */
+BudgetEngine *BudgetEngine::forUser(int userID)
+{
+    static QHash<int, BudgetEngine *> engines;
+
+    BudgetEngine *&engine = engines[userID];
+    if (!engine) {
+        engine = new BudgetEngine(userID, QCoreApplication::instance());
+    }
+
+    return engine;
+}
+
+/**
+ * @brief Creates the engine and starts reading the user's budgets for the current month.
+ * @param userID The ID of the user.
+ * @param parent Pointer to the parent object.
+ */
+BudgetEngine::BudgetEngine(int userID, QObject *parent)
+    : QObject{parent}
+    , m_userID{userID}
+{
+    // Follow the transactions and budgets as they change.
+    ChangeNotifier *notifier = ChangeNotifier::getInstance();
+    connect(notifier, &ChangeNotifier::ledgerChanged, this, &BudgetEngine::applyChange);
+    connect(notifier, &ChangeNotifier::budgetsChanged, this, [this](int userID) {
+        if (userID == m_userID) {
+            reload();
+        }
+    });
+
+    // Track the current month.
+    setMonth(QDate::currentDate());
+}
+
+/**
+ * @brief Getter for month.
+ * @return The first day of the tracked month.
+ */
+QDate BudgetEngine::month() const
+{
+    return m_month;
+}
+
+/**
+ * @brief Tracks the spending of another month.
+ * @param month A date in the month.
+ */
+void BudgetEngine::setMonth(const QDate &month)
+{
+    QDate first(month.year(), month.month(), 1);
+    if (first == m_month) {
+        return;
+    }
+
+    m_month = first;
+    reload();
+}
+
+/**
+ * @brief Checks whether the budgets and spending have been read.
+ * @return Returns true once the first read has completed.
+ */
+bool BudgetEngine::isLoaded() const
+{
+    return m_loaded;
+}
+
+/**
+ * @brief Gets the status of every budget.
+ * @return The statuses, ordered by category and subcategory.
+ */
+QVector<BudgetStatus> BudgetEngine::statuses() const
+{
+    QVector<BudgetStatus> statuses;
+    statuses.reserve(m_budgets.size());
+    for (const Budget &budget : m_budgets) {
+        statuses.append(statusOf(budget));
+    }
+
+    return statuses;
+}
+
+/**
+ * @brief Gets the status of a budget.
+ * @param budgetID The ID of the budget.
+ * @return The status; std::nullopt if there is no such budget.
+ */
+std::optional<BudgetStatus> BudgetEngine::status(int budgetID) const
+{
+    for (const Budget &budget : m_budgets) {
+        if (budget.budgetID() == budgetID) {
+            return statusOf(budget);
+        }
+    }
+
+    return std::nullopt;
+}
+
+/**
+ * @brief Finds the budget of a category or subcategory.
+ * @param categoryID The ID of the category.
+ * @param subcategoryID The ID of the subcategory; 0 for the whole category.
+ * @return The budget; std::nullopt if there is none.
+ */
+std::optional<Budget> BudgetEngine::findBudget(int categoryID, int subcategoryID) const
+{
+    for (const Budget &budget : m_budgets) {
+        if (budget.categoryID() == categoryID && budget.subcategoryID() == subcategoryID) {
+            return budget;
+        }
+    }
+
+    return std::nullopt;
+}
+
+/**
+ * @brief Reads the budgets and the month's totals on the database thread.
+ *        Both are read by one call, so they describe the same moment. Transactions reported
+ *        before the result arrives were written before the read and are already in it.
+ */
+void BudgetEngine::reload()
+{
+    m_reading = true;
+    int generation = ++m_generation;
+    int userID = m_userID;
+    QDate month = m_month;
+
+    // Read both on the database thread.
+    using Snapshot = QPair<QVector<Budget>, QVector<MonthlyTotal>>;
+    AsyncDatabase *db = AsyncDatabase::getInstance();
+    db->run([userID, month](Database &db) {
+          return Snapshot(db.getBudgets(userID),
+                          db.getMonthlyTotals(userID, month, month, -1, true));
+      })
+        .then(this, [this, generation](const Snapshot &snapshot) {
+            // Discard results of reads started before the last one.
+            if (generation != m_generation) {
+                return;
+            }
+            m_reading = false;
+            m_loaded = true;
+
+            // Keep the budgets and total the month per category and subcategory.
+            m_budgets = snapshot.first;
+            m_categoryTotals.clear();
+            m_subcategoryTotals.clear();
+            for (const MonthlyTotal &total : snapshot.second) {
+                Money &categoryTotal = m_categoryTotals[total.categoryID];
+                std::optional<Money> sum = categoryTotal.checkedAdd(total.total);
+                if (sum) {
+                    categoryTotal = *sum;
+                } else {
+                    qDebug() << "Total of category" << total.categoryID << "overflows";
+                }
+                m_subcategoryTotals.insert(subcategoryKey(total.categoryID, total.subcategoryID),
+                                           total.total);
+            }
+
+            emit changed();
+        });
+}
+
+/**
+ * @brief Applies inserted and deleted transactions of the tracked month to its totals.
+ *        Each change moves one category total and one subcategory total, so statuses stay
+ *        current without reading the database.
+ * @param change The changes.
+ */
+void BudgetEngine::applyChange(const LedgerChange &change)
+{
+    // A read in flight already holds the changes reported before it completes.
+    if (change.userID != m_userID || m_reading) {
+        return;
+    }
+
+    bool changedMonth = false;
+    for (const TransactionChange &transactionChange : change.changes) {
+        const Transaction &transaction = transactionChange.transaction;
+
+        // Only the tracked month's transactions count.
+        QDate date = transaction.date();
+        if (date.year() != m_month.year() || date.month() != m_month.month()) {
+            continue;
+        }
+
+        // Inserted amounts are added to the totals and deleted ones taken out.
+        Money amount = transactionChange.kind == ChangeKind::Inserted ? transaction.amount()
+                                                                       : -transaction.amount();
+
+        Money &categoryTotal = m_categoryTotals[transaction.categoryID()];
+        Money &subcategoryTotal = m_subcategoryTotals[subcategoryKey(transaction.categoryID(),
+                                                                     transaction.subcategoryID())];
+        std::optional<Money> category = categoryTotal.checkedAdd(amount);
+        std::optional<Money> subcategory = subcategoryTotal.checkedAdd(amount);
+
+        // Totals that cannot be kept exactly are read again.
+        if (!category || !subcategory) {
+            reload();
+            return;
+        }
+        categoryTotal = *category;
+        subcategoryTotal = *subcategory;
+        changedMonth = true;
+    }
+
+    if (changedMonth) {
+        emit changed();
+    }
+}
+
+/**
+ * @brief Gets the status of a budget from the month's totals.
+ *        Withdrawals are negative amounts, so spending is the negated total.
+ * @param budget The budget.
+ * @return The status.
+ */
+BudgetStatus BudgetEngine::statusOf(const Budget &budget) const
+{
+    Money total = budget.subcategoryID() == 0
+                      ? m_categoryTotals.value(budget.categoryID())
+                      : m_subcategoryTotals.value(subcategoryKey(budget.categoryID(),
+                                                                 budget.subcategoryID()));
+    return {budget, -total};
+}
+
+/**
+ * @brief Builds the key of a subcategory's total.
+ * @param categoryID The ID of the parent category.
+ * @param subcategoryID The ID of the subcategory.
+ * @return The key.
+ */
+qint64 BudgetEngine::subcategoryKey(int categoryID, int subcategoryID)
+{
+    return (qint64(categoryID) << 32) | quint32(subcategoryID);
+}
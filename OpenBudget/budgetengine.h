@@ -0,0 +1,84 @@
+#ifndef BUDGETENGINE_H
+#define BUDGETENGINE_H
+
+#include <QDate>
+#include <QHash>
+#include <QObject>
+#include <QVector>
+#include <optional>
+#include "budget.h"
+#include "changenotifier.h"
+
+// A budget and the month's spending against it.
+struct BudgetStatus
+{
+    Budget budget;
+    Money spent; // Withdrawals in the month less refunds.
+
+    // The amount left to spend; negative when over budget.
+    Money remaining() const { return Money::fromCents(budget.amount().cents() - spent.cents()); }
+
+    // Whether more than the budget was spent.
+    bool isOverBudget() const { return spent > budget.amount(); }
+};
+
+/**
+ * @brief The BudgetEngine class keeps a user's budgets and the month's spending against them.
+ *        Spending is read once from the monthly rollup and then updated from the transactions
+ *        the ChangeNotifier reports inserted or deleted, so statuses never rescan the ledger.
+ *        There is one engine per user, shared by every view.
+ */
+class BudgetEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    // The shared engine of a user's budgets.
+    static BudgetEngine *forUser(int userID);
+
+    // The month whose spending is tracked; the current month unless changed.
+    QDate month() const;
+    void setMonth(const QDate &month);
+
+    // Whether the budgets and spending have been read.
+    bool isLoaded() const;
+
+    // Get the status of every budget, ordered by category and subcategory.
+    QVector<BudgetStatus> statuses() const;
+
+    // Get the status of a budget; std::nullopt if there is no such budget.
+    std::optional<BudgetStatus> status(int budgetID) const;
+
+    // Find the budget of a category or subcategory; std::nullopt if it has none.
+    std::optional<Budget> findBudget(int categoryID, int subcategoryID) const;
+
+signals:
+    // The budgets or spending changed.
+    void changed();
+
+private:
+    explicit BudgetEngine(int userID, QObject *parent);
+
+    // Read the budgets and the month's spending.
+    void reload();
+
+    // Apply inserted and deleted transactions to the spending.
+    void applyChange(const LedgerChange &change);
+
+    // Get the status of a budget.
+    BudgetStatus statusOf(const Budget &budget) const;
+
+    // Key of a subcategory's spending.
+    static qint64 subcategoryKey(int categoryID, int subcategoryID);
+
+    int m_userID;
+    QDate m_month;                            // The first day of the tracked month.
+    bool m_loaded = false;                    // Whether a read has completed.
+    bool m_reading = false;                   // Whether a read is in flight.
+    int m_generation = 0;                     // Number of reads; identifies stale results.
+    QVector<Budget> m_budgets;                // The budgets, by category and subcategory.
+    QHash<int, Money> m_categoryTotals;       // Sum of the month's amounts by category.
+    QHash<qint64, Money> m_subcategoryTotals; // Sum of the month's amounts by subcategoryKey.
+};
+
+#endif // BUDGETENGINE_H
@@ -0,0 +1,176 @@
+#include "categorycache.h"
+
+/**
+ * @brief Adds a category to the tree.
+ * @param categoryID The ID of the category.
+ * @param name The name of the category.
+ */
+void CategoryTree::addCategory(int categoryID, const QString &name)
+{
+    categories.insert(categoryID, name);
+    categoryIDs.insert(name, categoryID);
+}
+
+/**
+ * @brief Adds a subcategory to the tree.
+ * @param categoryID The ID of the parent category.
+ * @param subcategoryID The ID of the subcategory.
+ * @param name The name of the subcategory.
+ */
+void CategoryTree::addSubcategory(int categoryID, int subcategoryID, const QString &name)
+{
+    subcategories[categoryID].insert(subcategoryID, name);
+    subcategoryIDs.insert(qMakePair(categoryID, name), subcategoryID);
+}
+
+/**
+ * @brief Gets the process wide category cache.
+ * @return The cache.
+ */
+CategoryCache &CategoryCache::instance()
+{
+    static CategoryCache cache;
+    return cache;
+}
+
+/**
+ * @brief Gets a user's cached tree.
+ * @param userID The ID of the user.
+ * @return A copy of the tree; std::nullopt if it is not cached.
+ */
+std::optional<CategoryTree> CategoryCache::tree(int userID) const
+{
+    QReadLocker locker(&m_lock);
+
+    auto tree = m_trees.constFind(userID);
+    if (tree == m_trees.constEnd()) {
+        return std::nullopt;
+    }
+
+    // The containers are implicitly shared, so the copy is cheap.
+    return *tree;
+}
+
+/**
+ * @brief Gets the name of a subcategory of any cached tree.
+ * @param subcategoryID The ID of the subcategory.
+ * @return The name; std::nullopt if the subcategory is not cached.
+ */
+std::optional<QString> CategoryCache::subcategoryName(int subcategoryID) const
+{
+    QReadLocker locker(&m_lock);
+
+    auto name = m_subcategoryNames.constFind(subcategoryID);
+    if (name == m_subcategoryNames.constEnd()) {
+        return std::nullopt;
+    }
+
+    return *name;
+}
+
+/**
+ * @brief Gets the number of changes made to a user's categories, including the categories
+ *        shared by every user.
+ * @param userID The ID of the user.
+ * @return The generation to pass to insert.
+ */
+quint64 CategoryCache::generation(int userID) const
+{
+    QReadLocker locker(&m_lock);
+    return m_generations.value(userID) + m_sharedGeneration;
+}
+
+/**
+ * @brief Caches a user's tree.
+ *        A tree read while another connection added a category may miss it, so it is dropped
+ *        if the user's categories changed after generation was read.
+ * @param userID The ID of the user.
+ * @param tree The user's tree.
+ * @param generation The user's generation, read before the tree was loaded.
+ */
+void CategoryCache::insert(int userID, const CategoryTree &tree, quint64 generation)
+{
+    QWriteLocker locker(&m_lock);
+
+    if (m_generations.value(userID) + m_sharedGeneration != generation) {
+        return;
+    }
+
+    m_trees.insert(userID, tree);
+    for (auto category = tree.subcategories.begin(); category != tree.subcategories.end();
+         ++category) {
+        for (auto subcategory = category->begin(); subcategory != category->end(); ++subcategory) {
+            m_subcategoryNames.insert(subcategory.key(), subcategory.value());
+        }
+    }
+}
+
+/**
+ * @brief Adds a new category to the user's cached tree.
+ *        Categories of user 0 are shared by every user, so every tree is dropped.
+ * @param userID The ID of the user.
+ * @param categoryID The ID of the category.
+ * @param name The name of the category.
+ */
+void CategoryCache::addCategory(int userID, int categoryID, const QString &name)
+{
+    QWriteLocker locker(&m_lock);
+
+    if (userID == 0) {
+        ++m_sharedGeneration;
+        m_trees.clear();
+        return;
+    }
+
+    ++m_generations[userID];
+    auto tree = m_trees.find(userID);
+    if (tree != m_trees.end()) {
+        tree->addCategory(categoryID, name);
+    }
+}
+
+/**
+ * @brief Adds a new subcategory to the user's cached tree.
+ * @param userID The ID of the user.
+ * @param categoryID The ID of the parent category.
+ * @param subcategoryID The ID of the subcategory.
+ * @param name The name of the subcategory.
+ */
+void CategoryCache::addSubcategory(int userID,
+                                   int categoryID,
+                                   int subcategoryID,
+                                   const QString &name)
+{
+    QWriteLocker locker(&m_lock);
+
+    ++m_generations[userID];
+    m_subcategoryNames.insert(subcategoryID, name);
+    auto tree = m_trees.find(userID);
+    if (tree != m_trees.end()) {
+        tree->addSubcategory(categoryID, subcategoryID, name);
+    }
+}
+
+/**
+ * @brief Forgets a user's tree; it is loaded again on next use.
+ * @param userID The ID of the user.
+ */
+void CategoryCache::invalidate(int userID)
+{
+    QWriteLocker locker(&m_lock);
+
+    ++m_generations[userID];
+    m_trees.remove(userID);
+}
+
+/**
+ * @brief Forgets every tree.
+ */
+void CategoryCache::clear()
+{
+    QWriteLocker locker(&m_lock);
+
+    ++m_sharedGeneration;
+    m_trees.clear();
+    m_subcategoryNames.clear();
+}
@@ -0,0 +1,67 @@
+#ifndef CATEGORYCACHE_H
+#define CATEGORYCACHE_H
+
+#include <QHash>
+#include <QMap>
+#include <QPair>
+#include <QReadWriteLock>
+#include <QString>
+#include <optional>
+
+// A user's categories and subcategories.
+struct CategoryTree
+{
+    QMap<int, QString> categories;                  // Category names by ID.
+    QHash<int, QMap<int, QString>> subcategories;   // Subcategory names by ID, by category ID.
+    QHash<QString, int> categoryIDs;                // Category IDs by name.
+    QHash<QPair<int, QString>, int> subcategoryIDs; // Subcategory IDs by category ID and name.
+
+    // Add a category or subcategory.
+    void addCategory(int categoryID, const QString &name);
+    void addSubcategory(int categoryID, int subcategoryID, const QString &name);
+};
+
+/**
+ * @brief The CategoryCache class keeps each user's category tree in memory, shared by every
+ *        database connection in the process. Trees are loaded on first use and kept correct
+ *        by writing new categories through to them.
+ *        The cache is safe to use from any thread.
+ */
+class CategoryCache
+{
+public:
+    // The process wide cache.
+    static CategoryCache &instance();
+
+    // Get a user's tree; std::nullopt if it is not cached.
+    std::optional<CategoryTree> tree(int userID) const;
+
+    // Get the name of any cached subcategory; std::nullopt if it is not cached.
+    std::optional<QString> subcategoryName(int subcategoryID) const;
+
+    // Number of changes made to a user's categories.
+    // Read it before loading a tree and pass it to insert.
+    quint64 generation(int userID) const;
+
+    // Cache a user's tree, unless the user's categories changed since generation was read.
+    void insert(int userID, const CategoryTree &tree, quint64 generation);
+
+    // Write a new category or subcategory through to the user's cached tree.
+    void addCategory(int userID, int categoryID, const QString &name);
+    void addSubcategory(int userID, int categoryID, int subcategoryID, const QString &name);
+
+    // Forget a user's tree, or every tree.
+    void invalidate(int userID);
+    void clear();
+
+private:
+    CategoryCache() = default;
+
+    mutable QReadWriteLock m_lock;
+    QHash<int, CategoryTree> m_trees;       // Trees by user ID.
+    QHash<int, QString> m_subcategoryNames; // Names of the subcategories of cached trees.
+    QHash<int, quint64> m_generations;      // Changes by user ID.
+    quint64 m_sharedGeneration = 0;         // Changes to categories shared by every user.
+};
+
+#endif // CATEGORYCACHE_H
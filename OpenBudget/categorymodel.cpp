@@ -0,0 +1,381 @@
+#include "categorymodel.h"
+#include <QConcatenateTablesProxyModel>
+#include <QCoreApplication>
+#include <QStandardItemModel>
+#include <algorithm>
+#include "asyncdatabase.h"
+#include "changenotifier.h"
+
+// Internal ID of category rows; subcategory rows hold their category's row plus one.
+static constexpr quintptr CATEGORY_ROW = 0;
+
+/**
+ * @brief Gets the shared model of a user's categories, creating it on first use.
+ *        The models belong to the application.
+ * @param userID The ID of the user.
+ * @return The user's model.
+ */
+CategoryModel *CategoryModel::forUser(int userID)
+{
+    static QHash<int, CategoryModel *> models;
+
+    CategoryModel *&model = models[userID];
+    if (!model) {
+        model = new CategoryModel(userID, QCoreApplication::instance());
+    }
+
+    return model;
+}
+
+/**
+ * @brief Creates a flat model of placeholder items followed by a user's categories, for combo
+ *        boxes that offer choices such as "Select a category" besides the categories.
+ * @param userID The ID of the user.
+ * @param placeholders The text and ID of each placeholder item, in order.
+ * @param parent The owner of the new model.
+ * @return The combined model.
+ */
+QAbstractItemModel *CategoryModel::withPlaceholders(int userID,
+                                                    const QList<QPair<QString, int>> &placeholders,
+                                                    QObject *parent)
+{
+    // Create the placeholder items.
+    QStandardItemModel *placeholderModel = new QStandardItemModel(parent);
+    for (const QPair<QString, int> &placeholder : placeholders) {
+        QStandardItem *item = new QStandardItem(placeholder.first);
+        item->setData(placeholder.second, IDRole);
+        placeholderModel->appendRow(item);
+    }
+
+    // Follow them with the shared categories.
+    QConcatenateTablesProxyModel *model = new QConcatenateTablesProxyModel(parent);
+    model->addSourceModel(placeholderModel);
+    model->addSourceModel(forUser(userID));
+    return model;
+}
+
+/**
+ * @brief Creates the model and starts reading the user's categories.
+ * @param userID The ID of the user.
+ * @param parent Pointer to the parent object.
+ */
+CategoryModel::CategoryModel(int userID, QObject *parent)
+    : QAbstractItemModel{parent}
+    , m_userID{userID}
+{
+    // Combo boxes do not fetch on their own, so read the categories now.
+    fetchMore(QModelIndex());
+
+    // Add the categories created from now on.
+    ChangeNotifier *notifier = ChangeNotifier::getInstance();
+    connect(notifier, &ChangeNotifier::categoryAdded, this, &CategoryModel::addCategory);
+    connect(notifier, &ChangeNotifier::subcategoryAdded, this, &CategoryModel::addSubcategory);
+}
+
+/**
+ * @brief Gets the index of a category.
+ * @param categoryID The ID of the category.
+ * @return The category's index; invalid if the category is not loaded.
+ */
+QModelIndex CategoryModel::categoryIndex(int categoryID) const
+{
+    auto row = m_categoryRows.constFind(categoryID);
+    if (row == m_categoryRows.constEnd()) {
+        return QModelIndex();
+    }
+
+    return createIndex(row.value(), 0, CATEGORY_ROW);
+}
+
+/**
+ * @brief Loads a category's subcategories if they are not loaded yet.
+ * @param category The index of the category.
+ */
+void CategoryModel::loadSubcategories(const QModelIndex &category)
+{
+    if (canFetchMore(category)) {
+        fetchMore(category);
+    }
+}
+
+/**
+ * @brief Adds a category created for a user, if it is this model's user.
+ *        Until the categories are read the model has no rows, and the new category arrives
+ *        with the others.
+ * @param userID The ID of the user.
+ * @param categoryID The ID of the category.
+ * @param name The name of the category.
+ */
+void CategoryModel::addCategory(int userID, int categoryID, const QString &name)
+{
+    if (userID == m_userID && (m_loaded || m_fetching)) {
+        appendCategories({qMakePair(categoryID, name)});
+    }
+}
+
+/**
+ * @brief Adds a subcategory created for a user, if it is this model's user.
+ *        Until the category's subcategories are read, the new subcategory arrives with them.
+ * @param userID The ID of the user.
+ * @param categoryID The ID of the parent category.
+ * @param subcategoryID The ID of the subcategory.
+ * @param name The name of the subcategory.
+ */
+void CategoryModel::addSubcategory(int userID,
+                                   int categoryID,
+                                   int subcategoryID,
+                                   const QString &name)
+{
+    auto row = m_categoryRows.constFind(categoryID);
+    if (userID != m_userID || row == m_categoryRows.constEnd()) {
+        return;
+    }
+
+    const Category &category = m_categories.at(row.value());
+    if (category.subcategoriesLoaded || category.subcategoriesFetching) {
+        appendSubcategories(row.value(), {qMakePair(subcategoryID, name)});
+    }
+}
+
+/**
+ * @brief Gets the index of a category or subcategory.
+ * @param row The row.
+ * @param column The column; there is one.
+ * @param parent The parent; invalid for categories, a category for subcategories.
+ * @return The index; invalid if there is no such row.
+ */
+QModelIndex CategoryModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (!hasIndex(row, column, parent)) {
+        return QModelIndex();
+    }
+
+    // Subcategories remember their category's row.
+    if (parent.isValid()) {
+        return createIndex(row, column, quintptr(parent.row()) + 1);
+    }
+
+    return createIndex(row, column, CATEGORY_ROW);
+}
+
+/**
+ * @brief Gets the parent of a category or subcategory.
+ * @param child The index.
+ * @return The category of a subcategory; invalid for categories.
+ */
+QModelIndex CategoryModel::parent(const QModelIndex &child) const
+{
+    if (!child.isValid() || child.internalId() == CATEGORY_ROW) {
+        return QModelIndex();
+    }
+
+    return createIndex(int(child.internalId() - 1), 0, CATEGORY_ROW);
+}
+
+/**
+ * @brief Gets the number of categories, or of a category's loaded subcategories.
+ * @param parent The parent.
+ * @return The number of rows.
+ */
+int CategoryModel::rowCount(const QModelIndex &parent) const
+{
+    if (!parent.isValid()) {
+        return m_categories.size();
+    }
+    if (parent.internalId() == CATEGORY_ROW && parent.column() == 0) {
+        return m_categories.at(parent.row()).subcategories.size();
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Gets the number of columns.
+ * @param parent The parent.
+ * @return One; the name.
+ */
+int CategoryModel::columnCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent);
+    return 1;
+}
+
+/**
+ * @brief Checks whether a row may have children.
+ *        Categories whose subcategories are not read yet may have some.
+ * @param parent The parent.
+ * @return Returns true if the row has or may have children.
+ */
+bool CategoryModel::hasChildren(const QModelIndex &parent) const
+{
+    if (!parent.isValid()) {
+        return !m_categories.isEmpty() || !m_loaded;
+    }
+    if (parent.internalId() == CATEGORY_ROW) {
+        const Category &category = m_categories.at(parent.row());
+        return !category.subcategoriesLoaded || !category.subcategories.isEmpty();
+    }
+
+    return false;
+}
+
+/**
+ * @brief Gets the name or ID of a category or subcategory.
+ * @param index The index.
+ * @param role The role; the display and edit roles hold the name and IDRole the ID.
+ * @return The data; invalid for other roles.
+ */
+QVariant CategoryModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid()) {
+        return QVariant();
+    }
+
+    // Find the row's category or subcategory.
+    int id = 0;
+    QString name;
+    if (index.internalId() == CATEGORY_ROW) {
+        const Category &category = m_categories.at(index.row());
+        id = category.categoryID;
+        name = category.name;
+    } else {
+        const Subcategory &subcategory = m_categories.at(int(index.internalId() - 1))
+                                             .subcategories.at(index.row());
+        id = subcategory.subcategoryID;
+        name = subcategory.name;
+    }
+
+    switch (role) {
+    case Qt::DisplayRole:
+    case Qt::EditRole:
+        return name;
+    case IDRole:
+        return id;
+    default:
+        return QVariant();
+    }
+}
+
+/**
+ * @brief Checks whether the categories, or a category's subcategories, are yet to be read.
+ * @param parent The parent.
+ * @return Returns true if there are rows to read.
+ */
+bool CategoryModel::canFetchMore(const QModelIndex &parent) const
+{
+    if (!parent.isValid()) {
+        return !m_loaded && !m_fetching;
+    }
+    if (parent.internalId() == CATEGORY_ROW) {
+        const Category &category = m_categories.at(parent.row());
+        return !category.subcategoriesLoaded && !category.subcategoriesFetching;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Reads the categories, or a category's subcategories, on the database thread.
+ *        Lookups the CategoryCache can answer complete without the database.
+ * @param parent The parent.
+ */
+void CategoryModel::fetchMore(const QModelIndex &parent)
+{
+    if (!canFetchMore(parent)) {
+        return;
+    }
+
+    AsyncDatabase *db = AsyncDatabase::getInstance();
+
+    // Read the categories.
+    if (!parent.isValid()) {
+        m_fetching = true;
+        db->getCategoryNames(m_userID).then(this, [this](const QMap<int, QString> &categories) {
+            m_fetching = false;
+            m_loaded = true;
+
+            QList<QPair<int, QString>> rows;
+            for (auto category = categories.begin(); category != categories.end(); ++category) {
+                rows.append(qMakePair(category.key(), category.value()));
+            }
+            appendCategories(rows);
+        });
+        return;
+    }
+
+    // Read the category's subcategories.
+    int row = parent.row();
+    Category &category = m_categories[row];
+    category.subcategoriesFetching = true;
+    db->getSubcategoryNames(m_userID, category.categoryID)
+        .then(this, [this, row](const QMap<int, QString> &subcategories) {
+            Category &category = m_categories[row];
+            category.subcategoriesFetching = false;
+            category.subcategoriesLoaded = true;
+
+            QList<QPair<int, QString>> rows;
+            for (auto subcategory = subcategories.begin(); subcategory != subcategories.end();
+                 ++subcategory) {
+                rows.append(qMakePair(subcategory.key(), subcategory.value()));
+            }
+            appendSubcategories(row, rows);
+        });
+}
+
+/**
+ * @brief Appends the categories that are not in the model yet, notifying views of the new rows.
+ * @param categories The ID and name of each category.
+ */
+void CategoryModel::appendCategories(const QList<QPair<int, QString>> &categories)
+{
+    // Skip categories that were added while they were being read.
+    QVector<Category> added;
+    for (const QPair<int, QString> &category : categories) {
+        if (!m_categoryRows.contains(category.first)) {
+            added.append({category.first, category.second, {}});
+        }
+    }
+    if (added.isEmpty()) {
+        return;
+    }
+
+    int first = m_categories.size();
+    beginInsertRows(QModelIndex(), first, first + added.size() - 1);
+    for (Category &category : added) {
+        m_categoryRows.insert(category.categoryID, m_categories.size());
+        m_categories.append(std::move(category));
+    }
+    endInsertRows();
+}
+
+/**
+ * @brief Appends the subcategories that are not in a category yet, notifying views of the new
+ *        rows.
+ * @param row The row of the category.
+ * @param subcategories The ID and name of each subcategory.
+ */
+void CategoryModel::appendSubcategories(int row, const QList<QPair<int, QString>> &subcategories)
+{
+    Category &category = m_categories[row];
+
+    // Skip subcategories that were added while they were being read.
+    QVector<Subcategory> added;
+    for (const QPair<int, QString> &subcategory : subcategories) {
+        bool present = std::any_of(category.subcategories.cbegin(),
+                                   category.subcategories.cend(),
+                                   [&subcategory](const Subcategory &existing) {
+                                       return existing.subcategoryID == subcategory.first;
+                                   });
+        if (!present) {
+            added.append({subcategory.first, subcategory.second});
+        }
+    }
+    if (added.isEmpty()) {
+        return;
+    }
+
+    int first = category.subcategories.size();
+    beginInsertRows(createIndex(row, 0, CATEGORY_ROW), first, first + added.size() - 1);
+    category.subcategories.append(added);
+    endInsertRows();
+}
@@ -0,0 +1,87 @@
+#ifndef CATEGORYMODEL_H
+#define CATEGORYMODEL_H
+
+#include <QAbstractItemModel>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief The CategoryModel class exposes a user's categories, with their subcategories as
+ *        children, to every combo box that lists them. There is one model per user, shared by
+ *        all views. Categories are read when the model is created and subcategories when a
+ *        category is first expanded; categories the ChangeNotifier reports arrive as row
+ *        insertions, so views never reload.
+ */
+class CategoryModel : public QAbstractItemModel
+{
+    Q_OBJECT
+
+public:
+    // Role holding the ID of a category or subcategory; QComboBox::currentData reads it.
+    static constexpr int IDRole = Qt::UserRole;
+
+    // The shared model of a user's categories.
+    static CategoryModel *forUser(int userID);
+
+    // A flat model of placeholder items, given as (text, ID) pairs, followed by the categories.
+    static QAbstractItemModel *withPlaceholders(int userID,
+                                                const QList<QPair<QString, int>> &placeholders,
+                                                QObject *parent);
+
+    // Get the index of a category; invalid if it is not loaded.
+    QModelIndex categoryIndex(int categoryID) const;
+
+    // Load a category's subcategories if they are not loaded yet.
+    void loadSubcategories(const QModelIndex &category);
+
+    // QAbstractItemModel interface.
+    QModelIndex index(int row,
+                      int column,
+                      const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+private:
+    explicit CategoryModel(int userID, QObject *parent);
+
+    // Add a category or subcategory created for the user.
+    void addCategory(int userID, int categoryID, const QString &name);
+    void addSubcategory(int userID, int categoryID, int subcategoryID, const QString &name);
+
+    // A subcategory row.
+    struct Subcategory
+    {
+        int subcategoryID;
+        QString name;
+    };
+
+    // A category row and its children.
+    struct Category
+    {
+        int categoryID;
+        QString name;
+        QVector<Subcategory> subcategories;
+        bool subcategoriesLoaded = false;
+        bool subcategoriesFetching = false;
+    };
+
+    // Append categories or subcategories that are not in the model yet.
+    void appendCategories(const QList<QPair<int, QString>> &categories);
+    void appendSubcategories(int row, const QList<QPair<int, QString>> &subcategories);
+
+    int m_userID;
+    bool m_loaded = false;          // Whether the categories were read.
+    bool m_fetching = false;        // Whether the categories are being read.
+    QVector<Category> m_categories; // Categories in the order read; rows are never removed.
+    QHash<int, int> m_categoryRows; // Rows by category ID.
+};
+
+#endif // CATEGORYMODEL_H
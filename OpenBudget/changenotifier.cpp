@@ -0,0 +1,80 @@
+#include "changenotifier.h"
+#include <QCoreApplication>
+#include <QMutex>
+
+/**
+ * @brief Checks whether the change comes before a position in the ledger.
+ *        The ledger is ordered by date and then by transaction ID.
+ * @param date The date of the position.
+ * @param transactionID The transaction ID of the position.
+ * @return Returns true if the changed row is ordered before the position.
+ */
+bool TransactionChange::isBefore(const QDate &date, int transactionID) const
+{
+    if (transaction.date() != date) {
+        return transaction.date() < date;
+    }
+
+    return transaction.transactionID() < transactionID;
+}
+
+/**
+ * @brief Starts a walk over a ledger from its first row.
+ * @param change The change whose deltas to add; must outlive the sweep.
+ */
+BalanceSweep::BalanceSweep(const LedgerChange &change)
+    : m_changes{change.changes}
+{}
+
+/**
+ * @brief Gets the balance delta of the next row visited.
+ * @param date The date of the row.
+ * @param transactionID The ID of the row.
+ * @return The sum of the deltas of every change before the row; std::nullopt if it overflows.
+ */
+std::optional<Money> BalanceSweep::deltaAt(const QDate &date, int transactionID)
+{
+    // Add the changes passed since the previous row.
+    while (m_next < m_changes.size() && m_changes.at(m_next).isBefore(date, transactionID)) {
+        std::optional<Money> delta = m_delta.checkedAdd(m_changes.at(m_next).balanceDelta);
+        if (!delta) {
+            return std::nullopt;
+        }
+        m_delta = *delta;
+        ++m_next;
+    }
+
+    return m_delta;
+}
+
+/**
+ * @brief ChangeNotifier singleton instance getter.
+ *        The instance belongs to the application and lives on its thread, whichever thread
+ *        asks for it first.
+ * @return ChangeNotifier singleton instance.
+ */
+ChangeNotifier *ChangeNotifier::getInstance()
+{
+    static QMutex mutex;
+    static ChangeNotifier *instance = nullptr;
+
+    QMutexLocker locker(&mutex);
+    if (!instance) {
+        instance = new ChangeNotifier(nullptr);
+        instance->moveToThread(QCoreApplication::instance()->thread());
+        instance->setParent(QCoreApplication::instance());
+    }
+
+    return instance;
+}
+
+/**
+ * @brief Creates the notifier.
+ * @param parent Pointer to the parent object.
+ */
+ChangeNotifier::ChangeNotifier(QObject *parent)
+    : QObject{parent}
+{
+    // Ledger changes are queued to receivers on other threads.
+    qRegisterMetaType<LedgerChange>();
+}
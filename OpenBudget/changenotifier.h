@@ -0,0 +1,81 @@
+#ifndef CHANGENOTIFIER_H
+#define CHANGENOTIFIER_H
+
+#include <QMetaType>
+#include <QObject>
+#include <QVector>
+#include "transaction.h"
+
+// Kind of change made to a transaction.
+enum class ChangeKind : int { Inserted, Deleted };
+
+// A transaction that was inserted or deleted.
+struct TransactionChange
+{
+    ChangeKind kind = ChangeKind::Inserted;
+    Transaction transaction; // The row as stored, with its names; deleted rows keep their IDs,
+                             // date and amount.
+    Money balanceDelta;      // Added to the balance of every row after this one in ledger order.
+
+    // Whether the change comes before a ledger position.
+    bool isBefore(const QDate &date, int transactionID) const;
+};
+
+// The changes one write made to a user's ledger, in ledger order.
+struct LedgerChange
+{
+    int userID = 0;
+    QVector<TransactionChange> changes;
+};
+
+Q_DECLARE_METATYPE(LedgerChange)
+
+/**
+ * @brief The BalanceSweep class adds up a ledger change's balance deltas while walking a
+ *        ledger in order, so the rows after a change can be fixed in a single pass.
+ */
+class BalanceSweep
+{
+public:
+    explicit BalanceSweep(const LedgerChange &change);
+
+    // Get the delta for the next row; rows must be visited in ledger order.
+    // Returns std::nullopt if the deltas overflow.
+    std::optional<Money> deltaAt(const QDate &date, int transactionID);
+
+private:
+    const QVector<TransactionChange> &m_changes;
+    int m_next = 0; // The first change not added yet.
+    Money m_delta;  // Sum of the deltas added so far.
+};
+
+/**
+ * @brief The ChangeNotifier class tells views what the database changed, so they can update the
+ *        rows they show instead of reading everything again. Database emits its signals after
+ *        each committed write, from whichever thread made it; receivers on the GUI thread get
+ *        them queued, in the order the writes were made.
+ */
+class ChangeNotifier : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Singleton instance getter.
+    static ChangeNotifier *getInstance();
+
+signals:
+    // Transactions were inserted or deleted.
+    void ledgerChanged(const LedgerChange &change);
+
+    // A category or subcategory was created.
+    void categoryAdded(int userID, int categoryID, const QString &name);
+    void subcategoryAdded(int userID, int categoryID, int subcategoryID, const QString &name);
+
+    // A budget was created, changed or deleted.
+    void budgetsChanged(int userID);
+
+private:
+    explicit ChangeNotifier(QObject *parent);
+};
+
+#endif // CHANGENOTIFIER_H
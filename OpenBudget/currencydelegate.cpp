@@ -1,4 +1,5 @@
 #include "currencydelegate.h"
+#include "money.h"
 
 CurrencyDelegate::CurrencyDelegate(QWidget *parent)
     : QStyledItemDelegate(parent)
@@ -6,6 +7,11 @@ CurrencyDelegate::CurrencyDelegate(QWidget *parent)
 
 QString CurrencyDelegate::displayText(const QVariant &value, const QLocale &locale) const
 {
+    // Format exact amounts from their cents
+    if (value.canConvert<Money>()) {
+        return value.value<Money>().toString(locale);
+    }
+
     // Format the amount to display two decimal places
     return locale.toString(value.toDouble(), 'f', 2);
 }
@@ -3,7 +3,7 @@
 
 #include <QStyledItemDelegate>
 
-// Custom delegate for formatting the "Amount" column
+// Custom delegate for formatting the "Amount" and "Balance" columns when they are painted
 class CurrencyDelegate : public QStyledItemDelegate
 {
 public:
@@ -1,49 +1,220 @@
 #include "database.h"
+#include "changenotifier.h"
 #include "position.h"
 #include "qstandardpaths.h"
+#include "schemamigrator.h"
 #include "user.h"
 
 #include <QMessageBox>
 #include <QSqlError>
 #include <QSqlQuery>
+#include <QSqlRecord>
 
 #include <QDir>
+#include <QMutex>
+#include <QReadWriteLock>
+#include <QRegularExpression>
+#include <QSet>
+#include <QWaitCondition>
+
+#include <algorithm>
+#include <utility>
 
 // Singleton instance of Database.
 Database *Database::INSTANCE = nullptr;
 
+// Settings applied to each connection as it opens.
+DurabilitySettings Database::DURABILITY = DurabilitySettings::forProfile(
+    DurabilityProfile::Balanced);
+
+// SQL names of the checkpoint modes, indexed by mode.
+static const char *const CHECKPOINT_MODE_NAMES[] = {"PASSIVE", "FULL", "RESTART", "TRUNCATE"};
+
+// Julian day of 1970-01-01; transaction dates are stored as days since then.
+static const qint64 EPOCH_JULIAN_DAY = 2440588;
+
+/**
+ * @brief Converts a date to the day number it is stored as.
+ * @param date The date.
+ * @return Days since 1970-01-01.
+ */
+static qint64 toEpochDay(const QDate &date)
+{
+    return date.toJulianDay() - EPOCH_JULIAN_DAY;
+}
+
+/**
+ * @brief Converts a stored day number back to a date.
+ * @param epochDay Days since 1970-01-01.
+ * @return The date.
+ */
+static QDate fromEpochDay(qint64 epochDay)
+{
+    return QDate::fromJulianDay(epochDay + EPOCH_JULIAN_DAY);
+}
+
+/**
+ * @brief Converts a date to the number of the month it falls in, as the monthly rollup
+ *        stores it.
+ * @param date The date.
+ * @return Months since January 1970.
+ */
+static int toEpochMonth(const QDate &date)
+{
+    return (date.year() - 1970) * 12 + date.month() - 1;
+}
+
+/**
+ * @brief Converts a stored month number back to the first day of the month.
+ * @param epochMonth Months since January 1970.
+ * @return The first day of the month.
+ */
+static QDate fromEpochMonth(int epochMonth)
+{
+    // Round down for months before 1970.
+    int years = epochMonth >= 0 ? epochMonth / 12 : (epochMonth - 11) / 12;
+    return QDate(1970 + years, epochMonth - years * 12 + 1, 1);
+}
+
+// Held by a ledger write from its commit until its change is announced, and by ledger page
+// reads on other connections while they take their snapshot, so a page never shows a change
+// whose announcement is still to come.
+static QReadWriteLock LEDGER_ANNOUNCE_LOCK;
+
+// Name prefix of the pooled connections; each is suffixed with its slot.
+static const char *POOL_CONNECTION = "OpenBudgetPool";
+
+namespace {
+
+// The connections leased to threads other than the default connection's.
+struct ConnectionPool
+{
+    QMutex mutex;
+    QWaitCondition released; // Signalled when a connection is returned.
+    QList<int> freeSlots;    // Slots whose connections are closed.
+
+    // Every slot is free until a thread leases it; slot 0 is the default connection.
+    ConnectionPool()
+    {
+        for (int slot = 1; slot < Database::MAX_CONNECTIONS; ++slot) {
+            freeSlots.append(slot);
+        }
+    }
+};
+
+// The calling thread's instance; a pooled one is returned when the thread finishes.
+struct ThreadInstance
+{
+    Database *database = nullptr;
+    int slot = 0; // The pool slot leased; 0 for the default connection.
+
+    ~ThreadInstance() { Database::releaseInstance(); }
+};
+
+} // namespace
+
+/**
+ * @brief Gets the pool of connections.
+ * @return The pool.
+ */
+static ConnectionPool &connectionPool()
+{
+    static ConnectionPool pool;
+    return pool;
+}
+
+// The instance of each thread.
+static thread_local ThreadInstance THREAD_INSTANCE;
+
 /**
- * @brief Database singleton instance getter.
- * @return Database singleton instance.
+ * @brief Gets the calling thread's instance, opening its connection on first use.
+ *        The first thread to ask opens the default connection and creates or migrates the
+ *        schema; threads asking meanwhile wait for it. Every later thread leases one of the
+ *        MAX_CONNECTIONS - 1 pooled connections, waiting while all are leased, and keeps it
+ *        until it finishes or calls releaseInstance().
+ * @return The calling thread's instance.
  */
 Database *Database::getInstance()
 {
+    ThreadInstance &instance = THREAD_INSTANCE;
+    if (instance.database) {
+        return instance.database;
+    }
+
+    ConnectionPool &pool = connectionPool();
+    QMutexLocker locker(&pool.mutex);
+
+    // The first thread opens the default connection and owns the schema.
     if (!INSTANCE) {
         INSTANCE = new Database();
+        instance.database = INSTANCE;
+        return INSTANCE;
     }
 
-    return INSTANCE;
+    // Lease a pooled connection, waiting for one to be returned if all are in use.
+    while (pool.freeSlots.isEmpty()) {
+        pool.released.wait(&pool.mutex);
+    }
+    instance.slot = pool.freeSlots.takeFirst();
+    locker.unlock();
+
+    // Open the connection on this thread, which is the only one allowed to use it.
+    instance.database = new Database(QString::fromLatin1(POOL_CONNECTION)
+                                     + QString::number(instance.slot));
+    return instance.database;
 }
 
 /**
- * @brief Database middleware for facilitating database operations.
+ * @brief Closes the calling thread's pooled connection and returns it to the pool, waking a
+ *        thread waiting for one. Statements the thread still holds become invalid.
+ *        The default connection is never closed, so this does nothing on its thread.
  */
-Database::Database()
+void Database::releaseInstance()
 {
-    // Get the user's home directory
-    QString homeDir = QStandardPaths::writableLocation(QStandardPaths::HomeLocation);
+    ThreadInstance &instance = THREAD_INSTANCE;
+    if (!instance.database || instance.slot == 0) {
+        return;
+    }
 
-    // Specify the name of the SQLite database file
-    QString databaseFileName = QDir(homeDir).filePath("openbudget.db");
+    // Close the connection on the thread that opened it.
+    delete instance.database;
+    instance.database = nullptr;
 
-    // Choose SQLite database driver.
-    db = QSqlDatabase::addDatabase("QSQLITE");
+    // Hand the slot to the next thread.
+    ConnectionPool &pool = connectionPool();
+    QMutexLocker locker(&pool.mutex);
+    pool.freeSlots.append(instance.slot);
+    instance.slot = 0;
+    pool.released.wakeOne();
+}
 
-    // Set name of database.
-    db.setDatabaseName(databaseFileName);
+/**
+ * @brief Sets the durability settings applied to connections opened from now on.
+ *        Connections that are already open keep their settings.
+ * @param settings The settings.
+ */
+void Database::setDurabilitySettings(const DurabilitySettings &settings)
+{
+    DURABILITY = settings;
+}
+
+/**
+ * @brief Gets the durability settings applied to new connections.
+ * @return The settings.
+ */
+DurabilitySettings Database::durabilitySettings()
+{
+    return DURABILITY;
+}
 
+/**
+ * @brief Database middleware for facilitating database operations.
+ *        Opens the default connection and creates or migrates the schema.
+ */
+Database::Database()
+{
     // Open database connection.
-    if (!db.open()) {
+    if (!open(QLatin1String(QSqlDatabase::defaultConnection))) {
         // If connection fails, display error message.
         QMessageBox::critical(nullptr,
                               QObject::tr("Cannot open database"),
@@ -55,81 +226,21 @@ Database::Database()
                               QMessageBox::Cancel);
     }
 
-    // Create a query.
-    QSqlQuery query;
-
-    // Create User table.
-    query.exec("CREATE TABLE IF NOT EXISTS User ("
-               "userID INTEGER PRIMARY KEY AUTOINCREMENT, "
-               "firstname TEXT NOT NULL, "
-               "lastname TEXT NOT NULL, "
-               "position INTEGER NOT NULL CHECK (position IN (0, 1, 2)))");
-    if (!query.isActive()) {
-        qDebug() << "Error creating User table: " << query.lastError().text();
-    }
-
-    // Create UserLogin table.
-    query.exec("CREATE TABLE IF NOT EXISTS UserLogin ("
-               "loginID INTEGER PRIMARY KEY AUTOINCREMENT, "
-               "username TEXT NOT NULL UNIQUE, "
-               "password TEXT NOT NULL, "
-               "accessLevel INTEGER NOT NULL CHECK (accessLevel IN (0, 1, 2)), "
-               "email TEXT NOT NULL UNIQUE, "
-               "userID INTEGER NOT NULL, "
-               "FOREIGN KEY(userID) REFERENCES User(userID))");
-    if (!query.isActive()) {
-        qDebug() << "Error creating UserLogin table: " << query.lastError().text();
-    }
-
-    // Create Category table.
-    query.exec("CREATE TABLE IF NOT EXISTS Category ("
-               "categoryID INTEGER PRIMARY KEY AUTOINCREMENT, "
-               "categoryName TEXT NOT NULL, "
-               "userID INTEGER NOT NULL, "
-               "FOREIGN KEY(userID) REFERENCES User(userID))");
-
-    if (!query.isActive()) {
-        qDebug() << "Error creating Category table: " << query.lastError().text();
-    }
-
-    // Create Subategory table.
-    query.exec("CREATE TABLE IF NOT EXISTS Subcategory ("
-               "subcategoryID INTEGER PRIMARY KEY AUTOINCREMENT, "
-               "subcategoryName TEXT NOT NULL, "
-               "categoryID INTEGER NOT NULL, "
-               "userID INTEGER NOT NULL, "
-               "FOREIGN KEY(userID) REFERENCES User(userID),"
-               "FOREIGN KEY(categoryID) REFERENCES Category(categoryID))");
-
-    if (!query.isActive()) {
-        qDebug() << "Error creating Subcategory table: " << query.lastError().text();
-    }
-
-    // Create Transactions table.
-    query.exec("CREATE TABLE IF NOT EXISTS Transactions ("
-               "transactionID INTEGER PRIMARY KEY AUTOINCREMENT, "
-               "amount DECIMAL(10,2) NOT NULL, "
-               "description TEXT, "
-               "transactionDate TEXT NOT NULL, "
-               "categoryID INTEGER NOT NULL, "
-               "subcategoryID INTEGER, "
-               "userID INTEGER NOT NULL, "
-               "isDeposit BOOLEAN NOT NULL,"
-               "FOREIGN KEY(categoryID) REFERENCES Category(categoryID), "
-               "FOREIGN KEY(subcategoryID) REFERENCES Subcategory(subcategoryID), "
-               "FOREIGN KEY(userID) REFERENCES User(userID))");
-    if (!query.isActive()) {
-        qDebug() << "Error creating Transaction table: " << query.lastError().text();
-    }
-
-    // Create View to dynamically calculate balance
-    query.exec(
-        " CREATE VIEW IF NOT EXISTS TransactionsView AS "
-        " SELECT t.*, "
-        " (SELECT SUM(amount) FROM Transactions WHERE transactionID <= t.transactionID) AS balance "
-        " FROM Transactions AS t");
-    if (!query.isActive()) {
-        qDebug() << "Error creating balance view: " << query.lastError().text();
+    // Create the tables.
+    createSchema();
+}
+
+/**
+ * @brief Database middleware on a named connection, for use by the thread that opens it.
+ *        The schema is created by the default instance, which must exist first.
+ * @param connectionName The name of the connection.
+ */
+Database::Database(const QString &connectionName)
+{
+    // Open database connection.
+    if (!open(connectionName)) {
+        qDebug() << "Error opening database connection " << connectionName << ": "
+                 << db.lastError().text();
     }
 }
 
@@ -138,27 +249,117 @@ Database::Database()
  */
 Database::~Database()
 {
+    // Release the prepared statements before the connection they belong to.
+    clearStatementCache();
     // Close database connection.
+    QString connectionName = db.connectionName();
     db.close();
-    // Delete database instance.
-    delete INSTANCE;
+    db = QSqlDatabase();
+    QSqlDatabase::removeDatabase(connectionName);
+    // Forget the singleton instance.
+    if (INSTANCE == this) {
+        INSTANCE = nullptr;
+    }
+}
+
+/**
+ * @brief Opens a connection to the SQLite database file in the user's home directory.
+ * @param connectionName The name of the connection.
+ * @return Returns true if the connection was opened, false otherwise.
+ */
+bool Database::open(const QString &connectionName)
+{
+    // Get the user's home directory
+    QString homeDir = QStandardPaths::writableLocation(QStandardPaths::HomeLocation);
+
+    // Specify the name of the SQLite database file
+    QString databaseFileName = QDir(homeDir).filePath("openbudget.db");
+
+    // Choose SQLite database driver.
+    db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+
+    // Set name of database.
+    db.setDatabaseName(databaseFileName);
+
+    // Wait for another connection's write to finish instead of failing as locked.
+    db.setConnectOptions(QString("QSQLITE_BUSY_TIMEOUT=%1").arg(DURABILITY.busyTimeout));
+
+    // Open database connection.
+    if (!db.open()) {
+        return false;
+    }
+
+    // Apply the journal, sync and cache settings before the first statement runs.
+    applyDurabilitySettings();
+    return true;
+}
+
+/**
+ * @brief Applies the durability settings to the open connection.
+ *        The journal mode is stored in the database file; the other settings belong to the
+ *        connection and are applied every time it opens.
+ */
+void Database::applyDurabilitySettings()
+{
+    QSqlQuery query(db);
+
+    // Switch the journal mode; SQLite returns the mode now in effect.
+    if (!query.exec("PRAGMA journal_mode = " + DURABILITY.journalMode)) {
+        qDebug() << query.lastError().text();
+    } else if (query.next()
+               && query.value(0).toString().compare(DURABILITY.journalMode, Qt::CaseInsensitive)
+                      != 0) {
+        qDebug() << "Journal mode" << DURABILITY.journalMode << "is not available; using"
+                 << query.value(0).toString();
+    }
+
+    // Apply the connection's settings; a negative cache size is in KiB rather than pages.
+    const QStringList pragmas = {
+        QString("PRAGMA synchronous = %1").arg(DURABILITY.synchronous),
+        QString("PRAGMA cache_size = %1").arg(-DURABILITY.cacheSizeKiB),
+        QString("PRAGMA mmap_size = %1").arg(DURABILITY.mmapSize),
+        QString("PRAGMA temp_store = %1").arg(DURABILITY.tempStore),
+        QString("PRAGMA busy_timeout = %1").arg(DURABILITY.busyTimeout),
+        QString("PRAGMA wal_autocheckpoint = %1").arg(DURABILITY.walAutoCheckpoint),
+    };
+    for (const QString &pragma : pragmas) {
+        if (!query.exec(pragma)) {
+            qDebug() << pragma << query.lastError().text();
+        }
+    }
+}
+
+/**
+ * @brief Creates the tables and indexes, migrating databases created by older versions.
+ *        A current database is recognized from its schema version and no DDL runs.
+ */
+void Database::createSchema()
+{
+    // Apply the migrations the database has not seen yet.
+    SchemaMigrator migrator(db);
+    if (!migrator.migrate()) {
+        qDebug() << "Error migrating schema; the database is at version"
+                 << migrator.currentVersion() << "of" << SchemaMigrator::latestVersion();
+    }
+
+    // Statements prepared against the old schema are no longer valid.
+    clearStatementCache();
 }
 
 /**
  * @brief Retrieves a user from the database.
  * 
  * @param userID The ID of the user.
- * @returns A pointer to a User; nullptr if the user does not exist.
+ * @returns The User; std::nullopt if the user does not exist.
  */
-User *Database::getUser(int userID)
+std::optional<User> Database::getUser(int userID)
 {
-    // Initialize a user pointer.
-    User *user = nullptr;
+    // Initialize an empty user.
+    std::optional<User> user;
 
     // Create a query to retrieve the user.
-    QSqlQuery query;
-    query.prepare("SELECT * FROM User WHERE userID = ?");
-    query.addBindValue(userID);
+    QSqlQuery &query = cachedQuery("SELECT * FROM User WHERE userID = ?");
+    query.bindValue(0, userID);
 
     // Query the database for the user.
     if (query.exec()) {
@@ -170,8 +371,10 @@ User *Database::getUser(int userID)
             QString lastName = query.value("lastname").toString();
             Position position = static_cast<Position>(query.value("position").toInt());
             // Create a new user.
-            user = new User(firstName, lastName, position, userID);
+            user.emplace(std::move(firstName), std::move(lastName), position, userID);
         }
+        // Release the statement so it holds no read lock until it is used again.
+        query.finish();
     }
 
     // Return the queried user.
@@ -184,27 +387,28 @@ User *Database::getUser(int userID)
  * @param firstName The first name of the user.
  * @param lastName The last name of the user.
  * @param position The position of the user.
- * @returns A pointer to a User; nullptr if the user could not be created.
+ * @returns The User; std::nullopt if the user could not be created.
  */
-User *Database::createUser(const QString firstName, const QString lastName, Position position)
+std::optional<User> Database::createUser(const QString firstName,
+                                         const QString lastName,
+                                         Position position)
 {
-    // Initialize a user pointer.
-    User *user = nullptr;
+    // Initialize an empty user.
+    std::optional<User> user;
 
     // Create a query to insert the user into the database.
-    QSqlQuery query;
-    query.prepare("INSERT INTO User (firstname, lastname, position) "
-                  "VALUES (?, ?, ?)");
-    query.addBindValue(firstName);
-    query.addBindValue(lastName);
-    query.addBindValue(static_cast<int>(position));
+    QSqlQuery &query = cachedQuery("INSERT INTO User (firstname, lastname, position) "
+                                   "VALUES (?, ?, ?)");
+    query.bindValue(0, firstName);
+    query.bindValue(1, lastName);
+    query.bindValue(2, static_cast<int>(position));
 
     // Insert the user into the database.
     if (query.exec()) {
         // Retrieve the user ID.
         int userID = query.lastInsertId().toInt();
         // Create a new user.
-        user = new User(firstName, lastName, position, userID);
+        user.emplace(firstName, lastName, position, userID);
     }
 
     return user;
@@ -214,16 +418,15 @@ User *Database::createUser(const QString firstName, const QString lastName, Posi
  * @brief Retrieves a user login from the database.
  * 
  * @param username The username of the user.
- * @return A user login pointer; nullptr if the user login does not exist.
+ * @return The user login; std::nullopt if the user login does not exist.
  */
-UserLogin *Database::getUserLogin(const QString username)
+std::optional<UserLogin> Database::getUserLogin(const QString username)
 {
-    // Initialize a user login pointer.
-    UserLogin *userLogin = nullptr;
+    // Initialize an empty user login.
+    std::optional<UserLogin> userLogin;
 
     // Create a query to retrieve the user login.
-    QSqlQuery query;
-    query.prepare("SELECT * FROM UserLogin WHERE username = :username");
+    QSqlQuery &query = cachedQuery("SELECT * FROM UserLogin WHERE username = :username");
     query.bindValue(":username", username);
 
     // Query the database for the user login.
@@ -238,8 +441,14 @@ UserLogin *Database::getUserLogin(const QString username)
             int userID = query.value("userID").toInt();
 
             // Create a new user login.
-            userLogin = new UserLogin(username, password, accessLevel, email, userID);
+            userLogin.emplace(std::move(username),
+                              std::move(password),
+                              accessLevel,
+                              std::move(email),
+                              userID);
         }
+        // Release the statement so it holds no read lock until it is used again.
+        query.finish();
     }
     return userLogin;
 }
@@ -248,16 +457,15 @@ UserLogin *Database::getUserLogin(const QString username)
  * @brief Retrieve a user login from the database
  * 
  * @param email The email of the user
- * @return A user login pointer; nullptr if the user login does not exist.
+ * @return The user login; std::nullopt if the user login does not exist.
  */
-UserLogin *Database::getUserLoginEmail(const QString email)
+std::optional<UserLogin> Database::getUserLoginEmail(const QString email)
 {
-    // Initialize a user login pointer.
-    UserLogin *userLogin = nullptr;
+    // Initialize an empty user login.
+    std::optional<UserLogin> userLogin;
 
     // Create a query to retrieve the user login.
-    QSqlQuery query;
-    query.prepare("SELECT * FROM UserLogin WHERE email = :email");
+    QSqlQuery &query = cachedQuery("SELECT * FROM UserLogin WHERE email = :email");
     query.bindValue(":email", email);
 
     // Query the database for the user login.
@@ -271,84 +479,173 @@ UserLogin *Database::getUserLoginEmail(const QString email)
             QString email = query.value("email").toString();
             int userID = query.value("userID").toInt();
             // Create a new user login.
-            userLogin = new UserLogin(username, password, accessLevel, email, userID);
+            userLogin.emplace(std::move(username),
+                              std::move(password),
+                              accessLevel,
+                              std::move(email),
+                              userID);
         }
+        // Release the statement so it holds no read lock until it is used again.
+        query.finish();
     }
     return userLogin;
 }
 
 /**
- * @brief Creates a user login.
+ * @brief Retrieves what is needed to log a user in: their login and profile, joined in one
+ *        statement so logging in takes a single round trip.
  * 
- * @param username The username.
- * @param password The password.
- * @param accessLevel The access level.
- * @param userId The ID of the user.
- * @return A UserLogin pointer; nullptr if it fails to create.
- */
-UserLogin *Database::createUserLogin(const QString username,
-                                     const QString password,
-                                     AccessLevel accessLevel,
-                                     const QString email,
-                                     int userID)
-{
-    // Initialize a user login pointer.
-    UserLogin *userLogin = new UserLogin(username, password, accessLevel, email, userID, true);
-
-    // Create a query to insert the user login into the database.
-    QSqlQuery query;
-    query.prepare("INSERT INTO UserLogin(username, password, accessLevel, email, userID) "
-                  "VALUES (?, ?, ?, ?, ?)");
-    query.addBindValue(userLogin->username());
-    query.addBindValue(userLogin->password());
-    query.addBindValue(static_cast<int>(userLogin->accessLevel()));
-    query.addBindValue(userLogin->email());
-    query.addBindValue(userLogin->userID());
-
-    // Insert the user login into the database.
-    if (query.exec()) {
-        // If insert succeeds return the user login.
-        return userLogin;
-    } else {
-        // If insert fails delete the user login.
-        delete userLogin;
-        return nullptr;
+ * @param username The username of the user.
+ * @return The account; std::nullopt if the username is not registered.
+ */
+std::optional<Account> Database::authenticate(const QString &username)
+{
+    // Initialize an empty account.
+    std::optional<Account> account;
+
+    // Create a query to retrieve the login and the user it belongs to.
+    QSqlQuery &query = cachedQuery(
+        "SELECT l.username, l.password, l.accessLevel, l.email, "
+        "u.userID, u.firstname, u.lastname, u.position "
+        "FROM UserLogin l JOIN User u ON u.userID = l.userID "
+        "WHERE l.username = :username");
+    query.bindValue(":username", username);
+
+    // Query the database for the account.
+    if (!query.exec()) {
+        qDebug() << query.lastError().text();
+        return account;
+    }
+
+    // If the account exists, create its user and login.
+    if (query.next()) {
+        int userID = query.value("userID").toInt();
+        User user(query.value("firstname").toString(),
+                  query.value("lastname").toString(),
+                  static_cast<Position>(query.value("position").toInt()),
+                  userID);
+        UserLogin login(query.value("username").toString(),
+                        query.value("password").toString(),
+                        static_cast<AccessLevel>(query.value("accessLevel").toInt()),
+                        query.value("email").toString(),
+                        userID);
+        account.emplace(Account{std::move(user), std::move(login)});
     }
+    // Release the statement so it holds no read lock until it is used again.
+    query.finish();
+
+    return account;
 }
 
 /**
- * @brief Updates a user's password.
+ * @brief Registers a user: creates the user and their login in a single database transaction,
+ *        so a failed login never leaves a user without one. The password is hashed by the
+ *        caller, off the database thread, so neither the write lock nor the queries queued
+ *        behind this one wait for the hashing.
  * 
- * @param username The username of the passowrd.
- * @param password The new password.
- * @return True if the password was updated; false otherwise.
+ * @param firstName The first name of the user.
+ * @param lastName The last name of the user.
+ * @param position The position of the user.
+ * @param username The username.
+ * @param passwordHash The hash of the password.
+ * @param accessLevel The access level.
+ * @param email The email of the user.
+ * @return The new account, or why it could not be created.
  */
-bool Database::updatePassword(UserLogin *userLogin, QString password)
+RegistrationResult Database::registerAccount(const QString &firstName,
+                                             const QString &lastName,
+                                             Position position,
+                                             const QString &username,
+                                             const QString &passwordHash,
+                                             AccessLevel accessLevel,
+                                             const QString &email)
 {
-    // Extract the user login information.
-    QString username = userLogin->username();
-    QString currentPassword = userLogin->password();
+    RegistrationResult result;
 
-    // Change the user's password
-    userLogin->setPassword(password);
-    QString newPassword = userLogin->password();
+    // Create the user and login atomically.
+    if (!db.transaction()) {
+        qDebug() << db.lastError().text();
+        result.error = "Failed to create user.";
+        return result;
+    }
 
-    // Create a query to update the user's password in the database.
-    QSqlQuery query;
-    query.prepare("UPDATE UserLogin SET password = :password WHERE username = :username");
-    query.bindValue(":password", newPassword);
-    query.bindValue(":username", username);
+    // Check that the username is free.
+    QSqlQuery &findQuery = cachedQuery("SELECT 1 FROM UserLogin WHERE username = :username");
+    findQuery.bindValue(":username", username);
+    if (!findQuery.exec()) {
+        qDebug() << findQuery.lastError().text();
+        db.rollback();
+        result.error = "Failed to create user.";
+        return result;
+    }
+    bool taken = findQuery.next();
+    findQuery.finish();
+    if (taken) {
+        db.rollback();
+        result.error = "Username already exists in database.";
+        return result;
+    }
 
-    // Update the user's password in the database.
-    if (query.exec()) {
-        // If update succeeds, return true.
-        return true;
-    } else {
-        // If update fails, revert the user login's password.
-        userLogin->resetPassword(currentPassword);
-        // Return false.
+    // Insert the user.
+    std::optional<User> user = createUser(firstName, lastName, position);
+    if (!user) {
+        db.rollback();
+        result.error = "Failed to create user.";
+        return result;
+    }
+
+    // Insert the login with the precomputed hash.
+    UserLogin login(username, passwordHash, accessLevel, email, user->userID());
+    QSqlQuery &loginQuery = cachedQuery(
+        "INSERT INTO UserLogin(username, password, accessLevel, email, userID) "
+        "VALUES (?, ?, ?, ?, ?)");
+    loginQuery.bindValue(0, login.username());
+    loginQuery.bindValue(1, login.password());
+    loginQuery.bindValue(2, static_cast<int>(login.accessLevel()));
+    loginQuery.bindValue(3, login.email());
+    loginQuery.bindValue(4, login.userID());
+    if (!loginQuery.exec()) {
+        qDebug() << loginQuery.lastError().text();
+        db.rollback();
+        result.error = "Failed to create user login.";
+        return result;
+    }
+
+    // Commit the account.
+    if (!db.commit()) {
+        qDebug() << db.lastError().text();
+        db.rollback();
+        result.error = "Failed to create user.";
+        return result;
+    }
+
+    result.account.emplace(Account{std::move(*user), std::move(login)});
+    return result;
+}
+
+/**
+ * @brief Replaces the stored hash of a user's password, as when a login upgrades a weaker
+ *        hash. The hash is computed by the caller, so no hashing runs here.
+ * 
+ * @param userID The ID of the user.
+ * @param hash The new hash.
+ * @return True if the hash was replaced; false otherwise.
+ */
+bool Database::updatePasswordHash(int userID, const QString &hash)
+{
+    // Create a query to update the user's password hash.
+    QSqlQuery &query = cachedQuery("UPDATE UserLogin SET password = :password "
+                                   "WHERE userID = :userID");
+    query.bindValue(":password", hash);
+    query.bindValue(":userID", userID);
+
+    // Update the hash in the database.
+    if (!query.exec()) {
+        qDebug() << query.lastError().text();
         return false;
     }
+
+    return query.numRowsAffected() == 1;
 }
 
 /**
@@ -357,15 +654,15 @@ bool Database::updatePassword(UserLogin *userLogin, QString password)
  * @param userID The ID of the user.
  * @return QVector of transactions; empty if the user does not exist.
  */
-QVector<Transaction *> Database::getTransactions(int userID)
+QVector<Transaction> Database::getTransactions(int userID)
 {
     // Create a query to retrieve the user's transactions.
-    QSqlQuery query;
-    query.prepare("SELECT * FROM TransactionsView WHERE userID = :userID");
+    QSqlQuery &query = cachedQuery("SELECT * FROM Transactions WHERE userID = :userID "
+                                   "ORDER BY transactionDate, transactionID");
     query.bindValue(":userID", userID);
 
     // Initialize a vector of transactions.
-    QVector<Transaction *> transactions;
+    QVector<Transaction> transactions;
 
     // Query the database for the user's transactions.
     if (query.exec()) {
@@ -373,28 +670,25 @@ QVector<Transaction *> Database::getTransactions(int userID)
         while (query.next()) {
             // Extract the transaction information.
             int transactionID = query.value("transactionID").toInt();
-            double amount = query.value("amount").toDouble();
+            Money amount = Money::fromCents(query.value("amount").toLongLong());
             QString description = query.value("description").toString();
-            QString date = query.value("transactionDate").toString();
+            QDate date = fromEpochDay(query.value("transactionDate").toLongLong());
             int categoryID = query.value("categoryID").toInt();
             int subcategoryID = query.value("subcategoryID").toInt();
-            double balance = query.value("balance").toDouble();
+            Money balance = Money::fromCents(query.value("balance").toLongLong());
             int userID = query.value("userID").toInt();
             bool isDeposit = query.value("isDeposit").toBool();
 
-            // Create a new transaction.
-            Transaction *transaction = new Transaction(transactionID,
-                                                       amount,
-                                                       description,
-                                                       date,
-                                                       categoryID,
-                                                       subcategoryID,
-                                                       balance,
-                                                       userID,
-                                                       isDeposit);
-
             // Add the transaction to the vector.
-            transactions.push_back(transaction);
+            transactions.emplace_back(transactionID,
+                                      amount,
+                                      std::move(description),
+                                      date,
+                                      categoryID,
+                                      subcategoryID,
+                                      balance,
+                                      userID,
+                                      isDeposit);
         }
     }
 
@@ -409,17 +703,17 @@ QVector<Transaction *> Database::getTransactions(int userID)
  * @param categoryID The ID of the category.
  * @return QVector of transactions; empty if the user does not exist.
  */
-QVector<Transaction *> Database::getTransactionsByCategory(int userID, int categoryID)
+QVector<Transaction> Database::getTransactionsByCategory(int userID, int categoryID)
 {
     // Create a query to retrieve the user's transactions.
-    QSqlQuery query;
-    query.prepare(
-        "SELECT * FROM TransactionsView WHERE userID = :userID AND categoryID = :categoryID");
+    QSqlQuery &query = cachedQuery(
+        "SELECT * FROM Transactions WHERE userID = :userID AND categoryID = :categoryID "
+        "ORDER BY transactionDate, transactionID");
     query.bindValue(":userID", userID);
     query.bindValue(":categoryID", categoryID);
 
     // Initialize a vector of transactions.
-    QVector<Transaction *> transactions;
+    QVector<Transaction> transactions;
 
     // Query the database for the user's transactions.
     if (query.exec()) {
@@ -427,28 +721,25 @@ QVector<Transaction *> Database::getTransactionsByCategory(int userID, int categ
         while (query.next()) {
             // Extract the transaction information.
             int transactionID = query.value("transactionID").toInt();
-            double amount = query.value("amount").toDouble();
+            Money amount = Money::fromCents(query.value("amount").toLongLong());
             QString description = query.value("description").toString();
-            QString date = query.value("transactionDate").toString();
+            QDate date = fromEpochDay(query.value("transactionDate").toLongLong());
             int categoryID = query.value("categoryID").toInt();
             int subcategoryID = query.value("subcategoryID").toInt();
-            double balance = query.value("balance").toDouble();
+            Money balance = Money::fromCents(query.value("balance").toLongLong());
             int userID = query.value("userID").toInt();
             bool isDeposit = query.value("isDeposit").toBool();
 
-            // Create a new transaction.
-            Transaction *transaction = new Transaction(transactionID,
-                                                       amount,
-                                                       description,
-                                                       date,
-                                                       categoryID,
-                                                       subcategoryID,
-                                                       balance,
-                                                       userID,
-                                                       isDeposit);
-
             // Add the transaction to the vector.
-            transactions.push_back(transaction);
+            transactions.emplace_back(transactionID,
+                                      amount,
+                                      std::move(description),
+                                      date,
+                                      categoryID,
+                                      subcategoryID,
+                                      balance,
+                                      userID,
+                                      isDeposit);
         }
     }
 
@@ -456,225 +747,989 @@ QVector<Transaction *> Database::getTransactionsByCategory(int userID, int categ
     return transactions;
 }
 
+// Selects transactions with their category and subcategory names in a single statement.
+static const char *LEDGER_QUERY
+    = "SELECT t.*, "
+      "COALESCE(c.categoryName, '') AS categoryName, "
+      "COALESCE(s.subcategoryName, '') AS subcategoryName "
+      "FROM Transactions AS t "
+      "LEFT JOIN Category AS c ON c.categoryID = t.categoryID "
+      "LEFT JOIN Subcategory AS s ON s.categoryID = t.categoryID "
+      "AND s.subcategoryID = t.subcategoryID ";
+
 /**
- * @brief Retrieves a user's categories.
+ * @brief Retrieves a user's transactions with their category and subcategory names.
  * 
  * @param userID The ID of the user.
- * @return QMap of category ID's to names; empty if the user does not exist.
+ * @return QVector of transactions; empty if the user does not exist.
  */
-QMap<int, QString> Database::getCategoryNames(int userID)
+QVector<Transaction> Database::getLedger(int userID)
 {
-    // Create a query to retrieve the user's category.
-    QSqlQuery query;
-    query.prepare("SELECT * FROM Category WHERE userID = :userID OR userID = 0");
+    // Create a query to retrieve the user's transactions and their names.
+    QSqlQuery &query = cachedQuery(
+        QString(LEDGER_QUERY)
+        + "WHERE t.userID = :userID ORDER BY t.transactionDate, t.transactionID");
     query.bindValue(":userID", userID);
 
-    // Initialize a map of category ID's to names.
-    QMap<int, QString> categories;
-
-    // Query the database for the user's categories.
-    if (query.exec()) {
-        // If the query is successful, iterate through the results.
-        while (query.next()) {
-            // Extract the category information.
-            int categoryID = query.value("categoryID").toInt();
-            QString categoryName = query.value("categoryName").toString();
-
-            // Insert the ID and name into the categories map.
-            categories.insert(categoryID, categoryName);
-        }
+    // Query the database for the user's transactions.
+    if (!query.exec()) {
+        qDebug() << query.lastError().text();
+        return {};
     }
 
-    // Return the map of category ID's to names, empty if query failed.
-    return categories;
+    // Return the vector of transactions.
+    return readLedger(query);
 }
 
 /**
- * @brief Retrieves a specific category from user's categories.
+ * @brief Retrieves a user's transactions in a category with their category and subcategory names.
  * 
  * @param userID The ID of the user.
  * @param categoryID The ID of the category.
- * @return QMap of subcategory ID's to names; empty if the user does not exist.
+ * @return QVector of transactions; empty if the user does not exist.
  */
-QMap<int, QString> Database::getCategoryName(int userID, int categoryID)
+QVector<Transaction> Database::getLedgerByCategory(int userID, int categoryID)
 {
-    // Create a query to retrieve the user's category.
-    QSqlQuery query;
-    query.prepare("SELECT * FROM Category WHERE userID = :userID AND categoryID = :categoryID");
+    // Create a query to retrieve the user's transactions and their names.
+    QSqlQuery &query = cachedQuery(QString(LEDGER_QUERY)
+                                   + "WHERE t.userID = :userID AND t.categoryID = :categoryID "
+                                     "ORDER BY t.transactionDate, t.transactionID");
     query.bindValue(":userID", userID);
     query.bindValue(":categoryID", categoryID);
 
-    // Initialize a map of category ID's to names.
-    QMap<int, QString> categories;
-
-    // Query the database for the user's category.
-    if (query.exec()) {
-        // If the query is successful, iterate through the results.
-        while (query.next()) {
-            // Extract the category information.
-            int categoryID = query.value("categoryID").toInt();
-            QString categoryName = query.value("categoryName").toString();
-
-            // Insert the ID and name into the categories map.
-            categories.insert(categoryID, categoryName);
-        }
+    // Query the database for the user's transactions.
+    if (!query.exec()) {
+        qDebug() << query.lastError().text();
+        return {};
     }
 
-    // Return the map of category ID's to names, empty if query failed.
-    return categories;
+    // Return the vector of transactions.
+    return readLedger(query);
 }
 
 /**
- * @brief Retrieves a user's subcategories.
+ * @brief Retrieves one page of a user's ledger with keyset pagination.
+ *        The page is found by seeking the ledger index to the cursor, so its cost does not
+ *        depend on how far into the ledger the cursor is.
  * 
  * @param userID The ID of the user.
- * @param categoryID The ID of the parent category.
- * @return QMap of subcategory ID's to names; empty if the user does not exist.
+ * @param categoryID The ID of the category; -1 pages through every category.
+ * @param cursor The position to page from; an invalid cursor starts at the first (Forward)
+ *        or last (Backward) transaction.
+ * @param limit The maximum number of transactions to return.
+ * @param direction Whether to return the transactions after or before the cursor.
+ * @return QVector of transactions in ledger order; empty past either end of the ledger.
  */
-QMap<int, QString> Database::getSubcategoryNames(int userID, int categoryID)
+QVector<Transaction> Database::getLedgerPage(int userID,
+                                             int categoryID,
+                                             const LedgerCursor &cursor,
+                                             int limit,
+                                             PageDirection direction)
 {
-    // Create a query to retrieve the user's subcategories.
-    QSqlQuery query;
-    query.prepare("SELECT * FROM Subcategory WHERE userID = :userID AND categoryID = :categoryID");
-    query.bindValue(":userID", userID);
-    query.bindValue(":categoryID", categoryID);
-
-    // Initialize a map of subcategory ID's to names.
-    QMap<int, QString> subcategories;
+    bool forward = direction == PageDirection::Forward;
 
-    // Query the database for the user's subcategories.
-    if (query.exec()) {
-        // If the query is successful, iterate through the results.
-        while (query.next()) {
-            // Extract the subcategory information.
-            int subcategoryID = query.value("subcategoryID").toInt();
-            QString subcategoryName = query.value("subcategoryName").toString();
+    // Build the query for the requested page.
+    QString sql = QString(LEDGER_QUERY) + "WHERE t.userID = :userID ";
+    if (categoryID != -1) {
+        sql += "AND t.categoryID = :categoryID ";
+    }
+    if (cursor.isValid()) {
+        sql += forward ? "AND (t.transactionDate, t.transactionID) > (:date, :transactionID) "
+                       : "AND (t.transactionDate, t.transactionID) < (:date, :transactionID) ";
+    }
+    sql += forward ? "ORDER BY t.transactionDate, t.transactionID "
+                   : "ORDER BY t.transactionDate DESC, t.transactionID DESC ";
+    sql += "LIMIT :limit";
 
-            // Insert the ID and name into the subcategories map.
-            subcategories.insert(subcategoryID, subcategoryName);
+    // Create a query to retrieve the page.
+    QSqlQuery &query = cachedQuery(sql);
+    query.bindValue(":userID", userID);
+    if (categoryID != -1) {
+        query.bindValue(":categoryID", categoryID);
+    }
+    if (cursor.isValid()) {
+        query.bindValue(":date", toEpochDay(cursor.date));
+        query.bindValue(":transactionID", cursor.transactionID);
+    }
+    query.bindValue(":limit", limit);
+
+    // Query the database for the page. The snapshot is taken when the query starts, while no
+    // write is between committing and announcing its change.
+    {
+        QReadLocker announced(&LEDGER_ANNOUNCE_LOCK);
+        if (!query.exec()) {
+            qDebug() << query.lastError().text();
+            return {};
         }
     }
 
-    return subcategories;
+    // Read the page.
+    QVector<Transaction> transactions = readLedger(query);
+
+    // Backward pages are read newest first; return them in ledger order.
+    if (!forward) {
+        std::reverse(transactions.begin(), transactions.end());
+    }
+
+    return transactions;
 }
 
 /**
- * @brief Retrieves the name of a specific subcategory.
+ * @brief Retrieves a user's transactions within a date range.
+ *        Dates are day numbers, so the range is a single scan of the ledger index.
  * 
- * @param categoryID The ID of the parent category.
- * @param subcategoryID The ID of the subcategory.
- * @return QMap of subcategory ID's to names; empty if the user does not exist.
+ * @param userID The ID of the user.
+ * @param categoryID The ID of the category; -1 returns every category.
+ * @param from The first date of the range.
+ * @param to The last date of the range.
+ * @return QVector of transactions in ledger order; empty if none are in the range.
  */
-QString Database::getSubcategoryName(int categoryID, int subcategoryID)
+QVector<Transaction> Database::getLedgerBetween(int userID,
+                                                int categoryID,
+                                                const QDate &from,
+                                                const QDate &to)
 {
-    // Initialize a string for the subcategory name.
-    QString subcategoryName = "";
-    // Create a query to retrieve the user's subcategories.
-    QSqlQuery query;
-    query.prepare("SELECT subcategoryName FROM Subcategory WHERE categoryID = :categoryID AND "
-                  "subcategoryID = :subcategoryID");
-    query.bindValue(":categoryID", categoryID);
-    query.bindValue(":subcategoryID", subcategoryID);
+    // Build the query for the range.
+    QString sql = QString(LEDGER_QUERY) + "WHERE t.userID = :userID ";
+    if (categoryID != -1) {
+        sql += "AND t.categoryID = :categoryID ";
+    }
+    sql += "AND t.transactionDate BETWEEN :from AND :to "
+           "ORDER BY t.transactionDate, t.transactionID";
 
-    // Query the database for the user's subcategories.
-    if (query.exec()) {
-        // Set the query to the first result.
-        query.next();
-        // Extract the subcategory information.
-        subcategoryName = query.value("subcategoryName").toString();
+    // Create a query to retrieve the range.
+    QSqlQuery &query = cachedQuery(sql);
+    query.bindValue(":userID", userID);
+    if (categoryID != -1) {
+        query.bindValue(":categoryID", categoryID);
     }
+    query.bindValue(":from", toEpochDay(from));
+    query.bindValue(":to", toEpochDay(to));
 
-    // Return the name of the subcategory, empty if query failed.
-    return subcategoryName;
+    // Query the database for the range.
+    if (!query.exec()) {
+        qDebug() << query.lastError().text();
+        return {};
+    }
+
+    // Return the vector of transactions.
+    return readLedger(query);
 }
 
 /**
- * @brief Create a transaction and insert it into the database.
+ * @brief Retrieves the balance after each of a user's transactions within a date range.
+ *        Only columns of the ledger indexes are read, so the table itself is never touched
+ *        and no transaction objects are built.
  * 
- * @param amount The amount of the transaction.
- * @param description The description of the transaction.
- * @param date The date of the transaction.
- * @param categoryID The ID of the category.
- * @param subcategoryID The ID of the subcategory.
  * @param userID The ID of the user.
- * @param isDeposit Whether the transaction is a deposit.
- * @return The created transaction; NULL if the transaction could not be created.
+ * @param categoryID The ID of the category; -1 returns every category.
+ * @param from The first date of the range; invalid for no lower bound.
+ * @param to The last date of the range; invalid for no upper bound.
+ * @return QVector of balance points in ledger order; empty if none are in the range.
  */
-Transaction *Database::createTransaction(double amount,
-                                         QString description,
-                                         QString date,
-                                         int categoryID,
-                                         int subcategoryID,
-                                         int userID,
-                                         bool isDeposit)
+QVector<BalancePoint> Database::getBalanceHistory(int userID,
+                                                  int categoryID,
+                                                  const QDate &from,
+                                                  const QDate &to)
 {
-    // If the transaction is a deposit.
-    if (isDeposit) {
-        // Make the amount positive.
-        amount = abs(amount);
-        // Set category ID to 0 (Deposit).
-        categoryID = 0;
-        // Set subcategory ID to NULL.
-        subcategoryID = 0;
+    // Build the query for the range.
+    QString sql = "SELECT transactionDate, transactionID, balance FROM Transactions "
+                  "WHERE userID = :userID ";
+    if (categoryID != -1) {
+        sql += "AND categoryID = :categoryID ";
+    }
+    if (from.isValid()) {
+        sql += "AND transactionDate >= :from ";
+    }
+    if (to.isValid()) {
+        sql += "AND transactionDate <= :to ";
+    }
+    sql += "ORDER BY transactionDate, transactionID";
+
+    // Create a query to retrieve the range.
+    QSqlQuery &query = cachedQuery(sql);
+    query.bindValue(":userID", userID);
+    if (categoryID != -1) {
+        query.bindValue(":categoryID", categoryID);
+    }
+    if (from.isValid()) {
+        query.bindValue(":from", toEpochDay(from));
+    }
+    if (to.isValid()) {
+        query.bindValue(":to", toEpochDay(to));
+    }
+
+    // Query the database for the range.
+    if (!query.exec()) {
+        qDebug() << query.lastError().text();
+        return {};
+    }
+
+    // Read the points.
+    QVector<BalancePoint> points;
+    while (query.next()) {
+        points.append({{fromEpochDay(query.value(0).toLongLong()), query.value(1).toInt()},
+                       Money::fromCents(query.value(2).toLongLong())});
+    }
+
+    return points;
+}
+
+/**
+ * @brief Turns the text typed into a search box into an FTS5 query.
+ *        Every word must match; the last one may be the start of a word still being typed.
+ *        Words are quoted, so FTS5 operators and punctuation in the text are taken literally.
+ * @param text The search text.
+ * @return The FTS5 query; empty if the text has no words.
+ */
+static QString searchExpression(const QString &text)
+{
+    QStringList terms;
+    const QStringList words = text.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
+    for (const QString &word : words) {
+        // Words made only of separators match nothing.
+        bool hasToken = std::any_of(word.cbegin(), word.cend(), [](QChar c) {
+            return c.isLetterOrNumber();
+        });
+        if (hasToken) {
+            terms.append('"' + QString(word).replace('"', "\"\"") + '"');
+        }
+    }
+
+    // The last word is a prefix unless the user has moved on to the next one.
+    if (!terms.isEmpty() && !text.back().isSpace()) {
+        terms.last().append('*');
+    }
+
+    return terms.join(' ');
+}
+
+/**
+ * @brief Searches a user's transaction descriptions.
+ *        Matches are found in the full-text index and ranked by relevance (BM25), most
+ *        relevant first; equally relevant rows are newest first. Every match is ranked, so
+ *        an empty page is the end of the results.
+ *
+ * @param userID The ID of the user.
+ * @param text The search text; see searchExpression.
+ * @param limit The maximum number of transactions to return.
+ * @param offset The number of ranked transactions to skip, for paging.
+ * @return QVector of transactions with their names; empty if nothing matches.
+ */
+QVector<Transaction> Database::searchTransactions(int userID,
+                                                  const QString &text,
+                                                  int limit,
+                                                  int offset)
+{
+    // Nothing to search for.
+    QString expression = searchExpression(text);
+    if (expression.isEmpty()) {
+        return {};
+    }
+
+    // Create a query to rank all of the user's matches and read the requested page.
+    QSqlQuery &query = cachedQuery(
+        "SELECT t.*, "
+        "COALESCE(c.categoryName, '') AS categoryName, "
+        "COALESCE(s.subcategoryName, '') AS subcategoryName "
+        "FROM (SELECT TransactionsSearch.rowid AS transactionID, "
+        "bm25(TransactionsSearch) AS score "
+        "FROM TransactionsSearch "
+        "WHERE TransactionsSearch MATCH :expression) AS hits "
+        "JOIN Transactions AS t ON t.transactionID = hits.transactionID "
+        "LEFT JOIN Category AS c ON c.categoryID = t.categoryID "
+        "LEFT JOIN Subcategory AS s ON s.categoryID = t.categoryID "
+        "AND s.subcategoryID = t.subcategoryID "
+        "WHERE t.userID = :userID "
+        "ORDER BY hits.score, t.transactionID DESC "
+        "LIMIT :limit OFFSET :offset");
+    query.bindValue(":expression", expression);
+    query.bindValue(":userID", userID);
+    query.bindValue(":limit", limit);
+    query.bindValue(":offset", offset);
+
+    // Query the database for the matches.
+    if (!query.exec()) {
+        qDebug() << query.lastError().text();
+        return {};
+    }
+
+    // Return the vector of transactions.
+    return readLedger(query);
+}
+
+/**
+ * @brief Retrieves the highest transaction ID.
+ * 
+ * @return The ID of the most recently created transaction; 0 if there are none.
+ */
+int Database::getLastTransactionID()
+{
+    // Create a query to find the highest ID.
+    QSqlQuery &query = cachedQuery("SELECT COALESCE(MAX(transactionID), 0) FROM Transactions");
+
+    // Query the database for the ID.
+    if (query.exec() && query.next()) {
+        int transactionID = query.value(0).toInt();
+        query.finish();
+        return transactionID;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Checks which drafts are already among a user's transactions.
+ *        A draft matches a transaction with the same date, amount and description.
+ *        Only transactions up to maxTransactionID are considered, so rows inserted by the
+ *        import being checked are never mistaken for duplicates.
+ * 
+ * @param userID The ID of the user.
+ * @param maxTransactionID The highest transaction ID to compare against.
+ * @param drafts The drafts to check.
+ * @return Whether each draft matches an existing transaction, in order; std::nullopt if
+ *         the ledger could not be read.
+ */
+std::optional<QVector<bool>> Database::findExistingTransactions(
+    int userID, int maxTransactionID, const QVector<TransactionDraft> &drafts)
+{
+    QVector<bool> existing(drafts.size(), false);
+
+    // Read every draft's match in a single read transaction.
+    if (!db.transaction()) {
+        qDebug() << db.lastError().text();
+        return std::nullopt;
+    }
+
+    // Create a query to find a matching transaction through the ledger index.
+    QSqlQuery &query = cachedQuery(
+        "SELECT EXISTS (SELECT 1 FROM Transactions WHERE userID = :userID "
+        "AND transactionDate = :date AND amount = :amount AND description = :description "
+        "AND transactionID <= :maxTransactionID)");
+
+    for (int i = 0; i < drafts.size(); ++i) {
+        const TransactionDraft &draft = drafts.at(i);
+        query.bindValue(":userID", userID);
+        query.bindValue(":date", toEpochDay(draft.date));
+        query.bindValue(":amount", draft.signedAmount().cents());
+        query.bindValue(":description", draft.description);
+        query.bindValue(":maxTransactionID", maxTransactionID);
+
+        // Query the database for the match; a failed check is not read as a new row.
+        if (!query.exec() || !query.next()) {
+            qDebug() << query.lastError().text();
+            query.finish();
+            db.rollback();
+            return std::nullopt;
+        }
+        existing[i] = query.value(0).toBool();
+    }
+    query.finish();
+
+    // End the read transaction.
+    if (!db.commit()) {
+        qDebug() << db.lastError().text();
+        db.rollback();
+        return std::nullopt;
+    }
+
+    return existing;
+}
+
+/**
+ * @brief Retrieves a user's balance at the end of a date.
+ * 
+ * @param userID The ID of the user.
+ * @param date The date.
+ * @return The balance after the last transaction on or before the date; 0 if there is none.
+ */
+Money Database::getBalanceOn(int userID, const QDate &date)
+{
+    // Create a query to find the last balance on or before the date.
+    QSqlQuery &query = cachedQuery("SELECT balance FROM Transactions WHERE userID = :userID "
+                                   "AND transactionDate <= :date "
+                                   "ORDER BY transactionDate DESC, transactionID DESC LIMIT 1");
+    query.bindValue(":userID", userID);
+    query.bindValue(":date", toEpochDay(date));
+
+    // Query the database for the balance.
+    if (query.exec() && query.next()) {
+        Money balance = Money::fromCents(query.value("balance").toLongLong());
+        query.finish();
+        return balance;
+    }
+
+    // Return 0 if the user had no transactions yet.
+    return Money();
+}
+
+/**
+ * @brief Retrieves the dates of a user's first and last transactions.
+ *        Each end is one seek of the ledger index.
+ * 
+ * @param userID The ID of the user.
+ * @return The first and last dates; invalid dates if the user has no transactions.
+ */
+QPair<QDate, QDate> Database::getLedgerSpan(int userID)
+{
+    // Create a query to find the first and last dates.
+    QSqlQuery &query = cachedQuery(
+        "SELECT (SELECT MIN(transactionDate) FROM Transactions WHERE userID = :firstUserID), "
+        "(SELECT MAX(transactionDate) FROM Transactions WHERE userID = :lastUserID)");
+    query.bindValue(":firstUserID", userID);
+    query.bindValue(":lastUserID", userID);
+
+    // Query the database for the dates.
+    if (!query.exec() || !query.next()) {
+        qDebug() << query.lastError().text();
+        return {};
+    }
+
+    // A user without transactions has no dates.
+    if (query.isNull(0)) {
+        return {};
+    }
+
+    return {fromEpochDay(query.value(0).toLongLong()), fromEpochDay(query.value(1).toLongLong())};
+}
+
+/**
+ * @brief Retrieves a user's buckets of one level of the balance pyramid.
+ *        The pyramid holds one row per bucket, so the cost depends on the number of buckets
+ *        in the range, not on the number of transactions.
+ * 
+ * @param userID The ID of the user.
+ * @param level The level to read.
+ * @param from A date in the first bucket.
+ * @param to A date in the last bucket.
+ * @return QVector of buckets in date order; empty if the user has no transactions in them.
+ */
+QVector<BalanceBucket> Database::getBalancePyramid(int userID,
+                                                   PyramidLevel level,
+                                                   const QDate &from,
+                                                   const QDate &to)
+{
+    // Create a query to retrieve the buckets.
+    QSqlQuery &query = cachedQuery(
+        "SELECT bucket, open, close, low, high, count FROM BalancePyramid "
+        "WHERE userID = :userID AND level = :level AND bucket BETWEEN :from AND :to "
+        "ORDER BY bucket");
+    query.bindValue(":userID", userID);
+    query.bindValue(":level", int(level));
+    query.bindValue(":from", toEpochDay(BalancePyramid::bucketStart(from, level)));
+    query.bindValue(":to", toEpochDay(BalancePyramid::bucketStart(to, level)));
+
+    // Query the database for the buckets.
+    if (!query.exec()) {
+        qDebug() << query.lastError().text();
+        return {};
+    }
+
+    // Read the buckets.
+    QVector<BalanceBucket> buckets;
+    while (query.next()) {
+        buckets.append({fromEpochDay(query.value(0).toLongLong()),
+                        Money::fromCents(query.value(1).toLongLong()),
+                        Money::fromCents(query.value(2).toLongLong()),
+                        Money::fromCents(query.value(3).toLongLong()),
+                        Money::fromCents(query.value(4).toLongLong()),
+                        query.value(5).toInt()});
+    }
+
+    return buckets;
+}
+
+/**
+ * @brief Retrieves a user's monthly totals from the monthly rollup.
+ *        The rollup holds one row per month, category and subcategory, so the cost depends
+ *        on the number of months and categories, not on the number of transactions.
+ * 
+ * @param userID The ID of the user.
+ * @param from A date in the first month.
+ * @param to A date in the last month.
+ * @param categoryID The ID of the category; -1 returns every category.
+ * @param bySubcategory Whether to split each category's totals by subcategory.
+ * @return QVector of totals ordered by month, category and subcategory.
+ */
+QVector<MonthlyTotal> Database::getMonthlyTotals(int userID,
+                                                 const QDate &from,
+                                                 const QDate &to,
+                                                 int categoryID,
+                                                 bool bySubcategory)
+{
+    // Build the query for the months.
+    QString sql = QString("SELECT month, categoryID, %1 AS subcategoryID, "
+                          "SUM(total) AS total, SUM(count) AS count FROM MonthlyRollup "
+                          "WHERE userID = :userID AND month BETWEEN :from AND :to ")
+                      .arg(bySubcategory ? "subcategoryID" : "0");
+    if (categoryID != -1) {
+        sql += "AND categoryID = :categoryID ";
+    }
+    sql += bySubcategory ? "GROUP BY month, categoryID, subcategoryID "
+                           "ORDER BY month, categoryID, subcategoryID"
+                         : "GROUP BY month, categoryID ORDER BY month, categoryID";
+
+    // Create a query to retrieve the totals.
+    QSqlQuery &query = cachedQuery(sql);
+    query.bindValue(":userID", userID);
+    query.bindValue(":from", toEpochMonth(from));
+    query.bindValue(":to", toEpochMonth(to));
+    if (categoryID != -1) {
+        query.bindValue(":categoryID", categoryID);
+    }
+
+    // Query the database for the totals.
+    if (!query.exec()) {
+        qDebug() << query.lastError().text();
+        return {};
+    }
+
+    // Read each month's totals.
+    QVector<MonthlyTotal> totals;
+    while (query.next()) {
+        totals.append({fromEpochMonth(query.value(0).toInt()),
+                       query.value(1).toInt(),
+                       query.value(2).toInt(),
+                       Money::fromCents(query.value(3).toLongLong()),
+                       query.value(4).toInt()});
+    }
+
+    return totals;
+}
+
+/**
+ * @brief Retrieves a user's total per category from the monthly rollup.
+ * 
+ * @param userID The ID of the user.
+ * @param from A date in the first month.
+ * @param to A date in the last month.
+ * @return QMap of category IDs to totals; withdrawals are negative.
+ */
+QMap<int, Money> Database::getCategoryTotals(int userID, const QDate &from, const QDate &to)
+{
+    // Create a query to total each category over the months.
+    QSqlQuery &query = cachedQuery("SELECT categoryID, SUM(total) FROM MonthlyRollup "
+                                   "WHERE userID = :userID AND month BETWEEN :from AND :to "
+                                   "GROUP BY categoryID");
+    query.bindValue(":userID", userID);
+    query.bindValue(":from", toEpochMonth(from));
+    query.bindValue(":to", toEpochMonth(to));
+
+    // Query the database for the totals.
+    if (!query.exec()) {
+        qDebug() << query.lastError().text();
+        return {};
+    }
+
+    // Map each category to its total.
+    QMap<int, Money> totals;
+    while (query.next()) {
+        totals.insert(query.value(0).toInt(), Money::fromCents(query.value(1).toLongLong()));
+    }
+
+    return totals;
+}
+
+/**
+ * @brief Retrieves a user's categories.
+ * 
+ * @param userID The ID of the user.
+ * @return QMap of category ID's to names; empty if the user does not exist.
+ */
+QMap<int, QString> Database::getCategoryNames(int userID)
+{
+    return categoryTree(userID).categories;
+}
+
+/**
+ * @brief Retrieves a specific category from user's categories.
+ * 
+ * @param userID The ID of the user.
+ * @param categoryID The ID of the category.
+ * @return QMap of the category's ID to its name; empty if the category does not exist.
+ */
+QMap<int, QString> Database::getCategoryName(int userID, int categoryID)
+{
+    // Initialize a map of category ID's to names.
+    QMap<int, QString> categories;
+
+    // Look the category up in the user's tree.
+    CategoryTree tree = categoryTree(userID);
+    auto category = tree.categories.constFind(categoryID);
+    if (category != tree.categories.constEnd()) {
+        categories.insert(categoryID, category.value());
+    }
+
+    // Return the map of category ID's to names, empty if not found.
+    return categories;
+}
+
+/**
+ * @brief Retrieves a user's subcategories.
+ * 
+ * @param userID The ID of the user.
+ * @param categoryID The ID of the parent category.
+ * @return QMap of subcategory ID's to names; empty if the user does not exist.
+ */
+QMap<int, QString> Database::getSubcategoryNames(int userID, int categoryID)
+{
+    return categoryTree(userID).subcategories.value(categoryID);
+}
+
+/**
+ * @brief Retrieves the name of a specific subcategory.
+ *        Subcategories of users whose trees are cached are served from memory.
+ * 
+ * @param categoryID The ID of the parent category.
+ * @param subcategoryID The ID of the subcategory.
+ * @return The name of the subcategory; empty if it does not exist.
+ */
+QString Database::getSubcategoryName(int categoryID, int subcategoryID)
+{
+    // Serve the name from the cache.
+    if (std::optional<QString> name = CategoryCache::instance().subcategoryName(subcategoryID)) {
+        return *name;
+    }
+
+    // Initialize a string for the subcategory name.
+    QString subcategoryName = "";
+    // Create a query to retrieve the user's subcategories.
+    QSqlQuery &query = cachedQuery(
+        "SELECT subcategoryName FROM Subcategory WHERE categoryID = :categoryID AND "
+        "subcategoryID = :subcategoryID");
+    query.bindValue(":categoryID", categoryID);
+    query.bindValue(":subcategoryID", subcategoryID);
+
+    // Query the database for the user's subcategories.
+    if (query.exec()) {
+        // Set the query to the first result.
+        query.next();
+        // Extract the subcategory information.
+        subcategoryName = query.value("subcategoryName").toString();
+        // Release the statement so it holds no read lock until it is used again.
+        query.finish();
+    }
+
+    // Return the name of the subcategory, empty if query failed.
+    return subcategoryName;
+}
+
+/**
+ * @brief Finds one of the user's categories by its exact name.
+ * 
+ * @param userID The ID of the user.
+ * @param categoryName The name of the category.
+ * @return The ID of the category; std::nullopt if the user has no category of that name.
+ */
+std::optional<int> Database::findCategoryID(int userID, const QString &categoryName)
+{
+    CategoryTree tree = categoryTree(userID);
+    auto category = tree.categoryIDs.constFind(categoryName);
+    if (category == tree.categoryIDs.constEnd()) {
+        return std::nullopt;
+    }
+
+    return category.value();
+}
+
+/**
+ * @brief Finds one of a category's subcategories by its exact name.
+ * 
+ * @param userID The ID of the user.
+ * @param categoryID The ID of the parent category.
+ * @param subcategoryName The name of the subcategory.
+ * @return The ID of the subcategory; std::nullopt if the category has none of that name.
+ */
+std::optional<int> Database::findSubcategoryID(int userID,
+                                               int categoryID,
+                                               const QString &subcategoryName)
+{
+    CategoryTree tree = categoryTree(userID);
+    auto subcategory = tree.subcategoryIDs.constFind(qMakePair(categoryID, subcategoryName));
+    if (subcategory == tree.subcategoryIDs.constEnd()) {
+        return std::nullopt;
+    }
+
+    return subcategory.value();
+}
+
+/**
+ * @brief Create a transaction and insert it into the database.
+ *        The row's running balance is stored with it. A transaction dated on or after the
+ *        user's latest one writes only its own row; a backdated one also rewrites the balance
+ *        of every later row of the user, so its cost grows with the rows after it.
+ * 
+ * @param amount The amount of the transaction.
+ * @param description The description of the transaction.
+ * @param date The date of the transaction.
+ * @param categoryID The ID of the category.
+ * @param subcategoryID The ID of the subcategory.
+ * @param userID The ID of the user.
+ * @param isDeposit Whether the transaction is a deposit.
+ * @return The created transaction; std::nullopt if the transaction could not be created.
+ */
+std::optional<Transaction> Database::createTransaction(Money amount,
+                                                       QString description,
+                                                       QDate date,
+                                                       int categoryID,
+                                                       int subcategoryID,
+                                                       int userID,
+                                                       bool isDeposit)
+{
+    // Reject amounts too large to keep balances exact.
+    if (!amount.isValidAmount()) {
+        return std::nullopt;
+    }
+
+    // Reject dates that have no day number.
+    if (!date.isValid()) {
+        return std::nullopt;
+    }
+
+    // If the transaction is a deposit.
+    if (isDeposit) {
+        // Make the amount positive.
+        amount = amount.abs();
+        // Set category ID to 0 (Deposit).
+        categoryID = 0;
+        // Set subcategory ID to NULL.
+        subcategoryID = 0;
+
+    } else {
+        // If the transaction is a withdrawal.
+        // Make the amount negative.
+        amount = -amount.abs();
+    }
+
+    // Create a new transaction.
+    Transaction transaction(amount,
+                            std::move(description),
+                            date,
+                            categoryID,
+                            subcategoryID,
+                            userID,
+                            isDeposit);
+
+    // Insert the row and fix the balances after it atomically.
+    if (!db.transaction()) {
+        qDebug() << db.lastError().text();
+        return std::nullopt;
+    }
+
+    // Create a query to insert the transaction into the database.
+    // The new transaction has the highest ID, so it follows every transaction on or before
+    // its date and its running balance is the balance of the last of those plus this amount.
+    QSqlQuery &query = cachedQuery(
+        "INSERT INTO Transactions (amount, description, transactionDate, categoryID, "
+        "subcategoryID, userID, isDeposit, balance) VALUES (:amount, :description, "
+        ":date, :categoryID, :subcategoryID, :userID, :isDeposit, "
+        "COALESCE((SELECT balance FROM Transactions WHERE userID = :balanceUserID "
+        "AND transactionDate <= :balanceDate "
+        "ORDER BY transactionDate DESC, transactionID DESC LIMIT 1), 0) + :balanceAmount)");
+    query.bindValue(":amount", transaction.amount().cents());
+    query.bindValue(":description", transaction.description());
+    query.bindValue(":date", toEpochDay(transaction.date()));
+    query.bindValue(":categoryID", transaction.categoryID());
+    query.bindValue(":subcategoryID", transaction.subcategoryID());
+    query.bindValue(":userID", transaction.userID());
+    query.bindValue(":isDeposit", transaction.isDeposit());
+    query.bindValue(":balanceUserID", transaction.userID());
+    query.bindValue(":balanceDate", toEpochDay(transaction.date()));
+    query.bindValue(":balanceAmount", transaction.amount().cents());
+
+    // Execute the query.
+    if (!query.exec()) {
+        // If the query fails, print an error message.
+        qDebug() << query.lastError().text();
+        db.rollback();
+        return std::nullopt;
+    }
+    int transactionID = query.lastInsertId().toInt();
+
+    // Add the amount to every later balance of the same user.
+    // A transaction dated on or after the user's latest one touches no other rows; a
+    // backdated one rewrites every row after it.
+    QSqlQuery &updateQuery = cachedQuery("UPDATE Transactions SET balance = balance + :amount "
+                                         "WHERE userID = :userID AND transactionDate > :date");
+    updateQuery.bindValue(":amount", transaction.amount().cents());
+    updateQuery.bindValue(":userID", transaction.userID());
+    updateQuery.bindValue(":date", toEpochDay(transaction.date()));
+
+    // Execute the query.
+    if (!updateQuery.exec()) {
+        // If the query fails, print an error message.
+        qDebug() << updateQuery.lastError().text();
+        db.rollback();
+        return std::nullopt;
+    }
+
+    // Read back the balance the insert computed for the row.
+    QSqlQuery &balanceQuery = cachedQuery(
+        "SELECT balance FROM Transactions WHERE transactionID = :transactionID");
+    balanceQuery.bindValue(":transactionID", transactionID);
+
+    if (!balanceQuery.exec() || !balanceQuery.next()) {
+        qDebug() << balanceQuery.lastError().text();
+        db.rollback();
+        return std::nullopt;
+    }
+    qint64 balance = balanceQuery.value(0).toLongLong();
+    balanceQuery.finish();
+
+    // Move the balance pyramid with the balances and commit; page reads wait until the change
+    // is announced.
+    QWriteLocker announcing(&LEDGER_ANNOUNCE_LOCK);
+    if (!updatePyramid(ChangeKind::Inserted,
+                       transaction.userID(),
+                       transaction.date(),
+                       transactionID,
+                       transaction.amount().cents(),
+                       balance)
+        || !db.commit()) {
+        qDebug() << db.lastError().text();
+        db.rollback();
+        return std::nullopt;
+    }
+
+    // Tell the views about the new row and read back its ID, balance and names.
+    LedgerChange change = insertedChange(transaction.userID(), {transactionID});
+    if (!change.changes.isEmpty()) {
+        transaction = change.changes.constFirst().transaction;
+    }
+    emit ChangeNotifier::getInstance()->ledgerChanged(change);
+
+    // If the queries are successful, return the transaction.
+    return transaction;
+}
+
+/**
+ * @brief Insert a batch of the user's transactions in a single database transaction.
+ *        One prepared statement is rebound for every draft, and the running balances are
+ *        recomputed once for the whole batch, from the earliest inserted date onward.
+ *        A draft that fails is recorded in the result and skipped; the others are kept.
+ * 
+ * @param userID The ID of the user.
+ * @param drafts The transactions to insert.
+ * @return The ID or error of each draft, and whether the batch was committed.
+ */
+TransactionBatchResult Database::createTransactions(int userID,
+                                                    const QVector<TransactionDraft> &drafts)
+{
+    TransactionBatchResult result;
+    result.transactionIDs.fill(0, drafts.size());
+
+    // Insert every row and fix the balances atomically.
+    if (!db.transaction()) {
+        qDebug() << db.lastError().text();
+        return result;
+    }
+
+    // Create a query to insert each transaction; balances are filled in after the batch.
+    QSqlQuery &query = cachedQuery(
+        "INSERT INTO Transactions (amount, description, transactionDate, categoryID, "
+        "subcategoryID, userID, isDeposit, balance) VALUES (:amount, :description, "
+        ":date, :categoryID, :subcategoryID, :userID, :isDeposit, 0)");
 
-    } else {
-        // If the transaction is a withdrawal.
-        // Make the amount negative.
-        amount = (abs(amount) * -1);
+    // Earliest date inserted; balances from it onward change.
+    QDate earliestDate;
+
+    for (int i = 0; i < drafts.size(); ++i) {
+        const TransactionDraft &draft = drafts.at(i);
+
+        // Reject drafts that cannot be stored exactly.
+        if (!draft.amount.isValidAmount()) {
+            result.errors.insert(i, "Amount is out of range.");
+            continue;
+        }
+        if (!draft.date.isValid()) {
+            result.errors.insert(i, "Date is not valid.");
+            continue;
+        }
+
+        // Deposits are positive and uncategorized; withdrawals are negative.
+        Money amount = draft.signedAmount();
+        int categoryID = draft.isDeposit ? 0 : draft.categoryID;
+        int subcategoryID = draft.isDeposit ? 0 : draft.subcategoryID;
+
+        query.bindValue(":amount", amount.cents());
+        query.bindValue(":description", draft.description);
+        query.bindValue(":date", toEpochDay(draft.date));
+        query.bindValue(":categoryID", categoryID);
+        query.bindValue(":subcategoryID", subcategoryID);
+        query.bindValue(":userID", userID);
+        query.bindValue(":isDeposit", draft.isDeposit);
+
+        // Execute the query; a failed row does not end the batch.
+        if (!query.exec()) {
+            result.errors.insert(i, query.lastError().text());
+            continue;
+        }
+
+        result.transactionIDs[i] = query.lastInsertId().toInt();
+        if (!earliestDate.isValid() || draft.date < earliestDate) {
+            earliestDate = draft.date;
+        }
     }
 
-    // Create a new transaction.
-    Transaction *transaction
-        = new Transaction(amount, description, date, categoryID, subcategoryID, userID, isDeposit);
-    qDebug() << "Database::createTransaction()";
-    qDebug() << "Transaction: " << transaction->toString();
-    // Create a query to insert the transaction into the database.
-    QSqlQuery query;
-    query.prepare("INSERT INTO Transactions (amount, description, transactionDate, categoryID, "
-                  "subcategoryID, userID, isDeposit) VALUES (:amount, :description, :date, "
-                  ":categoryID, :subcategoryID, :userID, :isDeposit)");
-    query.bindValue(":amount", transaction->amount());
-    query.bindValue(":description", transaction->description());
-    query.bindValue(":date", transaction->date());
-    query.bindValue(":categoryID", transaction->categoryID());
-    query.bindValue(":subcategoryID", transaction->subcategoryID());
-    query.bindValue(":userID", transaction->userID());
-    query.bindValue(":isDeposit", transaction->isDeposit());
+    // Compute the balances of the new rows and every row after them, and their buckets.
+    if (earliestDate.isValid()
+        && (!recomputeBalances(userID, earliestDate) || !rebuildPyramid(userID, earliestDate))) {
+        db.rollback();
+        return result;
+    }
 
-    // Execute the query.
-    if (query.exec()) {
-        // If the query is successful, return the transaction.
-        return transaction;
+    // Commit the batch; page reads wait until the change is announced.
+    QWriteLocker announcing(&LEDGER_ANNOUNCE_LOCK);
+    if (!db.commit()) {
+        qDebug() << db.lastError().text();
+        db.rollback();
+        return result;
+    }
 
-    } else {
-        // If the query fails, print an error message.
-        return nullptr;
+    result.committed = true;
+
+    // Tell the views about the new rows.
+    QVector<int> insertedIDs;
+    for (int transactionID : std::as_const(result.transactionIDs)) {
+        if (transactionID > 0) {
+            insertedIDs.append(transactionID);
+        }
+    }
+    if (!insertedIDs.isEmpty()) {
+        emit ChangeNotifier::getInstance()->ledgerChanged(insertedChange(userID, insertedIDs));
     }
+
+    return result;
 }
 
 /**
  * @brief Insert a new category into the database.
  * @param categoryName The name of the category.
  * @param userID The ID of the user.
- * @return Returns true if the category was successfully created, false otherwise.
+ * @return The ID of the new category; std::nullopt if it could not be created.
  */
-bool Database::createCategory(const QString &categoryName, int userID)
+std::optional<int> Database::createCategory(const QString &categoryName, int userID)
 {
     // Create a query to insert the category into the database.
-    QSqlQuery query;
-    query.prepare("INSERT INTO Category (categoryName, userID) VALUES (:categoryName, :userID)");
+    QSqlQuery &query = cachedQuery(
+        "INSERT INTO Category (categoryName, userID) VALUES (:categoryName, :userID)");
     query.bindValue(":categoryName", categoryName);
     query.bindValue(":userID", userID);
 
     // Execute the query.
     if (query.exec()) {
-        // If the query is successful, return true.
-        return true;
+        int categoryID = query.lastInsertId().toInt();
+        // Add the category to the cached tree.
+        CategoryCache::instance().addCategory(userID, categoryID, categoryName);
+        // Tell the views about the category.
+        emit ChangeNotifier::getInstance()->categoryAdded(userID, categoryID, categoryName);
+        // If the query is successful, return the new ID.
+        return categoryID;
 
     } else {
         // If the query fails, print an error message.
         qDebug() << query.lastError().text();
-        return false;
+        return std::nullopt;
     }
 }
 
@@ -683,50 +1738,762 @@ bool Database::createCategory(const QString &categoryName, int userID)
  * @param subcategoryName The name of the subcategory.
  * @param userID The ID of the user.
  * @param categoryID The ID of the parent category.
- * @return Returns true if the subcategory was successfully created, false otherwise.
+ * @return The ID of the new subcategory; std::nullopt if it could not be created.
  */
-bool Database::createSubcategory(const QString &subcategoryName, int userID, int categoryID)
+std::optional<int> Database::createSubcategory(const QString &subcategoryName,
+                                               int userID,
+                                               int categoryID)
 {
     // Create a query to insert the subcategory into the database.
-    QSqlQuery query;
-    query.prepare("INSERT INTO Subcategory (subcategoryName, userID, categoryID) VALUES "
-                  "(:subcategoryName, :userID, :categoryID)");
+    QSqlQuery &query = cachedQuery(
+        "INSERT INTO Subcategory (subcategoryName, userID, categoryID) VALUES "
+        "(:subcategoryName, :userID, :categoryID)");
     query.bindValue(":subcategoryName", subcategoryName);
     query.bindValue(":userID", userID);
     query.bindValue(":categoryID", categoryID);
 
     // Execute the query.
     if (query.exec()) {
-        // If the query is successful, return true.
-        return true;
+        int subcategoryID = query.lastInsertId().toInt();
+        // Add the subcategory to the cached tree.
+        CategoryCache::instance().addSubcategory(userID,
+                                                 categoryID,
+                                                 subcategoryID,
+                                                 subcategoryName);
+        // Tell the views about the subcategory.
+        emit ChangeNotifier::getInstance()->subcategoryAdded(userID,
+                                                             categoryID,
+                                                             subcategoryID,
+                                                             subcategoryName);
+        // If the query is successful, return the new ID.
+        return subcategoryID;
 
     } else {
         // If the query fails, print an error message.
         qDebug() << query.lastError().text();
-        return false;
+        return std::nullopt;
     }
 }
 
 /**
  * @brief Delete a transaction from the database.
+ *        Deleting the user's latest transaction writes no other row; deleting an earlier one
+ *        rewrites the balance of every later row of the user.
  * @param transactionID The ID of the transaction.
  * @return Returns true if the transaction was successfully deleted, false otherwise.
  */
 bool Database::deleteTransaction(int transactionID)
 {
-    // Create a query to delete the transaction from the database.
-    QSqlQuery query;
-    query.prepare("DELETE FROM Transactions WHERE transactionID = :transactionID");
+    // Read the row, delete it and fix the balances after it atomically, so no write can
+    // change the row between reading it and deleting it.
+    if (!db.transaction()) {
+        qDebug() << db.lastError().text();
+        return false;
+    }
+
+    // Create a query to find the transaction's owner and amount.
+    QSqlQuery &query = cachedQuery(
+        "SELECT userID, amount, transactionDate, categoryID, subcategoryID, balance "
+        "FROM Transactions "
+        "WHERE transactionID = :transactionID");
     query.bindValue(":transactionID", transactionID);
 
+    // If the transaction does not exist, there is nothing to delete.
+    if (!query.exec() || !query.next()) {
+        qDebug() << query.lastError().text();
+        query.finish();
+        db.rollback();
+        return false;
+    }
+    int userID = query.value("userID").toInt();
+    qint64 amount = query.value("amount").toLongLong();
+    qint64 date = query.value("transactionDate").toLongLong();
+    int categoryID = query.value("categoryID").toInt();
+    int subcategoryID = query.value("subcategoryID").toInt();
+    qint64 balance = query.value("balance").toLongLong();
+    query.finish();
+
+    // Create a query to delete the transaction from the database.
+    QSqlQuery &deleteQuery = cachedQuery(
+        "DELETE FROM Transactions WHERE transactionID = :transactionID");
+    deleteQuery.bindValue(":transactionID", transactionID);
+
     // Execute the query.
-    if (query.exec()) {
-        // If the query is successful, return true.
-        return true;
+    if (!deleteQuery.exec()) {
+        // If the query fails, print an error message.
+        qDebug() << deleteQuery.lastError().text();
+        db.rollback();
+        return false;
+    }
 
-    } else {
+    // Remove the amount from every later balance of the same user.
+    // Deleting the latest transaction touches no other rows; deleting an earlier one
+    // rewrites every row after it.
+    QSqlQuery &updateQuery = cachedQuery(
+        "UPDATE Transactions SET balance = balance - :amount "
+        "WHERE userID = :userID "
+        "AND (transactionDate, transactionID) > (:date, :transactionID)");
+    updateQuery.bindValue(":amount", amount);
+    updateQuery.bindValue(":userID", userID);
+    updateQuery.bindValue(":date", date);
+    updateQuery.bindValue(":transactionID", transactionID);
+
+    // Execute the query.
+    if (!updateQuery.exec()) {
+        // If the query fails, print an error message.
+        qDebug() << updateQuery.lastError().text();
+        db.rollback();
+        return false;
+    }
+
+    // Move the balance pyramid with the balances.
+    if (!updatePyramid(ChangeKind::Deleted, userID, fromEpochDay(date), transactionID, amount,
+                       balance)) {
+        db.rollback();
+        return false;
+    }
+
+    // Commit the deletion; page reads wait until the change is announced.
+    QWriteLocker announcing(&LEDGER_ANNOUNCE_LOCK);
+    if (!db.commit()) {
+        qDebug() << db.lastError().text();
+        db.rollback();
+        return false;
+    }
+
+    // Tell the views which row was removed and what it took from the later balances.
+    TransactionChange removed;
+    removed.kind = ChangeKind::Deleted;
+    removed.transaction = Transaction(transactionID,
+                                      Money::fromCents(amount),
+                                      QString(),
+                                      fromEpochDay(date),
+                                      categoryID,
+                                      subcategoryID,
+                                      Money(),
+                                      userID);
+    removed.balanceDelta = Money::fromCents(-amount);
+    emit ChangeNotifier::getInstance()->ledgerChanged(LedgerChange{userID, {removed}});
+
+    // If the queries are successful, return true.
+    return true;
+}
+
+/**
+ * @brief Retrieves a user's budgets.
+ * @param userID The ID of the user.
+ * @return QVector of budgets ordered by category and subcategory; empty if there are none.
+ */
+QVector<Budget> Database::getBudgets(int userID)
+{
+    // Create a query to retrieve the user's budgets.
+    QSqlQuery &query = cachedQuery(
+        "SELECT budgetID, categoryID, subcategoryID, amount FROM Budget "
+        "WHERE userID = :userID ORDER BY categoryID, subcategoryID");
+    query.bindValue(":userID", userID);
+
+    // Query the database for the budgets.
+    if (!query.exec()) {
+        qDebug() << query.lastError().text();
+        return {};
+    }
+
+    // Create a budget from each row.
+    QVector<Budget> budgets;
+    while (query.next()) {
+        budgets.append(Budget(query.value("budgetID").toInt(),
+                              query.value("categoryID").toInt(),
+                              query.value("subcategoryID").toInt(),
+                              Money::fromCents(query.value("amount").toLongLong()),
+                              userID));
+    }
+
+    return budgets;
+}
+
+/**
+ * @brief Insert a new budget into the database.
+ * @param categoryID The ID of the category.
+ * @param subcategoryID The ID of the subcategory; 0 budgets the whole category.
+ * @param amount The monthly amount.
+ * @param userID The ID of the user.
+ * @return The stored budget; std::nullopt if it could not be created.
+ */
+std::optional<Budget> Database::createBudget(int categoryID,
+                                             int subcategoryID,
+                                             Money amount,
+                                             int userID)
+{
+    // Reject amounts that cannot be stored exactly.
+    if (!amount.isValidAmount() || amount < Money()) {
+        return std::nullopt;
+    }
+
+    // Create a query to insert the budget into the database.
+    QSqlQuery &query = cachedQuery(
+        "INSERT INTO Budget (userID, categoryID, subcategoryID, amount) "
+        "VALUES (:userID, :categoryID, :subcategoryID, :amount)");
+    query.bindValue(":userID", userID);
+    query.bindValue(":categoryID", categoryID);
+    query.bindValue(":subcategoryID", subcategoryID);
+    query.bindValue(":amount", amount.cents());
+
+    // Execute the query.
+    if (!query.exec()) {
+        // If the query fails, print an error message.
+        qDebug() << query.lastError().text();
+        return std::nullopt;
+    }
+    Budget budget(query.lastInsertId().toInt(), categoryID, subcategoryID, amount, userID);
+
+    // Tell the views about the budget.
+    emit ChangeNotifier::getInstance()->budgetsChanged(userID);
+
+    // If the query is successful, return the budget.
+    return budget;
+}
+
+/**
+ * @brief Updates a budget's amount.
+ * @param budget The budget, with its ID and new amount.
+ * @return Returns true if the budget was updated, false otherwise.
+ */
+bool Database::updateBudget(const Budget &budget)
+{
+    // Reject amounts that cannot be stored exactly.
+    if (!budget.amount().isValidAmount() || budget.amount() < Money()) {
+        return false;
+    }
+
+    // Create a query to update the budget's amount.
+    QSqlQuery &query = cachedQuery("UPDATE Budget SET amount = :amount "
+                                   "WHERE budgetID = :budgetID AND userID = :userID");
+    query.bindValue(":amount", budget.amount().cents());
+    query.bindValue(":budgetID", budget.budgetID());
+    query.bindValue(":userID", budget.userID());
+
+    // Execute the query; a budget that does not exist is not updated.
+    if (!query.exec() || query.numRowsAffected() != 1) {
+        qDebug() << query.lastError().text();
+        return false;
+    }
+
+    // Tell the views about the new amount.
+    emit ChangeNotifier::getInstance()->budgetsChanged(budget.userID());
+    return true;
+}
+
+/**
+ * @brief Deletes a budget from the database.
+ * @param budgetID The ID of the budget.
+ * @return Returns true if the budget was deleted, false otherwise.
+ */
+bool Database::deleteBudget(int budgetID)
+{
+    // Create a query to find the budget's owner.
+    QSqlQuery &query = cachedQuery("SELECT userID FROM Budget WHERE budgetID = :budgetID");
+    query.bindValue(":budgetID", budgetID);
+
+    // If the budget does not exist, there is nothing to delete.
+    if (!query.exec() || !query.next()) {
+        qDebug() << query.lastError().text();
+        return false;
+    }
+    int userID = query.value("userID").toInt();
+    query.finish();
+
+    // Create a query to delete the budget from the database.
+    QSqlQuery &deleteQuery = cachedQuery("DELETE FROM Budget WHERE budgetID = :budgetID");
+    deleteQuery.bindValue(":budgetID", budgetID);
+
+    // Execute the query.
+    if (!deleteQuery.exec()) {
         // If the query fails, print an error message.
+        qDebug() << deleteQuery.lastError().text();
+        return false;
+    }
+
+    // Tell the views the budget is gone.
+    emit ChangeNotifier::getInstance()->budgetsChanged(userID);
+    return true;
+}
+
+/**
+ * @brief Reads back the settings in effect on this connection.
+ *        The checkpoint interval is not an SQLite setting and is the one configured.
+ * @return The connection's settings.
+ */
+DurabilitySettings Database::activeSettings()
+{
+    DurabilitySettings settings = DURABILITY;
+    QSqlQuery query(db);
+
+    // Read a single valued pragma.
+    auto pragma = [&query](const QString &name) -> QVariant {
+        if (query.exec("PRAGMA " + name) && query.next()) {
+            return query.value(0);
+        }
+        qDebug() << name << query.lastError().text();
+        return QVariant();
+    };
+
+    settings.journalMode = pragma("journal_mode").toString().toUpper();
+    settings.synchronous = pragma("synchronous").toInt();
+    settings.mmapSize = pragma("mmap_size").toLongLong();
+    settings.tempStore = pragma("temp_store").toInt();
+    settings.busyTimeout = pragma("busy_timeout").toInt();
+    settings.walAutoCheckpoint = pragma("wal_autocheckpoint").toInt();
+
+    // A positive cache size is in pages.
+    qint64 cacheSize = pragma("cache_size").toLongLong();
+    if (cacheSize < 0) {
+        settings.cacheSizeKiB = int(-cacheSize);
+    } else {
+        settings.cacheSizeKiB = int(cacheSize * pragma("page_size").toLongLong() / 1024);
+    }
+
+    return settings;
+}
+
+/**
+ * @brief Copies the WAL into the database file.
+ * @param mode How to treat readers and writers that are using the WAL.
+ * @return Returns true if every frame was copied, false if the checkpoint failed or readers
+ *         kept it from finishing.
+ */
+bool Database::checkpoint(CheckpointMode mode)
+{
+    QSqlQuery query(db);
+
+    // The result row is (busy, frames in the WAL, frames copied).
+    QString sql = QString("PRAGMA wal_checkpoint(%1)")
+                      .arg(QString::fromLatin1(CHECKPOINT_MODE_NAMES[int(mode)]));
+    if (!query.exec(sql) || !query.next()) {
         qDebug() << query.lastError().text();
         return false;
     }
+
+    return query.value(0).toInt() == 0;
+}
+
+/**
+ * @brief Number of statements served from the prepared statement cache.
+ * @return The number of cache hits since the database was opened.
+ */
+quint64 Database::statementCacheHits() const
+{
+    return m_statementCacheHits;
+}
+
+/**
+ * @brief Number of statements prepared because they were not in the cache.
+ * @return The number of cache misses since the database was opened.
+ */
+quint64 Database::statementCacheMisses() const
+{
+    return m_statementCacheMisses;
+}
+
+/**
+ * @brief Drops every cached prepared statement.
+ *        Called whenever the schema changes, since statements are planned against the schema
+ *        they were prepared with.
+ */
+void Database::clearStatementCache()
+{
+    m_statements.clear();
+    m_failedStatement.reset();
+}
+
+/**
+ * @brief Gets the prepared statement for an SQL statement, preparing it on first use.
+ *        Reused statements are reset and keep their previous bindings, so callers must bind
+ *        every parameter before executing. Statements that fail to prepare are not cached.
+ * @param sql The SQL statement.
+ * @return The prepared statement, ready to be bound and executed.
+ */
+QSqlQuery &Database::cachedQuery(const QString &sql)
+{
+    // Reuse the statement if it has been prepared before.
+    auto cached = m_statements.find(sql);
+    if (cached != m_statements.end()) {
+        ++m_statementCacheHits;
+        // Reset the previous execution.
+        cached->second.finish();
+        return cached->second;
+    }
+
+    // Prepare the statement on first use.
+    ++m_statementCacheMisses;
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    if (!query.prepare(sql)) {
+        // Keep the statement out of the cache so it is prepared again next time.
+        qDebug() << "Error preparing statement: " << query.lastError().text();
+        return m_failedStatement.emplace(std::move(query));
+    }
+
+    return m_statements.emplace(sql, std::move(query)).first->second;
+}
+
+/**
+ * @brief Gets a user's category tree from the cache, loading it on first use.
+ *        The user's categories, the shared categories of user 0 and the user's subcategories
+ *        are read in two queries.
+ * @param userID The ID of the user.
+ * @return The user's tree; empty if it could not be read.
+ */
+CategoryTree Database::categoryTree(int userID)
+{
+    CategoryCache &cache = CategoryCache::instance();
+
+    // Serve the tree from memory.
+    if (std::optional<CategoryTree> tree = cache.tree(userID)) {
+        return *tree;
+    }
+
+    // Remember the generation, so a tree that misses a concurrent change is not cached.
+    quint64 generation = cache.generation(userID);
+    CategoryTree tree;
+
+    // Create a query to retrieve the user's categories.
+    QSqlQuery &categoryQuery = cachedQuery(
+        "SELECT categoryID, categoryName FROM Category WHERE userID = :userID OR userID = 0");
+    categoryQuery.bindValue(":userID", userID);
+
+    // Query the database for the user's categories.
+    if (!categoryQuery.exec()) {
+        qDebug() << categoryQuery.lastError().text();
+        return tree;
+    }
+    while (categoryQuery.next()) {
+        tree.addCategory(categoryQuery.value(0).toInt(), categoryQuery.value(1).toString());
+    }
+
+    // Create a query to retrieve the user's subcategories.
+    QSqlQuery &subcategoryQuery = cachedQuery(
+        "SELECT categoryID, subcategoryID, subcategoryName FROM Subcategory "
+        "WHERE userID = :userID");
+    subcategoryQuery.bindValue(":userID", userID);
+
+    // Query the database for the user's subcategories.
+    if (!subcategoryQuery.exec()) {
+        qDebug() << subcategoryQuery.lastError().text();
+        return tree;
+    }
+    while (subcategoryQuery.next()) {
+        tree.addSubcategory(subcategoryQuery.value(0).toInt(),
+                            subcategoryQuery.value(1).toInt(),
+                            subcategoryQuery.value(2).toString());
+    }
+
+    cache.insert(userID, tree, generation);
+    return tree;
+}
+
+/**
+ * @brief Reads every row of an executed ledger query into transactions.
+ *        Columns are looked up by name once, and each row is built in place in the vector.
+ * @param query The executed query, selecting Transactions columns plus category names.
+ * @return QVector of transactions.
+ */
+QVector<Transaction> Database::readLedger(QSqlQuery &query)
+{
+    // Find each column once rather than by name on every row.
+    QSqlRecord record = query.record();
+    int transactionIDField = record.indexOf("transactionID");
+    int amountField = record.indexOf("amount");
+    int descriptionField = record.indexOf("description");
+    int dateField = record.indexOf("transactionDate");
+    int categoryIDField = record.indexOf("categoryID");
+    int subcategoryIDField = record.indexOf("subcategoryID");
+    int balanceField = record.indexOf("balance");
+    int userIDField = record.indexOf("userID");
+    int isDepositField = record.indexOf("isDeposit");
+    int categoryNameField = record.indexOf("categoryName");
+    int subcategoryNameField = record.indexOf("subcategoryName");
+
+    // Initialize a vector of transactions.
+    QVector<Transaction> transactions;
+
+    // Iterate through the results.
+    while (query.next()) {
+        // Create the transaction from the row in the vector.
+        Transaction &transaction
+            = transactions.emplace_back(query.value(transactionIDField).toInt(),
+                                        Money::fromCents(query.value(amountField).toLongLong()),
+                                        query.value(descriptionField).toString(),
+                                        fromEpochDay(query.value(dateField).toLongLong()),
+                                        query.value(categoryIDField).toInt(),
+                                        query.value(subcategoryIDField).toInt(),
+                                        Money::fromCents(query.value(balanceField).toLongLong()),
+                                        query.value(userIDField).toInt(),
+                                        query.value(isDepositField).toBool());
+        // Attach the joined names.
+        transaction.setCategoryName(query.value(categoryNameField).toString());
+        transaction.setSubcategoryName(query.value(subcategoryNameField).toString());
+    }
+
+    return transactions;
+}
+
+/**
+ * @brief Reads rows just inserted for a user and describes them as a ledger change.
+ *        The rows are read with their stored balances and names; each adds its amount to
+ *        the balance of every row after it.
+ * @param userID The ID of the user.
+ * @param transactionIDs The IDs of the inserted rows.
+ * @return The change, in ledger order.
+ */
+LedgerChange Database::insertedChange(int userID, const QVector<int> &transactionIDs)
+{
+    LedgerChange change;
+    change.userID = userID;
+
+    // Read the range of IDs the rows were given.
+    auto [first, last] = std::minmax_element(transactionIDs.cbegin(), transactionIDs.cend());
+    QSqlQuery &query = cachedQuery(
+        QString(LEDGER_QUERY)
+        + "WHERE t.userID = :userID AND t.transactionID BETWEEN :first AND :last "
+          "ORDER BY t.transactionDate, t.transactionID");
+    query.bindValue(":userID", userID);
+    query.bindValue(":first", *first);
+    query.bindValue(":last", *last);
+
+    if (!query.exec()) {
+        qDebug() << query.lastError().text();
+        return change;
+    }
+
+    // Keep only the inserted rows; the range may hold rows inserted by another connection.
+    QSet<int> inserted(transactionIDs.cbegin(), transactionIDs.cend());
+    const QVector<Transaction> transactions = readLedger(query);
+    change.changes.reserve(inserted.size());
+    for (const Transaction &transaction : transactions) {
+        if (inserted.contains(transaction.transactionID())) {
+            change.changes.append({ChangeKind::Inserted, transaction, transaction.amount()});
+        }
+    }
+
+    return change;
+}
+
+/**
+ * @brief Recomputes a user's running balances from a date onward, after rows were inserted.
+ *        Rows before the date are unchanged, so each balance is the last balance before the
+ *        date plus a window sum of the amounts from the date.
+ * @param userID The ID of the user.
+ * @param from The earliest date whose balances changed.
+ * @return Returns true if the balances were recomputed, false otherwise.
+ */
+bool Database::recomputeBalances(int userID, const QDate &from)
+{
+    QSqlQuery &query = cachedQuery(
+        "UPDATE Transactions SET balance = ledger.balance FROM ("
+        "SELECT transactionID, "
+        "COALESCE((SELECT balance FROM Transactions WHERE userID = :baseUserID "
+        "AND transactionDate < :baseDate "
+        "ORDER BY transactionDate DESC, transactionID DESC LIMIT 1), 0) "
+        "+ SUM(amount) OVER (ORDER BY transactionDate, transactionID) AS balance "
+        "FROM Transactions WHERE userID = :userID AND transactionDate >= :date) AS ledger "
+        "WHERE Transactions.transactionID = ledger.transactionID");
+    query.bindValue(":baseUserID", userID);
+    query.bindValue(":baseDate", toEpochDay(from));
+    query.bindValue(":userID", userID);
+    query.bindValue(":date", toEpochDay(from));
+
+    if (!query.exec()) {
+        qDebug() << "Error computing balances: " << query.lastError().text();
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Applies an insert or delete to the balance pyramid.
+ *        Every balance after the written row moved by the same amount, so the buckets after
+ *        the row's bucket move with them on each level. When the row is the last of its
+ *        bucket, the bucket is updated in place; it is aggregated again only when later rows
+ *        of the bucket moved too, or a delete removed its low or high.
+ *        Must run in the write's transaction, after the balances are fixed.
+ * @param kind Whether the row was inserted or deleted.
+ * @param userID The ID of the user.
+ * @param date The date of the row.
+ * @param transactionID The ID of the row.
+ * @param amount The amount of the row.
+ * @param balance The balance of the row; for a delete, the balance it had.
+ * @return Returns true if the pyramid was updated, false otherwise.
+ */
+bool Database::updatePyramid(
+    ChangeKind kind, int userID, const QDate &date, int transactionID, qint64 amount, qint64 balance)
+{
+    qint64 delta = kind == ChangeKind::Inserted ? amount : -amount;
+
+    // Find the date of the row after it in ledger order; none if it is the user's last.
+    QSqlQuery &nextQuery = cachedQuery(
+        "SELECT transactionDate FROM Transactions WHERE userID = :userID "
+        "AND (transactionDate, transactionID) > (:date, :transactionID) "
+        "ORDER BY transactionDate, transactionID LIMIT 1");
+    nextQuery.bindValue(":userID", userID);
+    nextQuery.bindValue(":date", toEpochDay(date));
+    nextQuery.bindValue(":transactionID", transactionID);
+
+    if (!nextQuery.exec()) {
+        qDebug() << "Error updating balance pyramid: " << nextQuery.lastError().text();
+        return false;
+    }
+    QDate nextDate = nextQuery.next() ? fromEpochDay(nextQuery.value(0).toLongLong()) : QDate();
+    nextQuery.finish();
+
+    // Move the later buckets.
+    QSqlQuery &shiftQuery = cachedQuery(
+        "UPDATE BalancePyramid SET open = open + :openDelta, close = close + :closeDelta, "
+        "low = low + :lowDelta, high = high + :highDelta "
+        "WHERE userID = :userID AND level = :level AND bucket > :bucket");
+
+    // Append the row to its bucket, creating the bucket if it is the first row.
+    QSqlQuery &appendQuery = cachedQuery(
+        "INSERT INTO BalancePyramid (userID, level, bucket, open, close, low, high, count) "
+        "VALUES (:userID, :level, :bucket, :balance, :balance, :balance, :balance, 1) "
+        "ON CONFLICT (userID, level, bucket) DO UPDATE SET close = excluded.close, "
+        "low = MIN(low, excluded.low), high = MAX(high, excluded.high), count = count + 1");
+
+    // Remove the row from the end of its bucket, unless it held the bucket's low or high.
+    QSqlQuery &removeQuery = cachedQuery(
+        "UPDATE BalancePyramid SET close = close - :amount, count = count - 1 "
+        "WHERE userID = :userID AND level = :level AND bucket = :bucket "
+        "AND low < :lowBalance AND high > :highBalance");
+
+    for (PyramidLevel level : BalancePyramid::LEVELS) {
+        qint64 bucket = toEpochDay(BalancePyramid::bucketStart(date, level));
+
+        shiftQuery.bindValue(":openDelta", delta);
+        shiftQuery.bindValue(":closeDelta", delta);
+        shiftQuery.bindValue(":lowDelta", delta);
+        shiftQuery.bindValue(":highDelta", delta);
+        shiftQuery.bindValue(":userID", userID);
+        shiftQuery.bindValue(":level", int(level));
+        shiftQuery.bindValue(":bucket", bucket);
+
+        if (!shiftQuery.exec()) {
+            qDebug() << "Error updating balance pyramid: " << shiftQuery.lastError().text();
+            return false;
+        }
+
+        // Later rows in the bucket moved too, so its extremes must be found again.
+        bool lastInBucket = !nextDate.isValid()
+                            || nextDate >= BalancePyramid::nextBucketStart(date, level);
+        if (!lastInBucket) {
+            if (!rebuildLevel(userID, level, date, date)) {
+                return false;
+            }
+            continue;
+        }
+
+        if (kind == ChangeKind::Inserted) {
+            appendQuery.bindValue(":userID", userID);
+            appendQuery.bindValue(":level", int(level));
+            appendQuery.bindValue(":bucket", bucket);
+            appendQuery.bindValue(":balance", balance);
+
+            if (!appendQuery.exec()) {
+                qDebug() << "Error updating balance pyramid: " << appendQuery.lastError().text();
+                return false;
+            }
+            continue;
+        }
+
+        removeQuery.bindValue(":amount", amount);
+        removeQuery.bindValue(":userID", userID);
+        removeQuery.bindValue(":level", int(level));
+        removeQuery.bindValue(":bucket", bucket);
+        removeQuery.bindValue(":lowBalance", balance);
+        removeQuery.bindValue(":highBalance", balance);
+
+        if (!removeQuery.exec()) {
+            qDebug() << "Error updating balance pyramid: " << removeQuery.lastError().text();
+            return false;
+        }
+
+        // The row held an extreme, or was the bucket's only row.
+        if (removeQuery.numRowsAffected() == 0 && !rebuildLevel(userID, level, date, date)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Aggregates a user's buckets of every level that overlap a range of dates again,
+ *        from the stored balances. Buckets the range touches are rebuilt whole.
+ * @param userID The ID of the user.
+ * @param from The first date whose balances changed.
+ * @param to The last date whose balances changed; invalid for every date after from.
+ * @return Returns true if the buckets were rebuilt, false otherwise.
+ */
+bool Database::rebuildPyramid(int userID, const QDate &from, const QDate &to)
+{
+    for (PyramidLevel level : BalancePyramid::LEVELS) {
+        if (!rebuildLevel(userID, level, from, to)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Aggregates a user's buckets of one level that overlap a range of dates again,
+ *        from the stored balances. Buckets the range touches are rebuilt whole.
+ * @param userID The ID of the user.
+ * @param level The level to rebuild.
+ * @param from The first date whose balances changed.
+ * @param to The last date whose balances changed; invalid for every date after from.
+ * @return Returns true if the buckets were rebuilt, false otherwise.
+ */
+bool Database::rebuildLevel(int userID, PyramidLevel level, const QDate &from, const QDate &to)
+{
+    // The range covers whole buckets; an open range ends after the last one.
+    qint64 start = toEpochDay(BalancePyramid::bucketStart(from, level));
+    qint64 end = to.isValid() ? toEpochDay(BalancePyramid::nextBucketStart(to, level)) : 0;
+    QString bucketRange = "bucket >= :from";
+    QString dateRange = "transactionDate >= :from";
+    if (to.isValid()) {
+        bucketRange += " AND bucket < :to";
+        dateRange += " AND transactionDate < :to";
+    }
+
+    // Remove the buckets.
+    QSqlQuery &deleteQuery = cachedQuery(
+        "DELETE FROM BalancePyramid WHERE userID = :userID AND level = :level AND "
+        + bucketRange);
+    deleteQuery.bindValue(":userID", userID);
+    deleteQuery.bindValue(":level", int(level));
+    deleteQuery.bindValue(":from", start);
+    if (to.isValid()) {
+        deleteQuery.bindValue(":to", end);
+    }
+
+    if (!deleteQuery.exec()) {
+        qDebug() << "Error rebuilding balance pyramid: " << deleteQuery.lastError().text();
+        return false;
+    }
+
+    // Aggregate the transactions of the buckets again.
+    QSqlQuery &fillQuery = cachedQuery(
+        BalancePyramid::fillSql(level, "userID = :userID AND " + dateRange));
+    fillQuery.bindValue(":userID", userID);
+    fillQuery.bindValue(":from", start);
+    if (to.isValid()) {
+        fillQuery.bindValue(":to", end);
+    }
+
+    if (!fillQuery.exec()) {
+        qDebug() << "Error rebuilding balance pyramid: " << fillQuery.lastError().text();
+        return false;
+    }
+
+    return true;
 }
@@ -3,115 +3,405 @@
 
 #include <QListWidget>
 #include <QSqlDatabase>
+#include <QSqlQuery>
+#include <optional>
+#include <unordered_map>
+#include "balancepyramid.h"
+#include "budget.h"
+#include "categorycache.h"
+#include "changenotifier.h"
+#include "durabilityprofile.h"
 #include "transaction.h"
 #include "user.h"
 #include "userlogin.h"
 
+// Position in a user's ledger, which is ordered by (date, transactionID).
+// A default constructed cursor points before the first or after the last transaction.
+struct LedgerCursor
+{
+    QDate date;
+    int transactionID = 0;
+
+    // Whether the cursor points at a transaction.
+    bool isValid() const { return transactionID > 0; }
+};
+
+// Direction to page through a ledger from a cursor.
+enum class PageDirection : int { Forward, Backward };
+
+// A transaction to insert with Database::createTransactions.
+struct TransactionDraft
+{
+    Money amount;
+    QString description;
+    QDate date;
+    int categoryID = 0;
+    int subcategoryID = 0;
+    bool isDeposit = false;
+
+    // The amount as stored: positive for deposits, negative for withdrawals.
+    Money signedAmount() const { return isDeposit ? amount.abs() : -amount.abs(); }
+};
+
+// Outcome of Database::createTransactions.
+struct TransactionBatchResult
+{
+    QVector<int> transactionIDs; // ID of each draft's transaction, in order; 0 if it failed.
+    QMap<int, QString> errors;   // Error of each failed draft, by index.
+    bool committed = false;      // Whether the batch was committed; nothing is kept otherwise.
+
+    // Number of drafts inserted.
+    int insertedCount() const { return committed ? transactionIDs.size() - errors.size() : 0; }
+};
+
+// A user's profile and login, read together when they log in or register.
+struct Account
+{
+    User user;
+    UserLogin login;
+};
+
+// Outcome of Database::registerAccount.
+struct RegistrationResult
+{
+    std::optional<Account> account; // The new account; std::nullopt if nothing was created.
+    QString error;                   // Why registration failed; empty if it succeeded.
+};
+
+// A transaction's place in the ledger and the balance after it.
+struct BalancePoint
+{
+    LedgerCursor position;
+    Money balance;
+};
+
+// A user's transactions in one month and category, read from the monthly rollup.
+struct MonthlyTotal
+{
+    QDate month;           // The first day of the month.
+    int categoryID = 0;    // The category; 0 for deposits.
+    int subcategoryID = 0; // The subcategory; 0 when totalled over the whole category.
+    Money total;           // Sum of the amounts; withdrawals are negative.
+    int count = 0;         // Number of transactions.
+};
+
+/**
+ * @brief The Database class runs the application's queries on one SQLite connection.
+ *        Qt connections may only be used by the thread that opened them, so every thread gets
+ *        its own instance: the first thread to ask opens the default connection and migrates
+ *        the schema, and later threads each lease a named connection from a bounded pool.
+ *        Under WAL, the threads read concurrently while one of them writes.
+ */
 class Database
 {
 private:
-    // Singleton instance of Database.
+    // Instance on the default connection; opened by the first thread to ask.
     static Database *INSTANCE;
 
+    // Settings applied to each connection as it opens.
+    static DurabilitySettings DURABILITY;
+
 public:
-    // Singleton instance getter.
+    // Most connections open at once, the default connection included.
+    static constexpr int MAX_CONNECTIONS = 8;
+
+    // Get the calling thread's instance, opening its connection on first use.
+    // Waits while every pooled connection is leased to another thread.
     static Database *getInstance();
 
+    // Close the calling thread's pooled connection and return it to the pool.
+    // Threads return theirs when they finish; the default connection stays open.
+    static void releaseInstance();
+
+    // Set the durability settings applied to connections opened from now on.
+    // Set them before the first connection is opened, from the main thread.
+    static void setDurabilitySettings(const DurabilitySettings &settings);
+
+    // Get the durability settings applied to new connections.
+    static DurabilitySettings durabilitySettings();
+
 private:
     Database();
+    explicit Database(const QString &connectionName);
     ~Database();
 
 public:
     // Get user from database by userID.
-    // Returns nullptr if user not found.
-    User *getUser(int userID);
+    // Returns std::nullopt if user not found.
+    std::optional<User> getUser(int userID);
 
     // Get user from database by username.
-    // Returns nullptr if user not found.
-    User *getUser(const QString username);
+    // Returns std::nullopt if user not found.
+    std::optional<User> getUser(const QString username);
 
     // Create user in database.
-    // Returns nullptr if user failed to be created.
-    User *createUser(const QString firstName, const QString lastName, Position position);
+    // Returns std::nullopt if user failed to be created.
+    std::optional<User> createUser(const QString firstName,
+                                   const QString lastName,
+                                   Position position);
 
     // Get user login from database by username.
-    // Returns nullptr if user login not found.
-    UserLogin *getUserLogin(const QString username);
+    // Returns std::nullopt if user login not found.
+    std::optional<UserLogin> getUserLogin(const QString username);
 
     // Get user login from database by email.
-    // Returns nullptr if user login not found.
-    UserLogin *getUserLoginEmail(const QString email);
+    // Returns std::nullopt if user login not found.
+    std::optional<UserLogin> getUserLoginEmail(const QString email);
+
+    // Get the login and profile of a username in one statement, to check a password against.
+    // Returns std::nullopt if the username is not registered.
+    std::optional<Account> authenticate(const QString &username);
 
-    // Create user login in database.
-    // Returns nullptr if user login failed to be created.
-    UserLogin *createUserLogin(const QString username,
-                               const QString password,
-                               AccessLevel accessLevel,
-                               const QString email,
-                               int userID);
+    // Create a user and their login in one database transaction; nothing is kept if either
+    // fails. The password is hashed by the caller, so no hashing runs here.
+    RegistrationResult registerAccount(const QString &firstName,
+                                       const QString &lastName,
+                                       Position position,
+                                       const QString &username,
+                                       const QString &passwordHash,
+                                       AccessLevel accessLevel,
+                                       const QString &email);
 
-    // Update user login password.
-    // Returns true if password was updated successfully.
-    bool updatePassword(UserLogin *userLogin, const QString password);
+    // Replace the stored hash of a user's password with one that was already computed.
+    // Returns true if the hash was replaced.
+    bool updatePasswordHash(int userID, const QString &hash);
 
     /* Retrieval Methods */
 
     // Get transactions from database by userID.
-    // Returns nullptr if transactions not found.
-    QVector<Transaction *> getTransactions(int userID);
+    // Returns an empty vector if transactions not found.
+    QVector<Transaction> getTransactions(int userID);
 
     // Get transactions from database by userID and budgetID.
-    // Returns nullptr if transactions not found.
-    QVector<Transaction *> getTransactions(int userID, int budgetID);
+    // Returns an empty vector if transactions not found.
+    QVector<Transaction> getTransactions(int userID, int budgetID);
 
     // Get transactions from database by userID and categoryID.
-    // Returns nullptr if transactions not found.
-    QVector<Transaction *> getTransactionsByCategory(int userID, int categoryID);
+    // Returns an empty vector if transactions not found.
+    QVector<Transaction> getTransactionsByCategory(int userID, int categoryID);
+
+    // Get transactions joined with their category and subcategory names by userID.
+    // Returns an empty vector if transactions not found.
+    QVector<Transaction> getLedger(int userID);
+
+    // Get transactions joined with their category and subcategory names by userID and categoryID.
+    // Returns an empty vector if transactions not found.
+    QVector<Transaction> getLedgerByCategory(int userID, int categoryID);
+
+    // Get up to limit transactions joined with their names, after (Forward) or before (Backward)
+    // the cursor in ledger order. A categoryID of -1 pages through every category.
+    // Rows are returned in ledger order for both directions.
+    QVector<Transaction> getLedgerPage(int userID,
+                                       int categoryID,
+                                       const LedgerCursor &cursor,
+                                       int limit,
+                                       PageDirection direction = PageDirection::Forward);
+
+    // Get transactions joined with their names dated from one date through another, in ledger
+    // order. A categoryID of -1 returns every category.
+    // Returns an empty vector if transactions not found.
+    QVector<Transaction> getLedgerBetween(int userID,
+                                          int categoryID,
+                                          const QDate &from,
+                                          const QDate &to);
+
+    // Get the balance after each transaction dated from one date through another, in ledger
+    // order. Invalid dates leave that end of the range open; a categoryID of -1 returns every
+    // category. Returns an empty vector if transactions not found.
+    QVector<BalancePoint> getBalanceHistory(int userID,
+                                            int categoryID,
+                                            const QDate &from = QDate(),
+                                            const QDate &to = QDate());
+
+    // Search the user's transaction descriptions; results are joined with their names and
+    // ranked by relevance. Page with limit and offset.
+    // Returns an empty vector if nothing matches.
+    QVector<Transaction> searchTransactions(int userID,
+                                            const QString &text,
+                                            int limit,
+                                            int offset = 0);
+
+    // Get the highest transaction ID, or 0 if there are no transactions.
+    int getLastTransactionID();
+
+    // Check which drafts match one of the user's transactions with an ID up to maxTransactionID
+    // on date, amount and description. Returns one flag per draft; std::nullopt if the ledger
+    // could not be read.
+    std::optional<QVector<bool>> findExistingTransactions(int userID,
+                                                          int maxTransactionID,
+                                                          const QVector<TransactionDraft> &drafts);
+
+    // Get the user's balance at the end of a date.
+    // Returns 0 if the user has no transactions on or before the date.
+    Money getBalanceOn(int userID, const QDate &date);
+
+    // Get the dates of the user's first and last transactions.
+    // Returns invalid dates if the user has no transactions.
+    QPair<QDate, QDate> getLedgerSpan(int userID);
+
+    // Get the user's buckets of a balance pyramid level that overlap the dates from one date
+    // through another, in date order. Returns an empty vector if there are none.
+    QVector<BalanceBucket> getBalancePyramid(int userID,
+                                             PyramidLevel level,
+                                             const QDate &from,
+                                             const QDate &to);
+
+    // Get the user's monthly totals per category for the months from one date through another,
+    // from the monthly rollup. A categoryID of -1 returns every category; bySubcategory splits
+    // each category's totals by subcategory. Ordered by month, category and subcategory.
+    // Returns an empty vector if the user has no transactions in those months.
+    QVector<MonthlyTotal> getMonthlyTotals(int userID,
+                                           const QDate &from,
+                                           const QDate &to,
+                                           int categoryID = -1,
+                                           bool bySubcategory = false);
+
+    // Get the user's total per category for the months from one date through another, from
+    // the monthly rollup. Returns an empty map if the user has no transactions in those months.
+    QMap<int, Money> getCategoryTotals(int userID, const QDate &from, const QDate &to);
 
     // Get all category names from database by userID.
-    // Returns nullptr if category names not found.
+    // Returns an empty map if category names not found.
+    // Category lookups are served from the CategoryCache after the first.
     QMap<int, QString> getCategoryNames(int userID);
 
     // Get a single category name from database by categoryID and userID.
-    // Returns nullptr if category names not found.
+    // Returns an empty map if category names not found.
     QMap<int, QString> getCategoryName(int userID, int categoryID);
 
     // Get all subcategory names from database by categoryID.
-    // Returns nullptr if subcategory names not found.
+    // Returns an empty map if subcategory names not found.
     QMap<int, QString> getSubcategoryNames(int userID, int categoryID);
 
     // Get subcategory names from database by categoryID.
-    // Returns nullptr if subcategory names not found.
+    // Returns an empty string if subcategory names not found.
     QString getSubcategoryName(int categoryID, int subcategoryID);
 
+    // Find a category or subcategory by its exact name.
+    // Returns std::nullopt if there is none.
+    std::optional<int> findCategoryID(int userID, const QString &categoryName);
+    std::optional<int> findSubcategoryID(int userID,
+                                         int categoryID,
+                                         const QString &subcategoryName);
+
     /* Insertion Methods */
 
-    // Inert transaction into database.
-    // Returns nullptr if transaction failed to be created.
-    Transaction *createTransaction(double amount,
-                                   QString description,
-                                   QString date,
-                                   int categoryID,
-                                   int subcategoryID,
-                                   int userID,
-                                   bool isDeposit = false);
+    // Inert transaction into database; a backdated one rewrites every later balance.
+    // Returns std::nullopt if transaction failed to be created.
+    std::optional<Transaction> createTransaction(Money amount,
+                                                 QString description,
+                                                 QDate date,
+                                                 int categoryID,
+                                                 int subcategoryID,
+                                                 int userID,
+                                                 bool isDeposit = false);
+
+    // Insert a batch of the user's transactions in a single database transaction.
+    // Drafts that fail are reported in the result and the rest are still inserted.
+    TransactionBatchResult createTransactions(int userID, const QVector<TransactionDraft> &drafts);
 
     // Insert category into database.
-    // Returns true if category was created successfully.
-    bool createCategory(const QString &categoryName, int userID);
+    // Returns the new category's ID; std::nullopt if it failed to be created.
+    std::optional<int> createCategory(const QString &categoryName, int userID);
 
     // Insert subcategory into database.
-    // Returns true if subcategory was created successfully.
-    bool createSubcategory(const QString &subcategoryName, int userID, int categoryID);
+    // Returns the new subcategory's ID; std::nullopt if it failed to be created.
+    std::optional<int> createSubcategory(const QString &subcategoryName,
+                                         int userID,
+                                         int categoryID);
 
     /* Deletion Methods */
 
-    // Delete transaction from database.
+    // Delete transaction from database; every later balance is rewritten.
     // Returns true if transaction was deleted successfully.
     bool deleteTransaction(int transactionID);
 
+    /* Budgets */
+
+    // Get the user's budgets, ordered by category and subcategory.
+    // Returns an empty vector if the user has none.
+    QVector<Budget> getBudgets(int userID);
+
+    // Insert budget into database.
+    // Returns the stored budget; std::nullopt if it failed to be created, such as when the
+    // category or subcategory already has a budget.
+    std::optional<Budget> createBudget(int categoryID, int subcategoryID, Money amount, int userID);
+
+    // Update a budget's amount.
+    // Returns true if the budget was updated.
+    bool updateBudget(const Budget &budget);
+
+    // Delete a budget.
+    // Returns true if the budget was deleted.
+    bool deleteBudget(int budgetID);
+
+    /* Durability */
+
+    // Read back the settings in effect on this connection.
+    DurabilitySettings activeSettings();
+
+    // Copy the WAL into the database file.
+    // Returns true if every frame was copied.
+    bool checkpoint(CheckpointMode mode = CheckpointMode::Passive);
+
+    /* Statement Cache */
+
+    // Number of statements reused from, or prepared and added to, the statement cache.
+    quint64 statementCacheHits() const;
+    quint64 statementCacheMisses() const;
+
+private:
+    // Open a connection to the database file.
+    bool open(const QString &connectionName);
+
+    // Apply the durability settings to the open connection.
+    void applyDurabilitySettings();
+
+    // Create the tables and indexes, migrating older databases.
+    void createSchema();
+
+    // Get the prepared statement for sql, preparing and caching it on first use.
+    QSqlQuery &cachedQuery(const QString &sql);
+
+    // Drop every cached statement; called when the schema changes.
+    void clearStatementCache();
+
+    // Get the user's category tree, loading it into the CategoryCache on first use.
+    CategoryTree categoryTree(int userID);
+
+    // Read the ledger rows of an executed ledger query.
+    QVector<Transaction> readLedger(QSqlQuery &query);
+
+    // Read rows just inserted for a user and describe them as a ledger change.
+    LedgerChange insertedChange(int userID, const QVector<int> &transactionIDs);
+
+    // Recompute a user's running balances from a date onward.
+    bool recomputeBalances(int userID, const QDate &from);
+
+    // Apply an inserted or deleted row, and the change it made to the later balances,
+    // to the balance pyramid.
+    bool updatePyramid(ChangeKind kind,
+                       int userID,
+                       const QDate &date,
+                       int transactionID,
+                       qint64 amount,
+                       qint64 balance);
+
+    // Aggregate a user's buckets from one date through another into the balance pyramid again.
+    // An invalid to rebuilds every bucket from the date onward.
+    bool rebuildPyramid(int userID, const QDate &from, const QDate &to = QDate());
+
+    // Aggregate a user's buckets of one level from one date through another again.
+    bool rebuildLevel(int userID, PyramidLevel level, const QDate &from, const QDate &to);
+
 private:
     QSqlDatabase db;
+
+    // Prepared statements by SQL text; node based, so references stay valid as statements are added.
+    std::unordered_map<QString, QSqlQuery> m_statements;
+    std::optional<QSqlQuery> m_failedStatement; // Last statement that failed to prepare.
+    quint64 m_statementCacheHits = 0;           // Statements reused from the cache.
+    quint64 m_statementCacheMisses = 0;         // Statements prepared on first use.
 };
 
 #endif // DATABASE_H
@@ -1,6 +1,6 @@
 #include "deletetransactiondialog.h"
 #include <QMessageBox>
-#include "database.h"
+#include "asyncdatabase.h"
 
 /**
  * @brief Allows the user to delete transactions from the database.
@@ -69,20 +69,29 @@ DeleteTransactionDialog::DeleteTransactionDialog(int transactionID,
  */
 void DeleteTransactionDialog::deleteButtonClicked()
 {
-    // Create a database instance
-    Database *db;
-    db = Database::getInstance();
+    // Disable the delete button until the transaction has been deleted
+    QPushButton *deleteButton = qobject_cast<QPushButton *>(sender());
+    if (deleteButton) {
+        deleteButton->setEnabled(false);
+    }
 
     // Delete the transaction from the database
-    if (db->deleteTransaction(m_transactionID)) {
-        // If the transaction was deleted successfully, notify the user
-        QMessageBox::information(this, "Success", "Transaction deleted.", QMessageBox::Ok);
-        // Emit the transactionDeleted() signal
-        emit transactionDeleted();
-        // Close the dialog
-        accept();
-    } else {
-        // Display an error message
-        QMessageBox::critical(this, "Error", "Failed to delete transaction.", QMessageBox::Ok);
-    }
+    AsyncDatabase *db = AsyncDatabase::getInstance();
+    db->deleteTransaction(m_transactionID).then(this, [this, deleteButton](bool deleted) {
+        if (deleted) {
+            // If the transaction was deleted successfully, notify the user
+            QMessageBox::information(this, "Success", "Transaction deleted.", QMessageBox::Ok);
+            // Emit the transactionDeleted() signal
+            emit transactionDeleted();
+            // Close the dialog
+            accept();
+        } else {
+            // Display an error message
+            QMessageBox::critical(this, "Error", "Failed to delete transaction.", QMessageBox::Ok);
+            // Allow another attempt
+            if (deleteButton) {
+                deleteButton->setEnabled(true);
+            }
+        }
+    });
 }
@@ -0,0 +1,66 @@
+#include "downsampler.h"
+#include <QtMath>
+
+/**
+ * @brief Downsamples a line with Largest-Triangle-Three-Buckets.
+ *        The points between the first and last are split into threshold - 2 buckets of equal
+ *        size. From each bucket the point kept is the one forming the largest triangle with the
+ *        point kept from the previous bucket and the average of the next bucket, so peaks and
+ *        troughs survive while flat stretches collapse. The points are visited once.
+ * @param points The points, ordered by x.
+ * @param threshold The maximum number of points to keep.
+ * @return The kept points in order; all of them if there are no more than threshold, or if
+ *         threshold is below 3.
+ */
+QList<QPointF> Downsampler::lttb(const QList<QPointF> &points, int threshold)
+{
+    const qsizetype count = points.size();
+    if (threshold < 3 || count <= threshold) {
+        return points;
+    }
+
+    QList<QPointF> sampled;
+    sampled.reserve(threshold);
+
+    // The first point is always kept.
+    const double bucketSize = double(count - 2) / (threshold - 2);
+    qsizetype kept = 0;
+    sampled.append(points.at(0));
+
+    for (int bucket = 0; bucket < threshold - 2; ++bucket) {
+        // Average the next bucket; the last point stands in for the bucket after the last.
+        qsizetype nextStart = qsizetype(qFloor((bucket + 1) * bucketSize)) + 1;
+        qsizetype nextEnd = qMin(qsizetype(qFloor((bucket + 2) * bucketSize)) + 1, count);
+        double averageX = 0;
+        double averageY = 0;
+        for (qsizetype i = nextStart; i < nextEnd; ++i) {
+            averageX += points.at(i).x();
+            averageY += points.at(i).y();
+        }
+        averageX /= nextEnd - nextStart;
+        averageY /= nextEnd - nextStart;
+
+        // Keep the point of this bucket forming the largest triangle.
+        qsizetype start = qsizetype(qFloor(bucket * bucketSize)) + 1;
+        qsizetype end = qsizetype(qFloor((bucket + 1) * bucketSize)) + 1;
+        const QPointF &previous = points.at(kept);
+        double largestArea = -1;
+        qsizetype largest = start;
+        for (qsizetype i = start; i < end; ++i) {
+            // Twice the area; only the comparison matters.
+            double area = qAbs((previous.x() - averageX) * (points.at(i).y() - previous.y())
+                               - (previous.x() - points.at(i).x()) * (averageY - previous.y()));
+            if (area > largestArea) {
+                largestArea = area;
+                largest = i;
+            }
+        }
+
+        sampled.append(points.at(largest));
+        kept = largest;
+    }
+
+    // The last point is always kept.
+    sampled.append(points.at(count - 1));
+    return sampled;
+}
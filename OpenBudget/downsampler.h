@@ -0,0 +1,19 @@
+#ifndef DOWNSAMPLER_H
+#define DOWNSAMPLER_H
+
+#include <QList>
+#include <QPointF>
+
+/**
+ * @brief The Downsampler class reduces a line to the number of points a chart can show while
+ *        keeping its shape, so series stay small however many transactions they cover.
+ */
+class Downsampler
+{
+public:
+    // Keep at most threshold of the points, chosen by Largest-Triangle-Three-Buckets.
+    // Points must be ordered by x; the first and last points are always kept.
+    static QList<QPointF> lttb(const QList<QPointF> &points, int threshold);
+};
+
+#endif // DOWNSAMPLER_H
@@ -0,0 +1,76 @@
+#include "durabilityprofile.h"
+#include <iterator>
+
+// Names of the synchronous levels, indexed by level.
+static const char *const SYNCHRONOUS_NAMES[] = {"OFF", "NORMAL", "FULL", "EXTRA"};
+
+/**
+ * @brief Gets the settings of a profile.
+ *        Every profile uses WAL, so readers never wait for the writer.
+ * @param profile The profile.
+ * @return The profile's settings.
+ */
+DurabilitySettings DurabilitySettings::forProfile(DurabilityProfile profile)
+{
+    DurabilitySettings settings;
+
+    switch (profile) {
+    case DurabilityProfile::Safe:
+        // Sync the WAL on every commit, with SQLite's default cache and no memory mapping.
+        settings.synchronous = 2;
+        settings.cacheSizeKiB = 2000;
+        settings.mmapSize = 0;
+        settings.tempStore = 0;
+        settings.checkpointInterval = 30000;
+        break;
+    case DurabilityProfile::Balanced:
+        // Sync only at checkpoints; a commit is atomic but may be lost on power failure.
+        break;
+    case DurabilityProfile::Fast:
+        // Never sync, and checkpoint less often so bulk writes stay sequential.
+        settings.synchronous = 0;
+        settings.cacheSizeKiB = 65536;
+        settings.mmapSize = 268435456;
+        settings.busyTimeout = 10000;
+        settings.walAutoCheckpoint = 4000;
+        settings.checkpointInterval = 300000;
+        break;
+    }
+
+    return settings;
+}
+
+/**
+ * @brief Gets a profile by its name.
+ * @param name The name of the profile, in any case.
+ * @return The profile; std::nullopt if no profile has the name.
+ */
+std::optional<DurabilityProfile> DurabilitySettings::profileFromName(const QString &name)
+{
+    QString lower = name.trimmed().toLower();
+
+    if (lower == "safe") {
+        return DurabilityProfile::Safe;
+    }
+    if (lower == "balanced") {
+        return DurabilityProfile::Balanced;
+    }
+    if (lower == "fast") {
+        return DurabilityProfile::Fast;
+    }
+
+    return std::nullopt;
+}
+
+/**
+ * @brief Gets the name of the synchronous level.
+ * @return The level's name, such as "NORMAL".
+ */
+QString DurabilitySettings::synchronousName() const
+{
+    if (synchronous < 0 || synchronous >= int(std::size(SYNCHRONOUS_NAMES))) {
+        return QString::number(synchronous);
+    }
+
+    return QString::fromLatin1(SYNCHRONOUS_NAMES[synchronous]);
+}
@@ -0,0 +1,46 @@
+#ifndef DURABILITYPROFILE_H
+#define DURABILITYPROFILE_H
+
+#include <QString>
+#include <optional>
+
+/**
+ * @brief The DurabilityProfile enum contains the trade-offs between durability and speed that
+ *        a database connection can be opened with.
+ *        Safe syncs every commit, Balanced may lose the last commits on power loss but never
+ *        corrupts the file, and Fast leaves syncing to the operating system.
+ */
+enum class DurabilityProfile : int { Safe, Balanced, Fast };
+
+/**
+ * @brief The CheckpointMode enum contains the ways a WAL checkpoint can run.
+ *        Passive copies what it can without waiting for readers; Truncate waits for them and
+ *        empties the WAL file.
+ */
+enum class CheckpointMode : int { Passive, Full, Restart, Truncate };
+
+/**
+ * @brief The DurabilitySettings struct holds the SQLite settings applied to each connection.
+ */
+struct DurabilitySettings
+{
+    QString journalMode = "WAL";       // PRAGMA journal_mode.
+    int synchronous = 1;               // PRAGMA synchronous: 0 OFF, 1 NORMAL, 2 FULL, 3 EXTRA.
+    int cacheSizeKiB = 16384;          // Page cache per connection, in KiB.
+    qint64 mmapSize = 67108864;        // Bytes of the file read through memory mapping.
+    int tempStore = 2;                 // PRAGMA temp_store: 0 DEFAULT, 1 FILE, 2 MEMORY.
+    int busyTimeout = 5000;            // Milliseconds to wait for another connection's lock.
+    int walAutoCheckpoint = 1000;      // WAL pages written before SQLite checkpoints itself.
+    int checkpointInterval = 60000;    // Milliseconds between periodic checkpoints; 0 for none.
+
+    // Settings of a profile.
+    static DurabilitySettings forProfile(DurabilityProfile profile);
+
+    // Profile by its name ("safe", "balanced" or "fast"); std::nullopt if there is none.
+    static std::optional<DurabilityProfile> profileFromName(const QString &name);
+
+    // Name of the synchronous level.
+    QString synchronousName() const;
+};
+
+#endif // DURABILITYPROFILE_H
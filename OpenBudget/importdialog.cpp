@@ -0,0 +1,196 @@
+#include "importdialog.h"
+#include <QFileDialog>
+#include <QMessageBox>
+#include "categorymodel.h"
+#include "session.h"
+
+/**
+ * @brief Allows the logged in user to import a bank statement into their transactions.
+ * 
+ * @param parent Pointer to the parent widget.
+ */
+ImportDialog::ImportDialog(QWidget *parent)
+    : QDialog{parent}
+    , m_userID{Session::getInstance()->userID()}
+{
+    setWindowTitle("Import Statement");
+
+    // Create main layout
+    QVBoxLayout *mainLayout = new QVBoxLayout();
+
+    // Statement Group Box
+    QGroupBox *groupBox = new QGroupBox("Statement");
+    QFormLayout *formLayout = new QFormLayout();
+
+    // File chooser
+    QHBoxLayout *fileLayout = new QHBoxLayout();
+    fileLineEdit = new QLineEdit();
+    fileLineEdit->setPlaceholderText("CSV, OFX, QFX or QIF file");
+    QPushButton *browseButton = new QPushButton("Browse...");
+    fileLayout->addWidget(fileLineEdit);
+    fileLayout->addWidget(browseButton);
+
+    // Category for transactions that match no category
+    categoryCombo = new QComboBox();
+    categoryCombo->setModel(
+        CategoryModel::withPlaceholders(m_userID, {{"Select a category", -1}}, this));
+
+    // Progress of the import
+    progressLabel = new QLabel();
+
+    // Add widgets to the form layout
+    formLayout->addRow("File:", fileLayout);
+    formLayout->addRow("Uncategorized:", categoryCombo);
+    formLayout->addRow(progressLabel);
+
+    // Set layout for the group box
+    groupBox->setLayout(formLayout);
+
+    // Button Box
+    QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok
+                                                       | QDialogButtonBox::Cancel);
+    importButton = buttonBox->button(QDialogButtonBox::Ok);
+
+    // Set the text for the import button
+    importButton->setText("Import");
+
+    // Disable the import button until a file and category are chosen
+    importButton->setEnabled(false);
+
+    // Choose a file when the browse button is clicked
+    connect(browseButton, &QPushButton::clicked, this, &ImportDialog::chooseFile);
+    // Import the statement when the import button is clicked
+    connect(importButton, &QPushButton::clicked, this, &ImportDialog::startImport);
+    // Enable the import button when a file and category are chosen
+    connect(fileLineEdit, &QLineEdit::textChanged, this, &ImportDialog::enableImportButton);
+    connect(categoryCombo,
+            QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this,
+            &ImportDialog::enableImportButton);
+    // Stop the import or close the dialog when the cancel button is clicked
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &ImportDialog::cancelImport);
+
+    // Add the group box and button box to the main layout
+    mainLayout->addWidget(groupBox);
+    mainLayout->addWidget(buttonBox);
+
+    // Set the main layout for the dialog
+    setLayout(mainLayout);
+}
+
+/**
+ * @brief Lets the user choose the statement to import.
+ */
+void ImportDialog::chooseFile()
+{
+    QString fileName = QFileDialog::getOpenFileName(this,
+                                                    "Choose Statement",
+                                                    QString(),
+                                                    "Statements (*.csv *.ofx *.qfx *.qif)");
+    if (!fileName.isEmpty()) {
+        fileLineEdit->setText(fileName);
+    }
+}
+
+/**
+ * @brief Starts importing the chosen statement.
+ */
+void ImportDialog::startImport()
+{
+    // Disable the form until the import has finished
+    importButton->setEnabled(false);
+    fileLineEdit->setEnabled(false);
+    categoryCombo->setEnabled(false);
+    progressLabel->setText("Importing...");
+
+    // Start the import
+    m_importer = new StatementImporter(m_userID, categoryCombo->currentData().toInt(), this);
+    connect(m_importer, &StatementImporter::progress, this, &ImportDialog::showProgress);
+    connect(m_importer, &StatementImporter::finished, this, &ImportDialog::importFinished);
+    m_importer->start(fileLineEdit->text());
+}
+
+/**
+ * @brief Stops the running import, or closes the dialog if there is none.
+ */
+void ImportDialog::cancelImport()
+{
+    if (m_importer) {
+        // The summary is shown once the stages have stopped
+        progressLabel->setText("Canceling...");
+        m_importer->cancel();
+        return;
+    }
+
+    // Close the dialog
+    reject();
+}
+
+/**
+ * @brief Enables the import button if a file and a category are chosen.
+ */
+void ImportDialog::enableImportButton()
+{
+    importButton->setEnabled(!m_importer && !fileLineEdit->text().isEmpty()
+                             && categoryCombo->currentData().toInt() > 0);
+}
+
+/**
+ * @brief Shows how far the import has got.
+ * 
+ * @param rowsRead Number of records read from the statement.
+ * @param rowsInserted Number of transactions added.
+ * @param rowsPerSecond Records read per second.
+ */
+void ImportDialog::showProgress(qint64 rowsRead, qint64 rowsInserted, double rowsPerSecond)
+{
+    progressLabel->setText(QString("Read %1 rows, added %2 (%3 rows/s)")
+                               .arg(rowsRead)
+                               .arg(rowsInserted)
+                               .arg(qRound64(rowsPerSecond)));
+}
+
+/**
+ * @brief Shows the summary of the finished import.
+ * 
+ * @param summary The outcome of the import.
+ */
+void ImportDialog::importFinished(const ImportSummary &summary)
+{
+    // The importer's stages have all stopped
+    m_importer->deleteLater();
+    m_importer = nullptr;
+
+    // Reload the transactions if any were added
+    if (summary.rowsInserted > 0) {
+        emit transactionsImported();
+    }
+
+    // Describe the import
+    QString message = QString("Read %1 rows in %2 seconds (%3 rows/s).\n"
+                              "Added %4 transactions, skipped %5 duplicates and %6 invalid rows.")
+                          .arg(summary.rowsRead)
+                          .arg(summary.seconds, 0, 'f', 1)
+                          .arg(qRound64(summary.rowsPerSecond))
+                          .arg(summary.rowsInserted)
+                          .arg(summary.duplicates)
+                          .arg(summary.rejected);
+    // List the first few problems
+    if (!summary.errors.isEmpty()) {
+        message += "\n\n" + summary.errors.mid(0, 10).join('\n');
+        if (summary.errors.size() > 10) {
+            message += "\n...";
+        }
+    }
+
+    if (summary.canceled) {
+        QMessageBox::warning(this, "Import Canceled", message);
+    } else if (summary.rowsInserted == 0 && !summary.errors.isEmpty()) {
+        QMessageBox::critical(this, "Import Failed", message);
+    } else {
+        QMessageBox::information(this, "Import Finished", message);
+    }
+
+    // Close the dialog
+    accept();
+}
@@ -0,0 +1,46 @@
+#ifndef IMPORTDIALOG_H
+#define IMPORTDIALOG_H
+
+#include <QComboBox>
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QGroupBox>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QVBoxLayout>
+#include "statementimporter.h"
+
+class ImportDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    ImportDialog(QWidget *parent = nullptr);
+
+signals:
+    void transactionsImported(); // Signal to indicate that transactions have been imported.
+
+private slots:
+    void chooseFile();         // Choose the statement to import.
+    void startImport();        // Import the statement when the import button is clicked.
+    void cancelImport();       // Stop the import, or close the dialog if none is running.
+    void enableImportButton(); // Enable the import button when a file and category are chosen.
+    void showProgress(qint64 rowsRead, qint64 rowsInserted, double rowsPerSecond);
+    void importFinished(const ImportSummary &summary); // Show the import's summary.
+
+private:
+    QLineEdit *fileLineEdit = nullptr;
+    QComboBox *categoryCombo = nullptr;
+    QLabel *progressLabel = nullptr;
+    QPushButton *importButton = nullptr;
+
+    StatementImporter *m_importer = nullptr; // The running import, if any.
+
+private:
+    int m_userID;
+};
+
+#endif // IMPORTDIALOG_H
@@ -1,14 +1,19 @@
 #include "linechartdialog.h"
+#include "asyncdatabase.h"
+#include "downsampler.h"
+#include "session.h"
 
 /**
- * @brief Displays a line chart of the transaction data the user was currently viewing.
+ * @brief Displays a line chart of the transaction data the logged in user was viewing.
+ * @param categoryID The ID of the category being viewed; -1 for every category.
+ * @param currentCategory The name of the category being viewed.
  * @param parent The parent widget.
- * @param transactionTableWidget The transaction table containing the data to chart.
  */
-LineChartDialog::LineChartDialog(QTableWidget *transactionTableWidget,
-                                 QString currentCategory,
-                                 QWidget *parent)
+LineChartDialog::LineChartDialog(int categoryID, QString currentCategory, QWidget *parent)
     : QDialog{parent}
+    , m_userID{Session::getInstance()->userID()}
+    , m_categoryID{categoryID}
+    , m_title{currentCategory + ": Balance Over Time Chart"}
 {
     setWindowTitle("Transaction Data Analysis");
 
@@ -23,31 +28,14 @@ LineChartDialog::LineChartDialog(QTableWidget *transactionTableWidget,
     // Create a line series for the data
     lineSeries = new QLineSeries();
 
-    // Calculate column numbers for date and balance
-    int dateColumn = 0;
-    int balanceColumn = transactionTableWidget->columnCount() - 2;
-    // Iterate over transactionTableWidget rows and add data to the line series
-    for (int row = 0; row < transactionTableWidget->rowCount(); ++row) {
-        // Extract the date and balance from the table
-        QTableWidgetItem *dateItem = transactionTableWidget->item(row, dateColumn);
-        QTableWidgetItem *balanceItem = transactionTableWidget->item(row, balanceColumn);
-        // If the date and balance are not NULL
-        if (dateItem && balanceItem) {
-            // Convert the date string to a QDateTime object
-            QDateTime date = QDateTime::fromString(dateItem->text(),
-                                                   "MM/dd/yyyy"); // Adjust the date format as needed
-            // Convert the balance string to a double
-            double balance = balanceItem->text().toDouble();
-            // Add the date and balance to the line series
-            lineSeries->append(date.toMSecsSinceEpoch(), balance);
-        }
-    }
+    // Zoom into a range of dates by dragging over it
+    chartView->setRubberBand(QChartView::HorizontalRubberBand);
 
     // Set up the chart axes
-    QDateTimeAxis *dateAxis = new QDateTimeAxis;
+    dateAxis = new QDateTimeAxis;
     dateAxis->setFormat("MM/dd"); // Customize the date format as needed
     dateAxis->setTitleText("Date");
-    QValueAxis *balanceAxis = new QValueAxis;
+    balanceAxis = new QValueAxis;
     balanceAxis->setTitleText("Balance");
 
     // Add axes to the chart
@@ -59,12 +47,250 @@ LineChartDialog::LineChartDialog(QTableWidget *transactionTableWidget,
     lineSeries->attachAxis(dateAxis);
     lineSeries->attachAxis(balanceAxis);
 
-    // Set the chart title
-    chart->setTitle(currentCategory + ": Balance Over Time Chart");
+    // Show a placeholder title until the first series is built
+    chart->setTitle(m_title + " (Loading...)");
 
     // Set up the layout
     QVBoxLayout *mainLayout = new QVBoxLayout();
     mainLayout->addWidget(chartView);
 
     setLayout(mainLayout);
+
+    // Read the balances once the user stops zooming, and once the dialog is laid out.
+    reloadTimer = new QTimer(this);
+    reloadTimer->setSingleShot(true);
+    reloadTimer->setInterval(RELOAD_DELAY);
+    connect(reloadTimer, &QTimer::timeout, this, &LineChartDialog::loadVisibleRange);
+    reloadTimer->start();
+
+    // Read the balances of the dates zoomed into.
+    connect(dateAxis, &QDateTimeAxis::rangeChanged, this, &LineChartDialog::dateRangeChanged);
+    // Keep the chart up to date as transactions are added and deleted.
+    connect(ChangeNotifier::getInstance(),
+            &ChangeNotifier::ledgerChanged,
+            this,
+            &LineChartDialog::applyChange);
+}
+
+/**
+ * @brief Stops building a series nobody will see.
+ */
+LineChartDialog::~LineChartDialog()
+{
+    m_latestRequest->fetchAndAddRelaxed(1);
+    m_pending.cancel();
+}
+
+/**
+ * @brief Starts building the series of the visible dates on a reader thread.
+ *        The request in flight is canceled: skipped if it has not started, and stopped at its
+ *        next step if it has. The dialog stays responsive and shows the current series until
+ *        the new one is ready.
+ */
+void LineChartDialog::loadVisibleRange()
+{
+    // Cancel the request in flight.
+    int generation = m_latestRequest->fetchAndAddRelaxed(1) + 1;
+    m_pending.cancel();
+
+    // Build the series with a reader's connection, so it does not wait behind writes.
+    SeriesRequest request{m_userID, m_categoryID, m_from, m_to, pointBudget(), generation};
+    std::shared_ptr<QAtomicInt> latest = m_latestRequest;
+    AsyncDatabase *db = AsyncDatabase::getInstance();
+    m_pending = db->read([request, latest](Database &db) {
+        return buildSeries(db, request, *latest);
+    });
+
+    // Chart the series unless a newer request was made meanwhile.
+    m_pending.then(this, [this, generation](const SeriesPoints &points) {
+        if (points && generation == m_latestRequest->loadRelaxed()) {
+            showSeries(*points);
+        }
+    });
+}
+
+/**
+ * @brief Charts a built series, handing the series all of its points at once.
+ * @param points The points, in date order.
+ */
+void LineChartDialog::showSeries(const QList<QPointF> &points)
+{
+    // Replace the series with the points.
+    chart->setTitle(m_title);
+    lineSeries->replace(points);
+    if (points.isEmpty()) {
+        return;
+    }
+
+    // Fit the balance axis to the balances, and the date axis when the whole ledger is shown.
+    double minBalance = points.constFirst().y();
+    double maxBalance = minBalance;
+    for (const QPointF &point : points) {
+        minBalance = qMin(minBalance, point.y());
+        maxBalance = qMax(maxBalance, point.y());
+    }
+    m_settingAxes = true;
+    if (!m_from.isValid()) {
+        dateAxis->setRange(QDateTime::fromMSecsSinceEpoch(qint64(points.constFirst().x())),
+                           QDateTime::fromMSecsSinceEpoch(qint64(points.constLast().x())));
+    }
+    balanceAxis->setRange(minBalance, maxBalance);
+    m_settingAxes = false;
+}
+
+/**
+ * @brief Reads the balances of the new date range once the user stops zooming.
+ * @param min The first visible date and time.
+ * @param max The last visible date and time.
+ */
+void LineChartDialog::dateRangeChanged(const QDateTime &min, const QDateTime &max)
+{
+    // Ranges set to fit the data are already read.
+    if (m_settingAxes) {
+        return;
+    }
+
+    m_from = min.date();
+    m_to = max.date();
+    reloadTimer->start();
+}
+
+/**
+ * @brief Reads the visible balances again after transactions of the charted user are inserted
+ *        or deleted. A change moves the balance of every later transaction, and the series only
+ *        holds a sample of the transactions, so the visible range is read again.
+ * @param change The changes.
+ */
+void LineChartDialog::applyChange(const LedgerChange &change)
+{
+    if (change.userID == m_userID) {
+        reloadTimer->start();
+    }
+}
+
+/**
+ * @brief Gets the number of points a series is reduced to: one per pixel of the plot's width.
+ *        Before the dialog is laid out, the width of the view stands in for the plot's.
+ * @return The number of points.
+ */
+int LineChartDialog::pointBudget() const
+{
+    int width = int(chart->plotArea().width());
+    if (width <= 0) {
+        width = chartView->width();
+    }
+
+    return qMax(MIN_POINTS, width);
+}
+
+/**
+ * @brief Builds the series of a range of dates; runs on the database thread.
+ *        Ranges where a day gets a few pixels are read transaction by transaction and reduced
+ *        to about one point per pixel. Wider ranges of the whole ledger are read from the
+ *        balance pyramid level with about one bucket per pixel, so the rows read depend on the
+ *        width of the plot rather than on the number of transactions. Between steps the
+ *        request gives up if a newer one was made.
+ * @param db The database thread's connection.
+ * @param request The dates and resolution to build.
+ * @param latest The generation of the newest request.
+ * @return The points in date order; std::nullopt if the request was canceled.
+ */
+LineChartDialog::SeriesPoints LineChartDialog::buildSeries(Database &db,
+                                                           const SeriesRequest &request,
+                                                           const QAtomicInt &latest)
+{
+    // Whether a newer request replaced this one.
+    auto canceled = [&]() { return latest.loadRelaxed() != request.generation; };
+
+    // The whole ledger spans from its first transaction to its last.
+    QDate from = request.from;
+    QDate to = request.to;
+    if (!from.isValid() && request.categoryID == -1) {
+        QPair<QDate, QDate> span = db.getLedgerSpan(request.userID);
+        from = span.first;
+        to = span.second;
+    }
+
+    // Read the buckets of wide ranges; the pyramid holds the balances over every category.
+    if (request.categoryID == -1 && from.isValid()
+        && from.daysTo(to) + 1 > request.budget / POINTS_PER_BUCKET) {
+        PyramidLevel level = BalancePyramid::levelFor(from, to, request.budget);
+        QVector<BalanceBucket> buckets = db.getBalancePyramid(request.userID, level, from, to);
+        if (canceled()) {
+            return std::nullopt;
+        }
+        return bucketPoints(buckets, level);
+    }
+
+    // Read the transactions of narrower ranges.
+    QVector<BalancePoint> balances = db.getBalanceHistory(request.userID,
+                                                          request.categoryID,
+                                                          request.from,
+                                                          request.to);
+    if (canceled()) {
+        return std::nullopt;
+    }
+
+    // Reduce them to the plot's resolution.
+    QList<QPointF> points;
+    points.reserve(balances.size());
+    for (const BalancePoint &balance : std::as_const(balances)) {
+        points.append(seriesPoint(balance.position.date, balance.balance));
+    }
+    if (canceled()) {
+        return std::nullopt;
+    }
+
+    return Downsampler::lttb(points, request.budget);
+}
+
+/**
+ * @brief Builds the series points of balance pyramid buckets.
+ *        Each bucket is drawn from its open through its low and high to its close, so the line
+ *        covers every balance in the bucket; the extreme reached first is guessed from the
+ *        direction the balance moved.
+ * @param buckets The buckets, in date order.
+ * @param level The level of the buckets.
+ * @return Up to POINTS_PER_BUCKET points per bucket, in date order.
+ */
+QList<QPointF> LineChartDialog::bucketPoints(const QVector<BalanceBucket> &buckets,
+                                             PyramidLevel level)
+{
+    QList<QPointF> points;
+    points.reserve(buckets.size() * POINTS_PER_BUCKET);
+
+    for (const BalanceBucket &bucket : buckets) {
+        // Spread the points over the bucket's dates.
+        double start = bucket.start.startOfDay().toMSecsSinceEpoch();
+        double length = BalancePyramid::nextBucketStart(bucket.start, level)
+                            .startOfDay()
+                            .toMSecsSinceEpoch()
+                        - start;
+        double open = bucket.open.toDouble();
+        double close = bucket.close.toDouble();
+        bool falling = close < open;
+
+        points.append(QPointF(start, open));
+        // A single transaction has nothing between its open and close.
+        if (bucket.count > 1) {
+            points.append(QPointF(start + length / 3,
+                                  falling ? bucket.high.toDouble() : bucket.low.toDouble()));
+            points.append(QPointF(start + length * 2 / 3,
+                                  falling ? bucket.low.toDouble() : bucket.high.toDouble()));
+            points.append(QPointF(start + length * 0.9, close));
+        }
+    }
+
+    return points;
+}
+
+/**
+ * @brief Builds the series point of a transaction.
+ * @param date The date of the transaction.
+ * @param balance The balance after the transaction.
+ * @return The point; x is the date in milliseconds since the epoch.
+ */
+QPointF LineChartDialog::seriesPoint(const QDate &date, Money balance)
+{
+    return QPointF(date.startOfDay().toMSecsSinceEpoch(), balance.toDouble());
 }
@@ -1,24 +1,93 @@
+#include <QAtomicInt>
 #include <QDateTime>
 #include <QDialog>
-#include <QTableWidget>
+#include <QFuture>
+#include <QTimer>
 #include <QVBoxLayout>
 #include <QtCharts/QChart>
 #include <QtCharts/QChartView>
 #include <QtCharts/QDateTimeAxis>
 #include <QtCharts/QLineSeries>
 #include <QtCharts/QValueAxis>
+#include <memory>
+#include <optional>
+#include "changenotifier.h"
+#include "database.h"
 
 class LineChartDialog : public QDialog
 {
     Q_OBJECT
 
 public:
-    LineChartDialog(QTableWidget *transactionTableWidget,
-                    QString currentCategory = "",
-                    QWidget *parent = nullptr);
+    LineChartDialog(int categoryID = -1, QString currentCategory = "", QWidget *parent = nullptr);
+    ~LineChartDialog();
 
 private:
+    // Fewest points a series is reduced to, whatever the width of the plot.
+    static constexpr int MIN_POINTS = 100;
+
+    // Most series points drawn for a bucket of the balance pyramid.
+    static constexpr int POINTS_PER_BUCKET = 4;
+
+    // Milliseconds to wait after zooming or a ledger change before reading the balances.
+    static constexpr int RELOAD_DELAY = 100;
+
+    // The series to build for the visible dates.
+    struct SeriesRequest
+    {
+        int userID;
+        int categoryID;
+        QDate from;     // First visible date; invalid for the whole ledger.
+        QDate to;       // Last visible date; invalid for the whole ledger.
+        int budget;     // Number of points the series is reduced to.
+        int generation; // Identifies the request; a newer one cancels it.
+    };
+
+    // Points of a built series; std::nullopt if a newer request canceled it.
+    using SeriesPoints = std::optional<QList<QPointF>>;
+
+    // Start building the series of the visible dates on the database thread.
+    void loadVisibleRange();
+
+    // Chart a built series.
+    void showSeries(const QList<QPointF> &points);
+
+    // Follow the date axis as the user zooms.
+    void dateRangeChanged(const QDateTime &min, const QDateTime &max);
+
+    // Read the visible balances again after transactions are inserted or deleted.
+    void applyChange(const LedgerChange &change);
+
+    // Get the number of points the series is reduced to.
+    int pointBudget() const;
+
+    // Build a series with the database thread's connection; stops once latest moves on.
+    static SeriesPoints buildSeries(Database &db,
+                                    const SeriesRequest &request,
+                                    const QAtomicInt &latest);
+
+    // Get the series points of balance pyramid buckets.
+    static QList<QPointF> bucketPoints(const QVector<BalanceBucket> &buckets, PyramidLevel level);
+
+    // Get the series point of a transaction.
+    static QPointF seriesPoint(const QDate &date, Money balance);
+
+private:
+    int m_userID;
+    int m_categoryID;
+    QString m_title;            // The chart's title once the series is shown.
+    QDate m_from;               // First visible date; invalid when the whole ledger is shown.
+    QDate m_to;                 // Last visible date; invalid when the whole ledger is shown.
+    bool m_settingAxes = false; // Whether the axes are being fitted to the data.
+
+    // Generation of the newest request, shared with the series being built.
+    std::shared_ptr<QAtomicInt> m_latestRequest = std::make_shared<QAtomicInt>(0);
+    QFuture<SeriesPoints> m_pending; // The series being built.
+
     QChart *chart = nullptr;
     QChartView *chartView = nullptr;
     QLineSeries *lineSeries = nullptr;
+    QDateTimeAxis *dateAxis = nullptr;
+    QValueAxis *balanceAxis = nullptr;
+    QTimer *reloadTimer = nullptr;
 };
@@ -4,10 +4,9 @@
 #include <QSqlQuery>
 #include <QVBoxLayout>
 #include <QtWidgets>
-#include "database.h"
+#include "asyncdatabase.h"
 #include "linkbutton.h"
-#include "user.h"
-#include "userlogin.h"
+#include "session.h"
 
 /**
  * @brief Dialog that allows users to login to their account.
@@ -75,6 +74,9 @@ LoginDialog::LoginDialog(QWidget *parent)
 
 /**
  * @brief Attempt to log the user in when the login button is clicked.
+ *        The login and profile are read together on the database thread and the password is
+ *        checked on a thread pool thread, so the dialog stays responsive while the password is
+ *        hashed and the database is queried once.
  */
 void LoginDialog::loginButtonClicked()
 {
@@ -82,42 +84,77 @@ void LoginDialog::loginButtonClicked()
     QString enteredUsername = usernameLineEdit->text();
     QString enteredPassword = passwordLineEdit->text();
 
-    // Get database instance.
-    Database *db = Database::getInstance();
-    UserLogin *userLogin = db->getUserLogin(enteredUsername);
-
-    // If login exists and password matches.
-    if (userLogin != nullptr) {
-        if (userLogin->checkPassword(enteredPassword)) {
-            // Get the user from the database.
-            User *user = db->getUser(userLogin->userID());
-            // If user exists, login.
-            if (user) {
-                // Hide the login window.
-                hide();
-                // Emit the userLoggedInSignal and show main window.
-                emit userLoggedInSignal(user);
+    // Disable the login button until the login attempt has finished.
+    loginButton->setEnabled(false);
+
+    // Look up the account on the database thread.
+    AsyncDatabase *db = AsyncDatabase::getInstance();
+    db->authenticate(enteredUsername)
+        .then(this, [this, enteredPassword](const std::optional<Account> &account) {
+            // If the account does not exist, there is no password to check.
+            if (!account) {
+                // Create a message box to display the query error message.
+                QMessageBox::critical(this,
+                                      tr("Error"),
+                                      tr("Username does not exist! "
+                                         "Please try again."));
+                // Clear the line edits.
+                usernameLineEdit->clear();
+                passwordLineEdit->clear();
+                return;
             }
-        } else {
-            // Create a message box to display the query error message.
-            QMessageBox::information(this,
-                                     tr("Login Failed"),
-                                     tr("Username & Password combination not found. "
-                                        "Please try again."));
-            // Clear the line edits.
-            usernameLineEdit->clear();
-            passwordLineEdit->clear();
-        }
-    } else {
+
+            // Check the password off the GUI thread.
+            PasswordHasher::checkLater(enteredPassword,
+                                       account->login.password(),
+                                       account->user.userID())
+                .then(this, [this, found = *account](const PasswordCheck &check) {
+                    passwordChecked(found, check);
+                });
+        });
+}
+
+/**
+ * @brief Logs the user in once their password has been checked, starting their session with
+ *        the account read to check it.
+ *        A weaker stored hash, such as a legacy MD5 one, is replaced by the new hash computed
+ *        during the check.
+ * 
+ * @param account The login and profile of the user.
+ * @param check The outcome of the check.
+ */
+void LoginDialog::passwordChecked(const Account &account, const PasswordCheck &check)
+{
+    // Allow another attempt.
+    enableLoginButton();
+
+    // If the password does not match, let the user try again.
+    if (!check.matches) {
         // Create a message box to display the query error message.
-        QMessageBox::critical(this,
-                              tr("Error"),
-                              tr("Username does not exist! "
-                                 "Please try again."));
+        QMessageBox::information(this,
+                                 tr("Login Failed"),
+                                 tr("Username & Password combination not found. "
+                                    "Please try again."));
         // Clear the line edits.
         usernameLineEdit->clear();
         passwordLineEdit->clear();
+        return;
+    }
+
+    // Store the upgraded hash; logging in does not wait for it.
+    if (!check.rehashed.isEmpty()) {
+        int userID = account.user.userID();
+        QString hash = check.rehashed;
+        AsyncDatabase::getInstance()->run(
+            [userID, hash](Database &db) { return db.updatePasswordHash(userID, hash); });
     }
+
+    // Start the user's session.
+    Session::getInstance()->start(account.user, account.login);
+    // Hide the login window.
+    hide();
+    // Emit the userLoggedInSignal and show main window.
+    emit userLoggedInSignal();
 }
 
 /**
@@ -5,11 +5,12 @@
 #include <QLineEdit>
 #include <QMainWindow>
 #include <QPushButton>
+#include "database.h"
 #include "linkbutton.h"
 #include "registerdialog.h"
 //#include "loginsuccessdialog.h"
+#include "passwordhasher.h"
 #include "passwordresetdialog.h"
-#include "user.h"
 
 class LoginDialog : public QDialog
 {
@@ -19,7 +20,7 @@ public:
     LoginDialog(QWidget *parent); // Constructor.
 
 signals:
-    void userLoggedInSignal(User *user); // Signal to indicate that the user has logged in.
+    void userLoggedInSignal(); // Signal to indicate that the user has logged in; see Session.
 
 private slots:
     void loginButtonClicked();          // When login button is clicked.
@@ -31,6 +32,9 @@ private slots:
     void registerDialogClosed(); // When register dialog is closed.
 
 private:
+    // Log the user in once their password has been checked.
+    void passwordChecked(const Account &account, const PasswordCheck &check);
+
     QLineEdit *usernameLineEdit = nullptr;                 // Username line edit.
     QLineEdit *passwordLineEdit = nullptr;                 // Password line edit.
     QPushButton *loginButton = nullptr;                    // Login button.
@@ -1,9 +1,69 @@
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QSettings>
+#include "database.h"
 #include "mainwindow.h"
+#include "passwordhasher.h"
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
+
+    // Read the command line options.
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption durabilityOption("durability",
+                                        "Database durability profile: safe, balanced or fast.",
+                                        "profile",
+                                        "balanced");
+    parser.addOption(durabilityOption);
+    QCommandLineOption iterationsOption("kdf-iterations",
+                                        "PBKDF2 iterations for new password hashes; calibrated "
+                                        "to the host on first launch if not given.",
+                                        "count");
+    parser.addOption(iterationsOption);
+    QCommandLineOption benchmarkOption("benchmark-kdf",
+                                       "Calibrate password hashing again, report hashes per "
+                                       "second and exit.");
+    parser.addOption(benchmarkOption);
+    parser.process(a);
+
+    // Choose the cost of new password hashes: the given count, else the count calibrated on an
+    // earlier launch. Calibrating takes a visible moment, so it only runs when neither exists
+    // or a benchmark asks for it, and its result is kept.
+    QSettings settings("OpenBudget", "OpenBudget");
+    bool validIterations = false;
+    int iterations = parser.value(iterationsOption).toInt(&validIterations);
+    if (!validIterations && !parser.isSet(benchmarkOption)) {
+        iterations = settings.value("kdf/iterations").toInt(&validIterations);
+    }
+    if (!validIterations) {
+        iterations = PasswordHasher::calibrate();
+        settings.setValue("kdf/iterations", iterations);
+    }
+    PasswordHasher::setIterations(iterations);
+
+    // Report the cost of password hashing on this host.
+    if (parser.isSet(benchmarkOption)) {
+        qInfo().noquote() << QString("PBKDF2-HMAC-SHA256: %1 iterations for a %2 ms target, "
+                                     "%3 hashes per second")
+                                 .arg(PasswordHasher::iterations())
+                                 .arg(PasswordHasher::TARGET_MILLISECONDS)
+                                 .arg(PasswordHasher::benchmark(), 0, 'f', 2);
+        return 0;
+    }
+
+    // Choose the durability profile before the database is opened.
+    std::optional<DurabilityProfile> profile = DurabilitySettings::profileFromName(
+        parser.value(durabilityOption));
+    if (profile) {
+        Database::setDurabilitySettings(DurabilitySettings::forProfile(*profile));
+    } else {
+        qWarning() << "Unknown durability profile" << parser.value(durabilityOption)
+                   << "; using balanced";
+    }
+
     MainWindow mainWindow;
     return a.exec();
 }
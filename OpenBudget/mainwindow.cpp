@@ -4,9 +4,10 @@
 #include <QHeaderView>
 #include <QSqlError>
 #include <QSqlQuery>
-#include "database.h"
+#include "currencydelegate.h"
+#include "categorymodel.h"
 #include "logindialog.h"
-#include "user.h"
+#include "session.h"
 
 /**
  * @brief Main window show's the user's transactions.
@@ -47,25 +48,33 @@ MainWindow::MainWindow(QWidget *parent)
     connect(addTransactionButton, &QPushButton::clicked, this, &MainWindow::addTransaction);
     // If the delete transaction button is clicked, delete a transaction from the database.
     connect(deleteTransactionButton, &QPushButton::clicked, this, &MainWindow::deleteTransaction);
+    // If the search text changes, search once the user pauses typing.
+    connect(searchLineEdit, &QLineEdit::textChanged, searchTimer, qOverload<>(&QTimer::start));
+    connect(searchTimer, &QTimer::timeout, this, &MainWindow::searchTransactions);
+    // If the import button is clicked, show the import dialog.
+    connect(importButton, &QPushButton::clicked, this, &MainWindow::importStatement);
     // If the line chart button is clicked, show the line chart dialog.
     connect(lineChartButton, &QPushButton::clicked, this, &MainWindow::viewLineChart);
+    // If the budgets button is clicked, show the budget dialog.
+    connect(budgetButton, &QPushButton::clicked, this, &MainWindow::viewBudgets);
 }
 
 /**
  * @brief Show the main window when the user has successfully logged in.
- * 
- * @param user Pointer to the user object.
+ *        The user is read from their session.
  */
-void MainWindow::showMainWindow(User *user)
+void MainWindow::showMainWindow()
 {
     // Set the welcome label.
-    welcomeLabel->setText("Welcome, " + user->firstName() + " " + user->lastName() + "!");
-    // Store the user info of the logged in user.
-    m_user = user;
+    const User &user = Session::getInstance()->user();
+    welcomeLabel->setText("Welcome, " + user.firstName() + " " + user.lastName() + "!");
     // Load transactions.
     loadTransactions();
-    // Load categories.
-    loadCategories();
+    // Show the user's categories after the all categories and Deposit options.
+    categoryCombo->setModel(CategoryModel::withPlaceholders(user.userID(),
+                                                            {{"All Categories", -1},
+                                                             {"Deposit", 0}},
+                                                            this));
     // Show the main window.
     show();
 }
@@ -76,11 +85,9 @@ void MainWindow::showMainWindow(User *user)
 void MainWindow::addCategory()
 {
     // Create an add category dialog.
-    addCategoryDialog = new AddCategoryDialog(m_user->userID(), this);
+    addCategoryDialog = new AddCategoryDialog(this);
     // Show the add category dialog.
     addCategoryDialog->show();
-    // If the add category dialog is accepted, load categories.
-    connect(addCategoryDialog, &AddCategoryDialog::accepted, this, &MainWindow::loadCategories);
     // If the add category dialog is rejected, delete the dialog.
     connect(addCategoryDialog,
             &AddCategoryDialog::rejected,
@@ -94,14 +101,9 @@ void MainWindow::addCategory()
 void MainWindow::addSubcategory()
 {
     // Create an add subcategory dialog.
-    addSubcategoryDialog = new AddSubcategoryDialog(m_user->userID(), this);
+    addSubcategoryDialog = new AddSubcategoryDialog(this);
     // Show the add subcategory dialog.
     addSubcategoryDialog->show();
-    // If the add subcategory dialog is accepted, load categories.
-    connect(addSubcategoryDialog,
-            &AddSubcategoryDialog::accepted,
-            this,
-            &MainWindow::loadCategories);
     // If the add subcategory dialog is rejected, delete the dialog.
     connect(addSubcategoryDialog,
             &AddSubcategoryDialog::rejected,
@@ -110,71 +112,14 @@ void MainWindow::addSubcategory()
 }
 
 /**
- * @brief Retrieve all of the user's transactions from the database and populate the table widget.
+ * @brief Retrieve all of the user's transactions from the database and show them in the table.
  */
 void MainWindow::loadTransactions()
 {
-    // Get database instance.
-    Database *db = Database::getInstance();
-
-    // Get the list of transactions.
-    QVector<Transaction *> transactions = db->getTransactions(m_user->userID());
-    // Clear the table.
-    transactionTableWidget->clearContents();
-    // Set the number of columns in the table widget.
-    transactionTableWidget->setColumnCount(7);
-    // Set the final column to be hidden from user.
-    transactionTableWidget->setColumnHidden(5, false);
-    transactionTableWidget->setColumnHidden(6, true);
-    // Set the table headers.
-    transactionTableWidget->setHorizontalHeaderLabels(
-        {"Date", "Description", "Category", "Subcategory", "Amount", "Balance"});
-    // Set the number of rows.
-    transactionTableWidget->setRowCount(transactions.size());
-
-    // Get the category names.
-    QMap<int, QString> categoryNames = db->getCategoryNames(m_user->userID());
-
-    // Populate the table.
-    for (int i = 0; i < transactions.size(); i++) {
-        // Get the current transaction.
-        Transaction *transaction = transactions.at(i);
-
-        // Set the transaction date.
-        QTableWidgetItem *dateItem = new QTableWidgetItem(transaction->date());
-        transactionTableWidget->setItem(i, 0, dateItem);
-
-        // Set the transaction description.
-        QTableWidgetItem *descriptionItem = new QTableWidgetItem(transaction->description());
-        transactionTableWidget->setItem(i, 1, descriptionItem);
-
-        // Set the transaction category name.
-        QTableWidgetItem *categoryItem = new QTableWidgetItem(
-            categoryNames[transaction->categoryID()]);
-        transactionTableWidget->setItem(i, 2, categoryItem);
-
-        // Get the subcategory name.
-        QString subcategoryName = db->getSubcategoryName(transaction->categoryID(),
-                                                         transaction->subcategoryID());
-        // Set the transaction subcategory name.
-        QTableWidgetItem *subcategoryItem = new QTableWidgetItem(subcategoryName);
-        transactionTableWidget->setItem(i, 3, subcategoryItem);
-
-        // Set the transaction amount.
-        QTableWidgetItem *amountItem = new QTableWidgetItem(
-            QString::number(transaction->amount(), 'f', 2));
-        transactionTableWidget->setItem(i, 4, amountItem);
-
-        // Set the transaction balance.
-        QTableWidgetItem *balanceItem = new QTableWidgetItem(
-            QString::number(transaction->balance(), 'f', 2));
-        transactionTableWidget->setItem(i, 5, balanceItem);
-
-        // Set the transaction ID.
-        QTableWidgetItem *transactionIDItem = new QTableWidgetItem(
-            QString::number(transaction->transactionID()));
-        transactionTableWidget->setItem(i, 6, transactionIDItem);
-    }
+    // Load every transaction into the model.
+    transactionModel->load(Session::getInstance()->userID());
+    // Show the category column.
+    transactionTableView->setColumnHidden(TransactionTableModel::CategoryColumn, false);
 }
 
 /**
@@ -191,59 +136,27 @@ void MainWindow::loadTransactionsByCategory()
         return;
     }
 
-    // Get database instance.
-    Database *db = Database::getInstance();
-
-    // Get the list of transactions.
-    QVector<Transaction *> transactions = db->getTransactionsByCategory(m_user->userID(),
-                                                                        categoryID);
-    // Clear the table.
-    transactionTableWidget->clearContents();
-    // Set the number of columns in the table widget.
-    transactionTableWidget->setColumnCount(6);
-    // Set the final column to be hidden from user.
-    transactionTableWidget->setColumnHidden(5, true);
-    // Set the table headers.
-    transactionTableWidget->setHorizontalHeaderLabels(
-        {"Date", "Description", "Subcategory", "Amount", "Balance"});
-    // Set the number of rows.
-    transactionTableWidget->setRowCount(transactions.size());
-
-    // Populate the table.
-    for (int i = 0; i < transactions.size(); i++) {
-        // Get the current transaction.
-        Transaction *transaction = transactions.at(i);
-
-        // Set the transaction date.
-        QTableWidgetItem *dateItem = new QTableWidgetItem(transaction->date());
-        transactionTableWidget->setItem(i, 0, dateItem);
-
-        // Set the transaction description.
-        QTableWidgetItem *descriptionItem = new QTableWidgetItem(transaction->description());
-        transactionTableWidget->setItem(i, 1, descriptionItem);
-
-        // Get the subcategory name.
-        QString subcategoryName = db->getSubcategoryName(transaction->categoryID(),
-                                                         transaction->subcategoryID());
-        // Set the transaction subcategory name.
-        QTableWidgetItem *subcategoryItem = new QTableWidgetItem(subcategoryName);
-        transactionTableWidget->setItem(i, 2, subcategoryItem);
-
-        // Set the transaction amount.
-        QTableWidgetItem *amountItem = new QTableWidgetItem(
-            QString::number(transaction->amount(), 'f', 2));
-        transactionTableWidget->setItem(i, 3, amountItem);
-
-        // Set the transaction balance.
-        QTableWidgetItem *balanceItem = new QTableWidgetItem(
-            QString::number(transaction->balance(), 'f', 2));
-        transactionTableWidget->setItem(i, 4, balanceItem);
-
-        // Set the transaction ID as a hidden item.
-        QTableWidgetItem *transactionIDItem = new QTableWidgetItem(
-            QString::number(transaction->transactionID()));
-        transactionTableWidget->setItem(i, 5, transactionIDItem);
+    // Load the category's transactions into the model.
+    transactionModel->load(Session::getInstance()->userID(), categoryID);
+    // Every row shares the selected category, so hide the category column.
+    transactionTableView->setColumnHidden(TransactionTableModel::CategoryColumn, true);
+}
+
+/**
+ * @brief Retrieve the transactions whose descriptions match the search box, most relevant first.
+ */
+void MainWindow::searchTransactions()
+{
+    // If the search box is empty, load all transactions.
+    if (searchLineEdit->text().trimmed().isEmpty()) {
+        loadTransactions();
+        return;
     }
+
+    // Load the matching transactions into the model.
+    transactionModel->search(Session::getInstance()->userID(), searchLineEdit->text());
+    // Matches come from every category, so show the category column.
+    transactionTableView->setColumnHidden(TransactionTableModel::CategoryColumn, false);
 }
 
 /**
@@ -252,7 +165,7 @@ void MainWindow::loadTransactionsByCategory()
 void MainWindow::addTransaction()
 {
     // Create the add transaction dialog.
-    addTransactionDialog = new AddTransactionDialog(this, m_user->userID());
+    addTransactionDialog = new AddTransactionDialog(this);
     // Show the add transaction dialog.
     addTransactionDialog->show();
     // If the add transaction dialog is closed, delete the dialog.
@@ -260,10 +173,6 @@ void MainWindow::addTransaction()
             &AddTransactionDialog::finished,
             addTransactionDialog,
             &QObject::deleteLater);
-    connect(addTransactionDialog,
-            &AddTransactionDialog::transactionAdded,
-            this,
-            &MainWindow::loadTransactions);
 }
 
 /**
@@ -272,24 +181,20 @@ void MainWindow::addTransaction()
 void MainWindow::deleteTransaction()
 {
     // Get the selected row.
-    int row = transactionTableWidget->currentRow();
+    int row = transactionTableView->currentIndex().row();
     // If no row is selected, return.
     if (row == -1) {
         return;
     }
 
-    // Calculate column numbers
-    int transactionIDColumn = transactionTableWidget->columnCount() - 1;
-    int amountColumn = transactionTableWidget->columnCount() - 3;
-
     // Get the transaction ID.
-    int transactionID = transactionTableWidget->item(row, transactionIDColumn)->text().toInt();
+    int transactionID = transactionModel->transactionID(row);
     // Get the transaction date.
-    QString date = transactionTableWidget->item(row, 0)->text();
+    QString date = transactionModel->date(row).toString("MM/dd/yyyy");
     // Get the transaction description.
-    QString description = transactionTableWidget->item(row, 1)->text();
+    QString description = transactionModel->description(row);
     // Get the transaction amount.
-    QString amount = transactionTableWidget->item(row, amountColumn)->text();
+    QString amount = transactionModel->amount(row).toString();
 
     // Create the delete transaction dialog.
     deleteTransactionDialog = new DeleteTransactionDialog(transactionID,
@@ -304,10 +209,19 @@ void MainWindow::deleteTransaction()
             &DeleteTransactionDialog::finished,
             deleteTransactionDialog,
             &QObject::deleteLater);
-    connect(deleteTransactionDialog,
-            &DeleteTransactionDialog::transactionDeleted,
-            this,
-            &MainWindow::loadTransactions);
+}
+
+/**
+ * @brief Import a bank statement into the database.
+ */
+void MainWindow::importStatement()
+{
+    // Create the import dialog.
+    importDialog = new ImportDialog(this);
+    // Show the import dialog.
+    importDialog->show();
+    // If the import dialog is closed, delete the dialog.
+    connect(importDialog, &ImportDialog::finished, importDialog, &QObject::deleteLater);
 }
 
 /**
@@ -317,7 +231,7 @@ void MainWindow::viewLineChart()
 {
     // Create the line chart dialog.
     QString currentCategory = categoryCombo->currentText();
-    lineChartDialog = new LineChartDialog(transactionTableWidget, currentCategory, this);
+    lineChartDialog = new LineChartDialog(transactionModel->categoryID(), currentCategory, this);
     // Show the line chart dialog.
     lineChartDialog->show();
     // If the line chart dialog is closed, delete the dialog.
@@ -325,18 +239,40 @@ void MainWindow::viewLineChart()
 }
 
 /**
- * @brief Create the transaction table widget.
+ * @brief View the user's budgets and this month's spending against them.
+ */
+void MainWindow::viewBudgets()
+{
+    // Create the budget dialog.
+    budgetDialog = new BudgetDialog(this);
+    // Show the budget dialog.
+    budgetDialog->show();
+    // If the budget dialog is closed, delete the dialog.
+    connect(budgetDialog, &BudgetDialog::finished, budgetDialog, &QObject::deleteLater);
+}
+
+/**
+ * @brief Create the transaction table view and its model.
  */
 void MainWindow::createTransactionTable()
 {
-    // Create transaction table widget
-    transactionTableWidget = new QTableWidget(this);
+    // Create the transaction model and table view
+    transactionModel = new TransactionTableModel(this);
+    transactionTableView = new QTableView(this);
+    transactionTableView->setModel(transactionModel);
     // Set the column headers to stretch to fit size of text.
-    transactionTableWidget->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    transactionTableView->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
     // Set the table to be read only.
-    transactionTableWidget->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    transactionTableView->setEditTriggers(QAbstractItemView::NoEditTriggers);
     // Set the selection mode to select rows.
-    transactionTableWidget->setSelectionBehavior(QAbstractItemView::SelectRows);
+    transactionTableView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    transactionTableView->setSelectionMode(QAbstractItemView::SingleSelection);
+    // Format the amount and balance columns when they are painted.
+    CurrencyDelegate *currencyDelegate = new CurrencyDelegate(transactionTableView);
+    transactionTableView->setItemDelegateForColumn(TransactionTableModel::AmountColumn,
+                                                   currencyDelegate);
+    transactionTableView->setItemDelegateForColumn(TransactionTableModel::BalanceColumn,
+                                                   currencyDelegate);
 }
 
 /**
@@ -379,15 +315,25 @@ void MainWindow::setupLayout()
                                                   0,
                                                   QSizePolicy::Expanding,
                                                   QSizePolicy::Minimum);
+
+    // Search Box for Transaction Descriptions
+    searchLineEdit = new QLineEdit();
+    searchLineEdit->setPlaceholderText("Search transactions");
+    searchLineEdit->setClearButtonEnabled(true);
+    searchTimer = new QTimer(this);
+    searchTimer->setSingleShot(true);
+    searchTimer->setInterval(150);
+
     categoryLayout->addWidget(categoryCombo);
     categoryLayout->addWidget(viewCategoryButton);
     categoryLayout->addItem(categorySpacer);
+    categoryLayout->addWidget(searchLineEdit);
 
     // Add the category layout to the main layout
     groupBoxLayout->addLayout(categoryLayout);
 
     // Transaction Table
-    groupBoxLayout->addWidget(transactionTableWidget);
+    groupBoxLayout->addWidget(transactionTableView);
 
     // Set the layout for the group box
     groupBox->setLayout(groupBoxLayout);
@@ -415,10 +361,18 @@ void MainWindow::setupLayout()
     deleteTransactionButton = new QPushButton("Delete Transaction");
     buttonBoxLayout->addWidget(deleteTransactionButton);
 
+    // Import Statement Button
+    importButton = new QPushButton("Import");
+    buttonBoxLayout->addWidget(importButton);
+
     // View Chart Button
     lineChartButton = new QPushButton("View Chart");
     buttonBoxLayout->addWidget(lineChartButton);
 
+    // Budgets Button
+    budgetButton = new QPushButton("Budgets");
+    buttonBoxLayout->addWidget(budgetButton);
+
     // Add buttons to the button box
     buttonBox->setLayout(buttonBoxLayout);
     mainLayout->addWidget(buttonBox);
@@ -428,28 +382,3 @@ void MainWindow::setupLayout()
     centralWidget->setLayout(mainLayout);
     setCentralWidget(centralWidget);
 }
-
-/**
- * @brief Retrieve user's categories from the database and add them to the category combo box.
- *        Allows user to switch between table views of different categories.
- */
-void MainWindow::loadCategories()
-{
-    // Get user's categories from database
-    Database *db = Database::getInstance();
-    QMap<int, QString> categories = db->getCategoryNames(m_user->userID());
-
-    // Clear the combo box
-    categoryCombo->clear();
-
-    // Add the default option to the combo box
-    categoryCombo->addItem("All Categories", -1);
-
-    // Add the Deposit option to the combo box
-    categoryCombo->addItem("Deposit", 0);
-
-    // Add the categories and their ID's to the combo box
-    for (auto category = categories.begin(); category != categories.end(); ++category) {
-        categoryCombo->addItem(category.value(), category.key());
-    }
-}
@@ -2,17 +2,21 @@
 #define MAINWINDOW_H
 
 #include <QBoxLayout>
+#include <QLineEdit>
 #include <QListWidget>
 #include <QMainWindow>
 #include <QPushButton>
-#include <QTableWidget>
+#include <QTableView>
+#include <QTimer>
 #include "addcategorydialog.h"
 #include "addsubcategorydialog.h"
 #include "addtransactiondialog.h"
+#include "budgetdialog.h"
 #include "deletetransactiondialog.h"
+#include "importdialog.h"
 #include "linechartdialog.h"
 #include "logindialog.h"
-#include "user.h"
+#include "transactiontablemodel.h"
 
 class MainWindow : public QMainWindow
 {
@@ -22,14 +26,17 @@ public:
     explicit MainWindow(QWidget *parent = nullptr);
 
 private slots:
-    void showMainWindow(User *user); // Show the main window.
-    void addCategory();              // Show the add category dialog.
-    void addSubcategory();           // Show the add subcategory dialog.
-    void addTransaction();           // Show the add transaction dialog.
-    void deleteTransaction();        // Show the delete transaction dialog.
-    void viewLineChart();            // Show the line chart dialog.
-    void loadTransactions();         // Load transactions.
+    void showMainWindow();             // Show the main window.
+    void addCategory();                // Show the add category dialog.
+    void addSubcategory();             // Show the add subcategory dialog.
+    void addTransaction();             // Show the add transaction dialog.
+    void deleteTransaction();          // Show the delete transaction dialog.
+    void importStatement();            // Show the import dialog.
+    void viewLineChart();              // Show the line chart dialog.
+    void viewBudgets();                // Show the budget dialog.
+    void loadTransactions();           // Load transactions.
     void loadTransactionsByCategory(); // Load transactions by category.
+    void searchTransactions();         // Load transactions matching the search box.
 
 private:
     LoginDialog *loginDialog = nullptr;
@@ -37,25 +44,29 @@ private:
     AddSubcategoryDialog *addSubcategoryDialog = nullptr;
     AddTransactionDialog *addTransactionDialog = nullptr;
     DeleteTransactionDialog *deleteTransactionDialog = nullptr;
+    ImportDialog *importDialog = nullptr;
     LineChartDialog *lineChartDialog = nullptr;
+    BudgetDialog *budgetDialog = nullptr;
 
     QLabel *headerLabel = nullptr;
-    QTableWidget *transactionTableWidget = nullptr;
+    QTableView *transactionTableView = nullptr;
+    TransactionTableModel *transactionModel = nullptr;
     QLabel *welcomeLabel = nullptr;
     QComboBox *categoryCombo = nullptr;
+    QLineEdit *searchLineEdit = nullptr;
+    QTimer *searchTimer = nullptr; // Searches once the user pauses typing.
 
     QPushButton *viewCategoryButton = nullptr;
     QPushButton *addCategoryButton = nullptr;
     QPushButton *addSubcategoryButton = nullptr;
     QPushButton *addTransactionButton = nullptr;
     QPushButton *deleteTransactionButton = nullptr;
+    QPushButton *importButton = nullptr;
     QPushButton *lineChartButton = nullptr;
-
-    User *m_user = nullptr; // Pointer to the user object.
+    QPushButton *budgetButton = nullptr;
 
 private:
     void createTransactionTable();
     void setupLayout();
-    void loadCategories();
 };
 #endif // MAINWINDOW_H
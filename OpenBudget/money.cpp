@@ -0,0 +1,114 @@
+#include "money.h"
+#include <QtNumeric>
+
+/**
+ * @brief Parses an amount typed by the user, such as "12", "-3.5" or "1,204.99".
+ *        The decimal point is found first, then group separators are ignored in the whole
+ *        part only; at most two decimal places are accepted. A "." is also read as the
+ *        decimal point, unless the locale groups digits with it.
+ *
+ * @param text The text to parse.
+ * @param locale The locale whose decimal point and group separator the text uses.
+ * @return The amount; std::nullopt if the text is not an amount within MAX_CENTS.
+ */
+std::optional<Money> Money::fromString(const QString &text, const QLocale &locale)
+{
+    QString trimmed = text.trimmed();
+
+    // Read the sign.
+    bool negative = trimmed.startsWith('-');
+    if (negative || trimmed.startsWith('+')) {
+        trimmed.remove(0, 1);
+    }
+
+    // Find the decimal point before anything is removed, so a character the locale uses for
+    // both is never mistaken for the other.
+    QString decimalPoint = locale.decimalPoint();
+    QString groupSeparator = locale.groupSeparator();
+    qsizetype point = trimmed.lastIndexOf(decimalPoint);
+    if (point == -1 && groupSeparator != ".") {
+        point = trimmed.lastIndexOf('.');
+        decimalPoint = ".";
+    }
+
+    // Split the whole and fractional parts; only the whole part may be grouped.
+    QString whole = point == -1 ? trimmed : trimmed.left(point);
+    QString fraction = point == -1 ? QString() : trimmed.mid(point + decimalPoint.size());
+    if (!groupSeparator.isEmpty()) {
+        whole.remove(groupSeparator);
+    }
+
+    // Require digits, and no more than two decimal places.
+    if ((whole.isEmpty() && fraction.isEmpty()) || fraction.size() > 2) {
+        return std::nullopt;
+    }
+    for (QChar c : whole + fraction) {
+        if (c < '0' || c > '9') {
+            return std::nullopt;
+        }
+    }
+
+    // Combine the parts into cents.
+    bool ok = true;
+    qint64 dollars = whole.isEmpty() ? 0 : whole.toLongLong(&ok);
+    if (!ok || dollars > MAX_CENTS / 100) {
+        return std::nullopt;
+    }
+    qint64 cents = fraction.isEmpty() ? 0 : fraction.leftJustified(2, '0').toLongLong();
+    Money amount(dollars * 100 + cents);
+
+    if (!amount.isValidAmount()) {
+        return std::nullopt;
+    }
+    return negative ? -amount : amount;
+}
+
+/**
+ * @brief Converts the amount to dollars for display in charts.
+ *
+ * @return The amount in dollars.
+ */
+double Money::toDouble() const
+{
+    return double(m_cents) / 100.0;
+}
+
+/**
+ * @brief Formats the amount with two decimal places, such as "-1204.99".
+ *
+ * @return The formatted amount.
+ */
+QString Money::toString() const
+{
+    return toString(QLocale::c());
+}
+
+/**
+ * @brief Formats the amount with two decimal places in a locale, such as "-1,204.99".
+ *
+ * @param locale The locale to format with.
+ * @return The formatted amount.
+ */
+QString Money::toString(const QLocale &locale) const
+{
+    // Split into whole dollars and cents without going through floating point.
+    quint64 magnitude = m_cents < 0 ? 0 - quint64(m_cents) : quint64(m_cents);
+    QString text = locale.toString(qulonglong(magnitude / 100)) + locale.decimalPoint()
+                   + QString("%1").arg(magnitude % 100, 2, 10, QChar('0'));
+    return m_cents < 0 ? locale.negativeSign() + text : text;
+}
+
+/**
+ * @brief Adds two amounts.
+ *
+ * @param other The amount to add.
+ * @return The sum; std::nullopt if it overflows.
+ */
+std::optional<Money> Money::checkedAdd(Money other) const
+{
+    qint64 result;
+    if (qAddOverflow(m_cents, other.m_cents, &result)) {
+        return std::nullopt;
+    }
+    return Money(result);
+}
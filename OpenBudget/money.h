@@ -0,0 +1,58 @@
+#ifndef MONEY_H
+#define MONEY_H
+
+#include <QLocale>
+#include <QMetaType>
+#include <QString>
+#include <optional>
+
+/**
+ * @brief The Money class is an exact amount of money stored as a whole number of cents.
+ */
+class Money
+{
+public:
+    // Largest magnitude of a single amount in cents (ten trillion).
+    static constexpr qint64 MAX_CENTS = 1000000000000000LL;
+
+    constexpr Money() = default;
+
+    // Create an amount.
+    static constexpr Money fromCents(qint64 cents) { return Money(cents); }
+    static std::optional<Money> fromString(const QString &text, const QLocale &locale = QLocale());
+
+    // Retrieve the amount.
+    constexpr qint64 cents() const { return m_cents; }
+    double toDouble() const;
+    QString toString() const;
+    QString toString(const QLocale &locale) const;
+
+    // Whether the amount is within MAX_CENTS.
+    constexpr bool isValidAmount() const { return m_cents >= -MAX_CENTS && m_cents <= MAX_CENTS; }
+
+    // Absolute value and negation.
+    constexpr Money abs() const { return Money(m_cents < 0 ? -m_cents : m_cents); }
+    constexpr Money operator-() const { return Money(-m_cents); }
+
+    // Addition; a result overflowing qint64 returns std::nullopt.
+    std::optional<Money> checkedAdd(Money other) const;
+
+    // Comparison operators.
+    constexpr bool operator==(Money other) const { return m_cents == other.m_cents; }
+    constexpr bool operator!=(Money other) const { return m_cents != other.m_cents; }
+    constexpr bool operator<(Money other) const { return m_cents < other.m_cents; }
+    constexpr bool operator>(Money other) const { return m_cents > other.m_cents; }
+    constexpr bool operator<=(Money other) const { return m_cents <= other.m_cents; }
+    constexpr bool operator>=(Money other) const { return m_cents >= other.m_cents; }
+
+private:
+    constexpr explicit Money(qint64 cents)
+        : m_cents{cents}
+    {}
+
+    qint64 m_cents = 0;
+};
+
+Q_DECLARE_METATYPE(Money)
+
+#endif // MONEY_H
@@ -0,0 +1,263 @@
+#include "passwordhasher.h"
+#include <QAtomicInt>
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QMessageAuthenticationCode>
+#include <QPromise>
+#include <QRandomGenerator>
+#include <QStringList>
+#include <QThreadPool>
+#include <memory>
+
+// Name of the algorithm in stored hashes.
+static const char *const ALGORITHM = "pbkdf2-sha256";
+
+// Bytes of random salt per password.
+static const int SALT_BYTES = 16;
+
+// Bytes of derived key; one SHA-256 block.
+static const int KEY_BYTES = 32;
+
+// The iterations new hashes use.
+static QAtomicInt currentIterations = PasswordHasher::MIN_ITERATIONS;
+
+/**
+ * @brief Gets the iterations new hashes use.
+ * @return The iteration count.
+ */
+int PasswordHasher::iterations()
+{
+    return currentIterations.loadRelaxed();
+}
+
+/**
+ * @brief Sets the iterations new hashes use, within MIN_ITERATIONS and MAX_ITERATIONS.
+ * @param iterations The iteration count.
+ */
+void PasswordHasher::setIterations(int iterations)
+{
+    currentIterations.storeRelaxed(qBound(MIN_ITERATIONS, iterations, MAX_ITERATIONS));
+}
+
+/**
+ * @brief Hashes a password with a new random salt and the current iterations.
+ * @param password The password.
+ * @return The stored form: "pbkdf2-sha256$iterations$salt$hash" with base64 salt and hash.
+ */
+QString PasswordHasher::hash(const QString &password)
+{
+    // Draw the salt from the system's secure source.
+    QByteArray salt(SALT_BYTES, Qt::Uninitialized);
+    QRandomGenerator::system()->fillRange(reinterpret_cast<quint32 *>(salt.data()),
+                                          SALT_BYTES / sizeof(quint32));
+
+    int count = iterations();
+    QByteArray key = deriveKey(password.toUtf8(), salt, count);
+    return QString("%1$%2$%3$%4")
+        .arg(QString::fromLatin1(ALGORITHM),
+             QString::number(count),
+             QString::fromLatin1(salt.toBase64()),
+             QString::fromLatin1(key.toBase64()));
+}
+
+/**
+ * @brief Checks a password against a stored hash.
+ *        Legacy hashes are the MD5 of the password followed by userID + 32, in hex.
+ * @param password The password to check.
+ * @param stored The stored hash.
+ * @param userID The ID of the user the hash belongs to.
+ * @return Returns true if the password matches, false otherwise.
+ */
+bool PasswordHasher::verify(const QString &password, const QString &stored, int userID)
+{
+    QStringList parts = stored.split('$');
+
+    // Check legacy hashes the way they were made.
+    if (parts.size() == 1) {
+        QByteArray legacy = QCryptographicHash::hash(
+                                (password + QString::number(userID + 32)).toUtf8(),
+                                QCryptographicHash::Md5)
+                                .toHex();
+        return constantTimeEquals(legacy, stored.toLatin1());
+    }
+
+    // Reject hashes this build cannot read.
+    bool validCount = false;
+    int count = parts.size() == 4 ? parts.at(1).toInt(&validCount) : 0;
+    if (parts.size() != 4 || parts.at(0) != QLatin1String(ALGORITHM) || !validCount
+        || count <= 0 || count > MAX_ITERATIONS) {
+        return false;
+    }
+
+    // Derive the key again with the stored salt and iterations.
+    QByteArray salt = QByteArray::fromBase64(parts.at(2).toLatin1());
+    QByteArray expected = QByteArray::fromBase64(parts.at(3).toLatin1());
+    return constantTimeEquals(deriveKey(password.toUtf8(), salt, count), expected);
+}
+
+/**
+ * @brief Checks whether a stored hash should be replaced by a current one.
+ *        Calibration varies from run to run, so only hashes with under half the current
+ *        iterations count as weaker.
+ * @param stored The stored hash.
+ * @return Returns true if the hash is legacy or much cheaper than current hashes.
+ */
+bool PasswordHasher::needsRehash(const QString &stored)
+{
+    QStringList parts = stored.split('$');
+    if (parts.size() != 4 || parts.at(0) != QLatin1String(ALGORITHM)) {
+        return true;
+    }
+
+    return parts.at(1).toInt() < iterations() / 2;
+}
+
+/**
+ * @brief Hashes a password on a thread pool thread, so the caller is not held up for the
+ *        hashing time.
+ * @param password The password to hash.
+ * @return Future of the hash.
+ */
+QFuture<QString> PasswordHasher::hashLater(const QString &password)
+{
+    // The promise is shared with the pooled task, which fulfils it.
+    auto promise = std::make_shared<QPromise<QString>>();
+    QFuture<QString> future = promise->future();
+    promise->start();
+
+    QThreadPool::globalInstance()->start([promise, password]() {
+        promise->addResult(hash(password));
+        promise->finish();
+    });
+
+    return future;
+}
+
+/**
+ * @brief Checks a password on a thread pool thread, so the caller is not held up for the
+ *        hashing time. A matching password whose stored hash needs rehashing is hashed again
+ *        on the same thread.
+ * @param password The password to check.
+ * @param stored The stored hash.
+ * @param userID The ID of the user the hash belongs to.
+ * @return Future of the outcome.
+ */
+QFuture<PasswordCheck> PasswordHasher::checkLater(const QString &password,
+                                                  const QString &stored,
+                                                  int userID)
+{
+    // The promise is shared with the pooled task, which fulfils it.
+    auto promise = std::make_shared<QPromise<PasswordCheck>>();
+    QFuture<PasswordCheck> future = promise->future();
+    promise->start();
+
+    QThreadPool::globalInstance()->start([promise, password, stored, userID]() {
+        PasswordCheck check;
+        check.matches = verify(password, stored, userID);
+        if (check.matches && needsRehash(stored)) {
+            check.rehashed = hash(password);
+        }
+        promise->addResult(check);
+        promise->finish();
+    });
+
+    return future;
+}
+
+/**
+ * @brief Measures the iterations this host runs in a target time.
+ *        A probe is timed until it has run long enough to be measured, and the rate is
+ *        scaled to the target and rounded to thousands.
+ * @param targetMilliseconds The time one hash should take.
+ * @return The iterations, within MIN_ITERATIONS and MAX_ITERATIONS.
+ */
+int PasswordHasher::calibrate(int targetMilliseconds)
+{
+    const int probeIterations = 10000;
+    QByteArray salt(SALT_BYTES, 's');
+
+    // Run the probe until at least 50 ms have passed.
+    QElapsedTimer timer;
+    timer.start();
+    qint64 total = 0;
+    do {
+        deriveKey("calibration", salt, probeIterations);
+        total += probeIterations;
+    } while (timer.elapsed() < 50);
+
+    // Scale the measured rate to the target.
+    double perMillisecond = double(total) / timer.nsecsElapsed() * 1000000;
+    qint64 calibrated = qint64(perMillisecond * targetMilliseconds) / 1000 * 1000;
+    return int(qBound<qint64>(MIN_ITERATIONS, calibrated, MAX_ITERATIONS));
+}
+
+/**
+ * @brief Measures how many hashes this host computes per second with the current iterations.
+ * @param milliseconds How long to measure for; at least one hash is computed.
+ * @return Hashes per second.
+ */
+double PasswordHasher::benchmark(int milliseconds)
+{
+    QElapsedTimer timer;
+    timer.start();
+    int hashes = 0;
+    do {
+        hash("benchmark");
+        ++hashes;
+    } while (timer.elapsed() < milliseconds);
+
+    return hashes / (timer.nsecsElapsed() / 1e9);
+}
+
+/**
+ * @brief Derives a key with PBKDF2-HMAC-SHA256 (RFC 8018).
+ *        The key is one hash long, so only the first block is computed.
+ * @param password The password.
+ * @param salt The salt.
+ * @param iterations The iteration count.
+ * @return The 32 byte key.
+ */
+QByteArray PasswordHasher::deriveKey(const QByteArray &password,
+                                     const QByteArray &salt,
+                                     int iterations)
+{
+    // U1 is the HMAC of the salt and the block number.
+    QMessageAuthenticationCode mac(QCryptographicHash::Sha256, password);
+    mac.addData(salt);
+    mac.addData("\x00\x00\x00\x01", 4);
+    QByteArray block = mac.result();
+    QByteArray key = block;
+
+    // Each further U is the HMAC of the previous one; the key is all of them XORed.
+    for (int i = 1; i < iterations; ++i) {
+        mac.reset();
+        mac.addData(block);
+        block = mac.result();
+        for (int j = 0; j < KEY_BYTES; ++j) {
+            key[j] = char(key[j] ^ block[j]);
+        }
+    }
+
+    return key;
+}
+
+/**
+ * @brief Compares two byte arrays without stopping at the first difference, so the time
+ *        taken does not reveal how much of a hash matched.
+ * @param a The first array.
+ * @param b The second array.
+ * @return Returns true if the arrays are equal, false otherwise.
+ */
+bool PasswordHasher::constantTimeEquals(const QByteArray &a, const QByteArray &b)
+{
+    if (a.size() != b.size()) {
+        return false;
+    }
+
+    char difference = 0;
+    for (qsizetype i = 0; i < a.size(); ++i) {
+        difference |= char(a.at(i) ^ b.at(i));
+    }
+
+    return difference == 0;
+}
@@ -0,0 +1,73 @@
+#ifndef PASSWORDHASHER_H
+#define PASSWORDHASHER_H
+
+#include <QByteArray>
+#include <QFuture>
+#include <QString>
+
+// Outcome of checking a password against a stored hash.
+struct PasswordCheck
+{
+    bool matches = false; // Whether the password is the stored one.
+    QString rehashed;     // A current hash of the password if the stored one is weaker; empty
+                          // otherwise.
+};
+
+/**
+ * @brief The PasswordHasher class hashes passwords with PBKDF2-HMAC-SHA256 and a random salt
+ *        per password. Hashes are stored as "pbkdf2-sha256$iterations$salt$hash", so the cost
+ *        can be raised without invalidating existing passwords. The iteration count is
+ *        calibrated to a target latency on the host when the application starts.
+ *        Hashes from before PBKDF2 (unsalted MD5 of the password and userID + 32) are still
+ *        accepted, and reported for rehashing.
+ */
+class PasswordHasher
+{
+public:
+    // Time a login may spend hashing on a typical host.
+    static constexpr int TARGET_MILLISECONDS = 250;
+
+    // Fewest iterations used, however slow the host.
+    static constexpr int MIN_ITERATIONS = 100000;
+
+    // Most iterations used, however fast the host.
+    static constexpr int MAX_ITERATIONS = 10000000;
+
+    // Get and set the iterations new hashes use.
+    static int iterations();
+    static void setIterations(int iterations);
+
+    // Hash a password with a new random salt.
+    static QString hash(const QString &password);
+
+    // Check a password against a stored hash of the user's.
+    static bool verify(const QString &password, const QString &stored, int userID);
+
+    // Whether a stored hash is legacy or was made with far fewer iterations than current.
+    static bool needsRehash(const QString &stored);
+
+    // Hash a password with a new random salt on a thread pool thread.
+    static QFuture<QString> hashLater(const QString &password);
+
+    // Check a password on a thread pool thread, rehashing it if the stored hash is weaker.
+    static QFuture<PasswordCheck> checkLater(const QString &password,
+                                             const QString &stored,
+                                             int userID);
+
+    // Get the iterations that take about targetMilliseconds on this host.
+    static int calibrate(int targetMilliseconds = TARGET_MILLISECONDS);
+
+    // Get the hashes per second this host computes with the current iterations.
+    static double benchmark(int milliseconds = 1000);
+
+private:
+    // Derive a 32 byte key with PBKDF2-HMAC-SHA256.
+    static QByteArray deriveKey(const QByteArray &password,
+                                const QByteArray &salt,
+                                int iterations);
+
+    // Compare two byte arrays in time independent of where they differ.
+    static bool constantTimeEquals(const QByteArray &a, const QByteArray &b);
+};
+
+#endif // PASSWORDHASHER_H
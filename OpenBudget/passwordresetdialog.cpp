@@ -1,6 +1,7 @@
 // recoverpassworddialog.cpp
 #include "passwordresetdialog.h"
-#include "database.h"
+#include "asyncdatabase.h"
+#include "passwordhasher.h"
 #include "qdialogbuttonbox.h"
 
 #include <QFormLayout>
@@ -74,52 +75,72 @@ PasswordResetDialog::PasswordResetDialog(QWidget *parent)
 
 /**
  * @brief Attempt to recover the user's password when the recover password button is clicked.
+ *        The login is looked up and the new hash stored on the database thread, and the
+ *        password is hashed on a thread pool thread, so the dialog stays responsive.
  */
 void PasswordResetDialog::recoverPasswordButtonClicked()
 {
-    bool passwordReset = false;
-
-    // Extract email from line edit.
+    // Extract email and the new password from the line edits.
     QString email = emailLineEdit->text();
+    QString newPassword = newPasswordLineEdit->text();
 
-    // Get a databse instance
-    Database *db = Database::getInstance();
-    // Get the user login from the database
-    UserLogin *userLogin = db->getUserLoginEmail(email);
-
-    if (userLogin == nullptr) {
-        QMessageBox::critical(this,
-                              "Error",
-                              "Email not found.\n"
-                              "Please try again.");
-        return;
-    }
+    // Disable the reset password button until the attempt has finished.
+    recoverPasswordButton->setEnabled(false);
 
-    // Extract the new password from the line edit.
-    QString newPassword = newPasswordLineEdit->text();
+    // Get the user login from the database on the database thread.
+    AsyncDatabase::getInstance()
+        ->run([email](Database &db) { return db.getUserLoginEmail(email); })
+        .then(this, [this, newPassword](const std::optional<UserLogin> &userLogin) {
+            if (!userLogin) {
+                // Allow another attempt.
+                enableResetPasswordButton();
+                QMessageBox::critical(this,
+                                      "Error",
+                                      "Email not found.\n"
+                                      "Please try again.");
+                return;
+            }
+
+            // Hash the new password off the GUI thread.
+            int userID = userLogin->userID();
+            PasswordHasher::hashLater(newPassword).then(this, [this, userID](const QString &hash) {
+                passwordHashed(userID, hash);
+            });
+        });
+}
 
-    // Update the user's password in the database.
-    if (!db->updatePassword(userLogin, newPassword)) {
-        // Create a message box to display the query error message.
-        QMessageBox::critical(this,
-                              "Error",
-                              "Password reset failed.\n"
-                              "Please try again.");
-        return;
-    }
-
-    // Set passworReset flag to true.
-    passwordReset = true;
-
-    // If the password was reset, notify the user.
-    if (passwordReset) {
-        QMessageBox::information(this,
-                                 "Password Reset",
-                                 "Password reset successful.\n"
-                                 "Please login with your new password.");
-        emit passwordRecoveryClosed();
-        close();
-    }
+/**
+ * @brief Stores the new hash of the user's password once it has been computed.
+ * 
+ * @param userID The ID of the user.
+ * @param hash The hash of the new password.
+ */
+void PasswordResetDialog::passwordHashed(int userID, const QString &hash)
+{
+    // Update the user's password in the database on the database thread.
+    AsyncDatabase::getInstance()
+        ->run([userID, hash](Database &db) { return db.updatePasswordHash(userID, hash); })
+        .then(this, [this](bool passwordReset) {
+            // Allow another attempt.
+            enableResetPasswordButton();
+
+            if (!passwordReset) {
+                // Create a message box to display the query error message.
+                QMessageBox::critical(this,
+                                      "Error",
+                                      "Password reset failed.\n"
+                                      "Please try again.");
+                return;
+            }
+
+            // The password was reset, notify the user.
+            QMessageBox::information(this,
+                                     "Password Reset",
+                                     "Password reset successful.\n"
+                                     "Please login with your new password.");
+            emit passwordRecoveryClosed();
+            close();
+        });
 }
 
 /**
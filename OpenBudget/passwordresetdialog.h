@@ -22,6 +22,8 @@ private slots:
     void enableResetPasswordButton(); // Enable the recover password button when the email line edit is not empty.
 
 private:
+    void passwordHashed(int userID, const QString &hash); // Store the new hash once it has been computed.
+
     QLineEdit *emailLineEdit;           // Email line edit.
     QLineEdit *newPasswordLineEdit;     // New password line edit.
     QLineEdit *confirmPasswordLineEdit; // Confirm new password line edit.
@@ -1,6 +1,7 @@
 // registerdialog.cpp
 #include "registerdialog.h"
-#include "database.h"
+#include "asyncdatabase.h"
+#include "passwordhasher.h"
 #include "qdialogbuttonbox.h"
 
 #include <QFormLayout>
@@ -90,12 +91,12 @@ void RegisterDialog::enableRegisterButton()
 
 /**
  * @brief Attempt to register the user in the database.
+ *        The password is hashed on a thread pool thread, then the user and their login are
+ *        created in one database transaction on the database thread, so a failed registration
+ *        leaves nothing behind and neither the dialog nor other queries wait for the hashing.
  */
 void RegisterDialog::registerButtonClicked()
 {
-    // Flag to indicate if the user was registered successfully.
-    bool registered = false;
-
     // Retrieve user input.
     QString firstName = firstNameLineEdit->text();
     QString lastName = lastNameLineEdit->text();
@@ -105,38 +106,38 @@ void RegisterDialog::registerButtonClicked()
     Position position = static_cast<Position>(positionComboBox->currentData().toInt());
     AccessLevel accessLevel = static_cast<AccessLevel>(positionComboBox->currentData().toInt());
 
-    // Get a database instance
-    Database *db = Database::getInstance();
-    // Query the database for the user's chosen username.
-    UserLogin *userLogin = db->getUserLogin(userName);
-    // If the user login exists, display an error message.
-    if (userLogin != nullptr) {
-        // Create a message box to display the query error message.
-        QMessageBox::critical(this,
-                              tr("Registration Failed"),
-                              tr("Username already exists in database."));
-        return;
-    }
+    // Disable the register button until the attempt has finished.
+    registerButton->setEnabled(false);
 
-    // Insert the new user into the database.
-    User *newUser = db->createUser(firstName, lastName, position);
-    // If the user was not created, display an error message.
-    if (newUser == nullptr) {
-        // Create a message box to display the query error message.
-        QMessageBox::critical(this, tr("Registration Failed"), tr("Failed to create user."));
-        return;
-    }
+    // Hash the password off the GUI and database threads.
+    PasswordHasher::hashLater(password).then(this, [=](const QString &passwordHash) {
+        // Create the user and their login on the database thread.
+        AsyncDatabase *db = AsyncDatabase::getInstance();
+        db->registerAccount(firstName,
+                            lastName,
+                            position,
+                            userName,
+                            passwordHash,
+                            accessLevel,
+                            email)
+            .then(this, [this](const RegistrationResult &result) { accountRegistered(result); });
+    });
+}
 
-    // Insert the new user login into the database.
-    UserLogin *newUserLogin = db->createUserLogin(userName,
-                                                  password,
-                                                  accessLevel,
-                                                  email,
-                                                  newUser->userID());
-    // If the user login was not created, display an error message.
-    if (newUserLogin == nullptr) {
+/**
+ * @brief Reports the outcome of a registration, closing the dialog if the account was created.
+ * 
+ * @param result The new account, or why it could not be created.
+ */
+void RegisterDialog::accountRegistered(const RegistrationResult &result)
+{
+    // Allow another attempt.
+    enableRegisterButton();
+
+    // If the account was not created, display an error message.
+    if (!result.account) {
         // Create a message box to display the query error message.
-        QMessageBox::critical(this, tr("Registration Failed"), tr("Failed to create user login."));
+        QMessageBox::critical(this, tr("Registration Failed"), result.error);
         return;
     }
 
@@ -146,16 +147,10 @@ void RegisterDialog::registerButtonClicked()
                              tr("User Account Registered \n"
                                 "Please login to continue."));
 
-    // Set the registered flag to true.
-    registered = true;
-
-    // If the user was registered successfully, emit the signal.
-    if (registered) {
-        // Emit the signal
-        emit userRegistered();
-        // Close the dialog
-        accept();
-    }
+    // Emit the signal
+    emit userRegistered();
+    // Close the dialog
+    accept();
 }
 
 /**
@@ -7,6 +7,8 @@
 #include <QLineEdit>
 #include <QPushButton>
 
+struct RegistrationResult;
+
 class RegisterDialog : public QDialog
 {
     Q_OBJECT
@@ -24,6 +26,9 @@ private slots:
     void cancelButtonClicked();   // Cancel registration when the cancel button is clicked.
 
 private:
+    // Report the outcome of a registration.
+    void accountRegistered(const RegistrationResult &result);
+
     QLineEdit *firstNameLineEdit = nullptr; // First name line edit.
     QLineEdit *lastNameLineEdit = nullptr;  // Last name line edit.
     QLineEdit *usernameLineEdit = nullptr;  // Username line edit.
@@ -0,0 +1,579 @@
+#include "schemamigrator.h"
+#include "balancepyramid.h"
+#include <QDebug>
+#include <QSet>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <iterator>
+
+// The migrations, in version order. Append new migrations; never change applied ones.
+const SchemaMigrator::Migration SchemaMigrator::MIGRATIONS[] = {
+    {1, "Create tables", &SchemaMigrator::createTables},
+    {2, "Upgrade unversioned schema", &SchemaMigrator::upgradeUnversioned},
+    {3, "Create indexes", &SchemaMigrator::syncIndexes},
+    {4, "Create transaction search index", &SchemaMigrator::createSearchIndex},
+    {5, "Create monthly rollup", &SchemaMigrator::createMonthlyRollup},
+    {6, "Create budgets", &SchemaMigrator::createBudgets},
+    {7, "Create balance pyramid", &SchemaMigrator::createBalancePyramid},
+};
+
+// The indexes kept in the schema, beyond the primary keys and UNIQUE constraints.
+const SchemaMigrator::IndexDefinition SchemaMigrator::INDEXES[] = {
+    // The user's ledger in date order for paging, date ranges and balance lookups.
+    // Covers the columns the balance chart reads so it never touches the table.
+    {"TransactionsLedgerIndex",
+     "Transactions",
+     "userID, transactionDate, transactionID, amount, balance"},
+    // Each category's ledger in date order for paging.
+    {"TransactionsCategoryLedgerIndex",
+     "Transactions",
+     "userID, categoryID, transactionDate, transactionID, amount, balance"},
+    // The user's categories.
+    {"CategoryUserIndex", "Category", "userID"},
+    // A category's subcategories.
+    {"SubcategoryCategoryIndex", "Subcategory", "categoryID, userID"},
+    // The login of a user.
+    {"UserLoginUserIndex", "UserLogin", "userID"},
+};
+
+/**
+ * @brief Migrates the schema of an open database.
+ * @param db The database connection.
+ */
+SchemaMigrator::SchemaMigrator(QSqlDatabase &db)
+    : db{db}
+{}
+
+/**
+ * @brief Gets the version of the schema this build expects.
+ * @return The version of the last migration.
+ */
+int SchemaMigrator::latestVersion()
+{
+    return MIGRATIONS[std::size(MIGRATIONS) - 1].version;
+}
+
+/**
+ * @brief Gets the version of the schema in the database.
+ * @return The database's user_version; 0 for a new or unversioned database.
+ */
+int SchemaMigrator::currentVersion()
+{
+    QSqlQuery query(db);
+    if (query.exec("PRAGMA user_version") && query.next()) {
+        return query.value(0).toInt();
+    }
+
+    qDebug() << "Error reading schema version: " << query.lastError().text();
+    return 0;
+}
+
+/**
+ * @brief Applies every migration newer than the database's version, each in its own
+ *        transaction together with the new version number.
+ * @return Returns true if the schema is current, false if a migration failed.
+ */
+bool SchemaMigrator::migrate()
+{
+    // Nothing to do for a current schema.
+    int version = currentVersion();
+    if (version >= latestVersion()) {
+        return true;
+    }
+
+    for (const Migration &migration : MIGRATIONS) {
+        if (migration.version <= version) {
+            continue;
+        }
+
+        // Apply the migration and record its version atomically.
+        if (!db.transaction()) {
+            qDebug() << "Error starting migration: " << db.lastError().text();
+            return false;
+        }
+        bool applied = (this->*migration.apply)()
+                       && exec(QString("PRAGMA user_version = %1").arg(migration.version));
+        if (!applied || !db.commit()) {
+            qDebug() << "Schema migration" << migration.version << migration.description
+                     << "failed";
+            db.rollback();
+            return false;
+        }
+
+        qDebug() << "Migrated schema to version" << migration.version << migration.description;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Creates the tables. Tables of unversioned databases already exist and are kept.
+ * @return Returns true if the tables were created, false otherwise.
+ */
+bool SchemaMigrator::createTables()
+{
+    // Create User table.
+    bool created = exec("CREATE TABLE IF NOT EXISTS User ("
+                        "userID INTEGER PRIMARY KEY AUTOINCREMENT, "
+                        "firstname TEXT NOT NULL, "
+                        "lastname TEXT NOT NULL, "
+                        "position INTEGER NOT NULL CHECK (position IN (0, 1, 2)))");
+
+    // Create UserLogin table.
+    created = created
+              && exec("CREATE TABLE IF NOT EXISTS UserLogin ("
+                      "loginID INTEGER PRIMARY KEY AUTOINCREMENT, "
+                      "username TEXT NOT NULL UNIQUE, "
+                      "password TEXT NOT NULL, "
+                      "accessLevel INTEGER NOT NULL CHECK (accessLevel IN (0, 1, 2)), "
+                      "email TEXT NOT NULL UNIQUE, "
+                      "userID INTEGER NOT NULL, "
+                      "FOREIGN KEY(userID) REFERENCES User(userID))");
+
+    // Create Category table.
+    created = created
+              && exec("CREATE TABLE IF NOT EXISTS Category ("
+                      "categoryID INTEGER PRIMARY KEY AUTOINCREMENT, "
+                      "categoryName TEXT NOT NULL, "
+                      "userID INTEGER NOT NULL, "
+                      "FOREIGN KEY(userID) REFERENCES User(userID))");
+
+    // Create Subcategory table.
+    created = created
+              && exec("CREATE TABLE IF NOT EXISTS Subcategory ("
+                      "subcategoryID INTEGER PRIMARY KEY AUTOINCREMENT, "
+                      "subcategoryName TEXT NOT NULL, "
+                      "categoryID INTEGER NOT NULL, "
+                      "userID INTEGER NOT NULL, "
+                      "FOREIGN KEY(userID) REFERENCES User(userID),"
+                      "FOREIGN KEY(categoryID) REFERENCES Category(categoryID))");
+
+    // Create Transactions table.
+    // Amounts are stored as whole cents so sums are exact.
+    // Dates are stored as days since 1970-01-01 so they sort and range-scan as integers.
+    // Balance holds the user's running balance up to and including the row, in ledger
+    // (transactionDate, transactionID) order, so the ledger can be read in a single ordered pass.
+    created = created
+              && exec("CREATE TABLE IF NOT EXISTS Transactions ("
+                      "transactionID INTEGER PRIMARY KEY AUTOINCREMENT, "
+                      "amount INTEGER NOT NULL, "
+                      "description TEXT, "
+                      "transactionDate INTEGER NOT NULL, "
+                      "categoryID INTEGER NOT NULL, "
+                      "subcategoryID INTEGER, "
+                      "userID INTEGER NOT NULL, "
+                      "isDeposit BOOLEAN NOT NULL,"
+                      "balance INTEGER NOT NULL DEFAULT 0, "
+                      "FOREIGN KEY(categoryID) REFERENCES Category(categoryID), "
+                      "FOREIGN KEY(subcategoryID) REFERENCES Subcategory(subcategoryID), "
+                      "FOREIGN KEY(userID) REFERENCES User(userID))");
+
+    return created;
+}
+
+/**
+ * @brief Upgrades a database created before the schema was versioned to the current
+ *        Transactions table. New databases already have it, and nothing changes.
+ * @return Returns true if the database was upgraded, false otherwise.
+ */
+bool SchemaMigrator::upgradeUnversioned()
+{
+    // Drop the old balance view first, it re-summed the whole table for every row.
+    // It names Transactions, so SQLite would refuse to rename a rebuilt table into place
+    // while it still exists.
+    if (!exec("DROP VIEW IF EXISTS TransactionsView")) {
+        return false;
+    }
+
+    // Databases created before the balance column existed computed balances in a view.
+    if (!hasColumn("Transactions", "balance") && !migrateRunningBalance()) {
+        return false;
+    }
+
+    // Databases created before dates were day numbers stored them as MM/dd/yyyy text.
+    if (columnType("Transactions", "transactionDate") == "TEXT" && !migrateEpochDates()) {
+        return false;
+    }
+
+    // Databases created before amounts were cents stored them as floating point dollars.
+    return columnType("Transactions", "amount") == "INTEGER" || migrateIntegerCents();
+}
+
+/**
+ * @brief Creates the declared indexes that are missing and drops the indexes on the same
+ *        tables that are no longer declared. Indexes SQLite creates for constraints are kept.
+ * @return Returns true if the indexes match the declared set, false otherwise.
+ */
+bool SchemaMigrator::syncIndexes()
+{
+    QSet<QString> tables;
+    QSet<QString> declared;
+
+    // Create the declared indexes.
+    for (const IndexDefinition &index : INDEXES) {
+        tables.insert(QString::fromLatin1(index.table));
+        declared.insert(QString::fromLatin1(index.name));
+        if (!exec(QString("CREATE INDEX IF NOT EXISTS %1 ON %2 (%3)")
+                      .arg(index.name, index.table, index.columns))) {
+            return false;
+        }
+    }
+
+    // Find the indexes on the managed tables that are no longer declared.
+    QSqlQuery query(db);
+    if (!query.exec("SELECT name, tbl_name FROM sqlite_master WHERE type = 'index' "
+                    "AND sql IS NOT NULL")) {
+        qDebug() << "Error listing indexes: " << query.lastError().text();
+        return false;
+    }
+    QStringList obsolete;
+    while (query.next()) {
+        QString name = query.value("name").toString();
+        if (tables.contains(query.value("tbl_name").toString()) && !declared.contains(name)) {
+            obsolete.append(name);
+        }
+    }
+
+    // Drop them.
+    for (const QString &name : std::as_const(obsolete)) {
+        if (!exec("DROP INDEX IF EXISTS " + name)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Creates the full-text index of transaction descriptions and fills it from the
+ *        existing rows. The index stores no text of its own; it reads descriptions from
+ *        Transactions, and triggers keep it in step with every insert, delete and
+ *        description change. Balance updates do not touch it.
+ * @return Returns true if the index was created, false otherwise.
+ */
+bool SchemaMigrator::createSearchIndex()
+{
+    // Index descriptions by word, case and accent insensitively.
+    // Prefixes of two and three characters are indexed too, so short search-as-you-type
+    // prefixes do not merge the lists of every word they start.
+    bool created = exec("CREATE VIRTUAL TABLE IF NOT EXISTS TransactionsSearch USING fts5("
+                        "description, "
+                        "content = 'Transactions', "
+                        "content_rowid = 'transactionID', "
+                        "tokenize = 'unicode61 remove_diacritics 2', "
+                        "prefix = '2 3')");
+
+    // Index new rows.
+    created = created
+              && exec("CREATE TRIGGER IF NOT EXISTS TransactionsSearchInsert "
+                      "AFTER INSERT ON Transactions BEGIN "
+                      "INSERT INTO TransactionsSearch (rowid, description) "
+                      "VALUES (new.transactionID, new.description); "
+                      "END");
+
+    // Remove deleted rows; an external content index is told the text it indexed.
+    created = created
+              && exec("CREATE TRIGGER IF NOT EXISTS TransactionsSearchDelete "
+                      "AFTER DELETE ON Transactions BEGIN "
+                      "INSERT INTO TransactionsSearch (TransactionsSearch, rowid, description) "
+                      "VALUES ('delete', old.transactionID, old.description); "
+                      "END");
+
+    // Reindex changed descriptions.
+    created = created
+              && exec("CREATE TRIGGER IF NOT EXISTS TransactionsSearchUpdate "
+                      "AFTER UPDATE OF description ON Transactions BEGIN "
+                      "INSERT INTO TransactionsSearch (TransactionsSearch, rowid, description) "
+                      "VALUES ('delete', old.transactionID, old.description); "
+                      "INSERT INTO TransactionsSearch (rowid, description) "
+                      "VALUES (new.transactionID, new.description); "
+                      "END");
+
+    // Index the existing rows.
+    return created
+           && exec("INSERT INTO TransactionsSearch (TransactionsSearch) VALUES ('rebuild')");
+}
+
+/**
+ * @brief Builds the SQL expression of the month a stored day number falls in.
+ * @param day The SQL expression of the day number.
+ * @return The expression of the month, counted from January 1970.
+ */
+static QString monthOf(const QString &day)
+{
+    return QString("((CAST(strftime('%Y', %1 * 86400, 'unixepoch') AS INTEGER) - 1970) * 12 "
+                   "+ CAST(strftime('%m', %1 * 86400, 'unixepoch') AS INTEGER) - 1)")
+        .arg(day);
+}
+
+/**
+ * @brief Creates the monthly rollup, which holds the sum and count of every user's
+ *        transactions per category, subcategory and month, and fills it from the existing rows.
+ *        Triggers apply every insert, delete and change of a rolled up column to it, so it is
+ *        always exact. Balance updates do not touch it.
+ * @return Returns true if the rollup was created, false otherwise.
+ */
+bool SchemaMigrator::createMonthlyRollup()
+{
+    // Create MonthlyRollup table.
+    // Months are counted from January 1970. Keyed by user and month first, so a user's months
+    // are one range of the table whatever the categories.
+    bool created = exec("CREATE TABLE IF NOT EXISTS MonthlyRollup ("
+                        "userID INTEGER NOT NULL, "
+                        "month INTEGER NOT NULL, "
+                        "categoryID INTEGER NOT NULL, "
+                        "subcategoryID INTEGER NOT NULL, "
+                        "total INTEGER NOT NULL, "
+                        "count INTEGER NOT NULL, "
+                        "PRIMARY KEY (userID, month, categoryID, subcategoryID)) WITHOUT ROWID");
+
+    // Statements that add a new row to its month and take an old row out of its month.
+    // A month left with no rows is removed.
+    QString addNew = QString("INSERT INTO MonthlyRollup "
+                             "(userID, month, categoryID, subcategoryID, total, count) "
+                             "VALUES (new.userID, %1, new.categoryID, "
+                             "COALESCE(new.subcategoryID, 0), new.amount, 1) "
+                             "ON CONFLICT (userID, month, categoryID, subcategoryID) "
+                             "DO UPDATE SET total = total + excluded.total, "
+                             "count = count + 1; ")
+                         .arg(monthOf("new.transactionDate"));
+    QString oldKey = QString("userID = old.userID AND month = %1 "
+                             "AND categoryID = old.categoryID "
+                             "AND subcategoryID = COALESCE(old.subcategoryID, 0)")
+                         .arg(monthOf("old.transactionDate"));
+    QString removeOld = "UPDATE MonthlyRollup SET total = total - old.amount, count = count - 1 "
+                        "WHERE "
+                        + oldKey + "; DELETE FROM MonthlyRollup WHERE " + oldKey
+                        + " AND count = 0; ";
+
+    // Add new rows.
+    created = created
+              && exec("CREATE TRIGGER IF NOT EXISTS MonthlyRollupInsert "
+                      "AFTER INSERT ON Transactions BEGIN "
+                      + addNew + "END");
+
+    // Take out deleted rows.
+    created = created
+              && exec("CREATE TRIGGER IF NOT EXISTS MonthlyRollupDelete "
+                      "AFTER DELETE ON Transactions BEGIN "
+                      + removeOld + "END");
+
+    // Move changed rows.
+    created = created
+              && exec("CREATE TRIGGER IF NOT EXISTS MonthlyRollupUpdate "
+                      "AFTER UPDATE OF userID, transactionDate, categoryID, subcategoryID, amount "
+                      "ON Transactions BEGIN "
+                      + removeOld + addNew + "END");
+
+    // Roll up the existing rows.
+    return created
+           && exec(QString("INSERT INTO MonthlyRollup "
+                           "(userID, month, categoryID, subcategoryID, total, count) "
+                           "SELECT userID, %1, categoryID, COALESCE(subcategoryID, 0), "
+                           "SUM(amount), COUNT(*) FROM Transactions "
+                           "GROUP BY 1, 2, 3, 4")
+                       .arg(monthOf("transactionDate")));
+}
+
+/**
+ * @brief Creates the Budget table.
+ * @return Returns true if the table was created, false otherwise.
+ */
+bool SchemaMigrator::createBudgets()
+{
+    // Create Budget table.
+    // Amounts are monthly, in whole cents. A subcategoryID of 0 budgets the whole category.
+    // A category or subcategory has at most one budget, and the constraint's index finds a
+    // user's budgets.
+    return exec("CREATE TABLE IF NOT EXISTS Budget ("
+                "budgetID INTEGER PRIMARY KEY AUTOINCREMENT, "
+                "userID INTEGER NOT NULL, "
+                "categoryID INTEGER NOT NULL, "
+                "subcategoryID INTEGER NOT NULL DEFAULT 0, "
+                "amount INTEGER NOT NULL CHECK (amount >= 0), "
+                "UNIQUE (userID, categoryID, subcategoryID), "
+                "FOREIGN KEY(userID) REFERENCES User(userID), "
+                "FOREIGN KEY(categoryID) REFERENCES Category(categoryID))");
+}
+
+/**
+ * @brief Creates the balance pyramid, which holds the open, close, low and high balance of
+ *        every user's transactions per day, week, month and year, and fills it from the
+ *        existing rows. Balances shift with every earlier insert or delete, which triggers
+ *        would apply one row at a time, so Database maintains the table instead.
+ * @return Returns true if the pyramid was created, false otherwise.
+ */
+bool SchemaMigrator::createBalancePyramid()
+{
+    // Create BalancePyramid table.
+    // Buckets are the epoch day of their first day; the key orders a level's buckets by date.
+    bool created = exec("CREATE TABLE IF NOT EXISTS BalancePyramid ("
+                        "userID INTEGER NOT NULL, "
+                        "level INTEGER NOT NULL, "
+                        "bucket INTEGER NOT NULL, "
+                        "open INTEGER NOT NULL, "
+                        "close INTEGER NOT NULL, "
+                        "low INTEGER NOT NULL, "
+                        "high INTEGER NOT NULL, "
+                        "count INTEGER NOT NULL, "
+                        "PRIMARY KEY (userID, level, bucket)) WITHOUT ROWID");
+
+    // Aggregate the existing rows into every level.
+    for (PyramidLevel level : BalancePyramid::LEVELS) {
+        created = created && exec(BalancePyramid::fillSql(level, QString()));
+    }
+
+    return created;
+}
+
+/**
+ * @brief Executes a statement.
+ * @param sql The statement.
+ * @return Returns true if the statement succeeded, false otherwise.
+ */
+bool SchemaMigrator::exec(const QString &sql)
+{
+    QSqlQuery query(db);
+    if (!query.exec(sql)) {
+        qDebug() << "Error executing " << sql << ": " << query.lastError().text();
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Checks whether a table has a column.
+ * @param table The name of the table.
+ * @param column The name of the column.
+ * @return Returns true if the column exists, false otherwise.
+ */
+bool SchemaMigrator::hasColumn(const QString &table, const QString &column)
+{
+    return !columnType(table, column).isEmpty();
+}
+
+/**
+ * @brief Retrieves the declared type of a column.
+ * @param table The name of the table.
+ * @param column The name of the column.
+ * @return The column's declared type in upper case; empty if the column does not exist.
+ */
+QString SchemaMigrator::columnType(const QString &table, const QString &column)
+{
+    // Query the table's column list.
+    QSqlQuery query(db);
+    query.exec("PRAGMA table_info(" + table + ")");
+
+    // Look for the column by name.
+    while (query.next()) {
+        if (query.value("name").toString() == column) {
+            return query.value("type").toString().toUpper();
+        }
+    }
+
+    return QString();
+}
+
+/**
+ * @brief Adds the persisted running balance to a database created before it existed.
+ *        Each user's balances are computed in one ordered pass over their transactions.
+ * @return Returns true if the balance column was added, false otherwise.
+ */
+bool SchemaMigrator::migrateRunningBalance()
+{
+    // Add the balance column and fill it.
+    return exec("ALTER TABLE Transactions ADD COLUMN balance DECIMAL(10,2) NOT NULL DEFAULT 0")
+           && recomputeBalances();
+}
+
+/**
+ * @brief Converts MM/dd/yyyy text dates to day numbers in a database created before
+ *        dates were stored as integers.
+ * @return Returns true if the dates were converted, false otherwise.
+ */
+bool SchemaMigrator::migrateEpochDates()
+{
+    // Convert MM/dd/yyyy to days since 1970-01-01 while rebuilding the table.
+    return rebuildTransactions("transactionID INTEGER PRIMARY KEY AUTOINCREMENT, "
+                               "amount DECIMAL(10,2) NOT NULL, "
+                               "description TEXT, "
+                               "transactionDate INTEGER NOT NULL, "
+                               "categoryID INTEGER NOT NULL, "
+                               "subcategoryID INTEGER, "
+                               "userID INTEGER NOT NULL, "
+                               "isDeposit BOOLEAN NOT NULL,"
+                               "balance DECIMAL(10,2) NOT NULL DEFAULT 0, "
+                               "FOREIGN KEY(categoryID) REFERENCES Category(categoryID), "
+                               "FOREIGN KEY(subcategoryID) REFERENCES Subcategory(subcategoryID), "
+                               "FOREIGN KEY(userID) REFERENCES User(userID)",
+                               "transactionID, amount, description, "
+                               "CAST(julianday(substr(transactionDate, 7, 4) || '-' || "
+                               "substr(transactionDate, 1, 2) || '-' || "
+                               "substr(transactionDate, 4, 2)) - 2440587.5 AS INTEGER), "
+                               "categoryID, subcategoryID, userID, isDeposit, balance");
+}
+
+/**
+ * @brief Converts floating point dollar amounts to whole cents in a database created before
+ *        amounts were stored as integers. Balances are recomputed from the exact amounts.
+ * @return Returns true if the amounts were converted, false otherwise.
+ */
+bool SchemaMigrator::migrateIntegerCents()
+{
+    // Round each amount to the nearest cent while rebuilding the table.
+    return rebuildTransactions("transactionID INTEGER PRIMARY KEY AUTOINCREMENT, "
+                               "amount INTEGER NOT NULL, "
+                               "description TEXT, "
+                               "transactionDate INTEGER NOT NULL, "
+                               "categoryID INTEGER NOT NULL, "
+                               "subcategoryID INTEGER, "
+                               "userID INTEGER NOT NULL, "
+                               "isDeposit BOOLEAN NOT NULL,"
+                               "balance INTEGER NOT NULL DEFAULT 0, "
+                               "FOREIGN KEY(categoryID) REFERENCES Category(categoryID), "
+                               "FOREIGN KEY(subcategoryID) REFERENCES Subcategory(subcategoryID), "
+                               "FOREIGN KEY(userID) REFERENCES User(userID)",
+                               "transactionID, CAST(ROUND(amount * 100) AS INTEGER), description, "
+                               "transactionDate, categoryID, subcategoryID, userID, isDeposit, 0");
+}
+
+/**
+ * @brief Rebuilds the Transactions table with new column definitions, since SQLite cannot change
+ *        a column's type in place. The rows are copied, the ID sequence is kept and the running
+ *        balances are recomputed. The table's indexes are dropped with it; a later migration
+ *        must create them again.
+ * @param columns The column definitions of the new table.
+ * @param selectColumns The expressions producing each new column from the old table.
+ * @return Returns true if the table was rebuilt, false otherwise.
+ */
+bool SchemaMigrator::rebuildTransactions(const QString &columns, const QString &selectColumns)
+{
+    // Create the new table and copy the transactions.
+    return exec("CREATE TABLE TransactionsMigration (" + columns + ")")
+           && exec("INSERT INTO TransactionsMigration (transactionID, amount, description, "
+                   "transactionDate, categoryID, subcategoryID, userID, isDeposit, balance) "
+                   "SELECT "
+                   + selectColumns + " FROM Transactions")
+           // Keep the ID sequence so deleted transaction IDs are not reused.
+           && exec("UPDATE sqlite_sequence SET seq = (SELECT seq FROM sqlite_sequence "
+                   "WHERE name = 'Transactions') WHERE name = 'TransactionsMigration'")
+           // Replace the old table.
+           && exec("DROP TABLE Transactions")
+           && exec("ALTER TABLE TransactionsMigration RENAME TO Transactions")
+           // Compute the balances again in the new table.
+           && recomputeBalances();
+}
+
+/**
+ * @brief Recomputes every user's running balance in one ordered pass over their ledger.
+ * @return Returns true if the balances were recomputed, false otherwise.
+ */
+bool SchemaMigrator::recomputeBalances()
+{
+    // Compute every user's running balance with a window over their ledger.
+    return exec("UPDATE Transactions SET balance = ledger.balance FROM ("
+                "SELECT transactionID, SUM(amount) OVER (PARTITION BY userID "
+                "ORDER BY transactionDate, transactionID) AS balance FROM Transactions) AS ledger "
+                "WHERE Transactions.transactionID = ledger.transactionID");
+}
@@ -0,0 +1,108 @@
+#ifndef SCHEMAMIGRATOR_H
+#define SCHEMAMIGRATOR_H
+
+#include <QSqlDatabase>
+#include <QString>
+
+/**
+ * @brief The SchemaMigrator class brings a database's schema up to date.
+ *        The schema's version is kept in SQLite's user_version. Each migration runs once, in
+ *        order, inside its own transaction together with the version bump, so a failed
+ *        migration leaves the database at the previous version. A current database is
+ *        recognized from user_version alone and no DDL runs.
+ */
+class SchemaMigrator
+{
+public:
+    explicit SchemaMigrator(QSqlDatabase &db);
+
+    // Version of the schema this build expects.
+    static int latestVersion();
+
+    // Version of the schema in the database.
+    int currentVersion();
+
+    // Apply every migration newer than the database's version.
+    // Returns false if a migration failed; the database keeps the last version that succeeded.
+    bool migrate();
+
+private:
+    // A step from one schema version to the next.
+    struct Migration
+    {
+        int version;                     // The version the migration brings the schema to.
+        const char *description;         // What the migration does, for the log.
+        bool (SchemaMigrator::*apply)(); // Applies the migration; runs inside a transaction.
+    };
+
+    // The migrations, in version order.
+    static const Migration MIGRATIONS[];
+
+    // An index the migrator keeps in the schema.
+    struct IndexDefinition
+    {
+        const char *name;
+        const char *table;
+        const char *columns;
+    };
+
+    // The indexes the migrator keeps in the schema.
+    // After changing the set, add a migration that runs syncIndexes.
+    static const IndexDefinition INDEXES[];
+
+    /* Migrations */
+
+    // Create the tables.
+    bool createTables();
+
+    // Upgrade databases created before the schema was versioned.
+    bool upgradeUnversioned();
+
+    // Create the managed indexes and drop indexes that are no longer declared.
+    bool syncIndexes();
+
+    // Create the full-text index of transaction descriptions and the triggers that maintain it.
+    // Rebuilding Transactions drops the triggers; a later migration must create them again.
+    bool createSearchIndex();
+
+    // Create the monthly per-category rollup and the triggers that keep it exact.
+    // Like the search triggers, these are dropped when Transactions is rebuilt.
+    bool createMonthlyRollup();
+
+    // Create the Budget table.
+    bool createBudgets();
+
+    // Create the balance pyramid and fill it from the stored balances.
+    // Database keeps it current; balances changed outside Database must rebuild it.
+    bool createBalancePyramid();
+
+    /* Helpers */
+
+    // Execute a statement, logging any error.
+    bool exec(const QString &sql);
+
+    // Check whether a table has a column.
+    bool hasColumn(const QString &table, const QString &column);
+
+    // Get the declared type of a column.
+    QString columnType(const QString &table, const QString &column);
+
+    // Add the persisted running balance to databases created before it existed.
+    bool migrateRunningBalance();
+
+    // Convert text dates to day numbers in databases created before dates were integers.
+    bool migrateEpochDates();
+
+    // Convert dollar amounts to cents in databases created before amounts were integers.
+    bool migrateIntegerCents();
+
+    // Rebuild the Transactions table with new column definitions.
+    bool rebuildTransactions(const QString &columns, const QString &selectColumns);
+
+    // Recompute every user's running balance.
+    bool recomputeBalances();
+
+    QSqlDatabase &db;
+};
+
+#endif // SCHEMAMIGRATOR_H
@@ -0,0 +1,86 @@
+#include "session.h"
+
+// Singleton instance of Session.
+Session *Session::INSTANCE = nullptr;
+
+/**
+ * @brief Session singleton instance getter.
+ * @return Session singleton instance.
+ */
+Session *Session::getInstance()
+{
+    if (!INSTANCE) {
+        INSTANCE = new Session();
+    }
+
+    return INSTANCE;
+}
+
+/**
+ * @brief Starts the session of a user who has logged in.
+ *        The password hash is dropped; nothing after logging in needs it.
+ * @param user The user.
+ * @param login The user's login.
+ */
+void Session::start(const User &user, const UserLogin &login)
+{
+    m_user = user;
+    m_login = login;
+    m_login.resetPassword(QString());
+    m_active = true;
+}
+
+/**
+ * @brief Ends the session and forgets the user.
+ */
+void Session::end()
+{
+    m_user = User();
+    m_login = UserLogin();
+    m_active = false;
+}
+
+/**
+ * @brief Checks whether a user is logged in.
+ * @return Returns true between start() and end().
+ */
+bool Session::isActive() const
+{
+    return m_active;
+}
+
+/**
+ * @brief Getter for the logged in user.
+ * @return The user.
+ */
+const User &Session::user() const
+{
+    return m_user;
+}
+
+/**
+ * @brief Getter for the logged in user's login.
+ * @return The login; its password is empty.
+ */
+const UserLogin &Session::login() const
+{
+    return m_login;
+}
+
+/**
+ * @brief Getter for the logged in user's ID.
+ * @return The ID of the user.
+ */
+int Session::userID() const
+{
+    return m_user.userID();
+}
+
+/**
+ * @brief Getter for the logged in user's access level.
+ * @return The access level.
+ */
+AccessLevel Session::accessLevel() const
+{
+    return m_login.accessLevel();
+}
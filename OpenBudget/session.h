@@ -0,0 +1,46 @@
+#ifndef SESSION_H
+#define SESSION_H
+
+#include "accesslevel.h"
+#include "user.h"
+#include "userlogin.h"
+
+/**
+ * @brief The Session class holds the logged in user's profile and login for the lifetime of
+ *        the login, so windows and dialogs read them from memory instead of being handed a
+ *        userID and querying the database again. The password hash is not kept.
+ *        Use it from the GUI thread.
+ */
+class Session
+{
+public:
+    // Singleton instance getter.
+    static Session *getInstance();
+
+    // Start the session of a user who has logged in.
+    void start(const User &user, const UserLogin &login);
+
+    // End the session, as when the user logs out.
+    void end();
+
+    // Whether a user is logged in.
+    bool isActive() const;
+
+    // Retrieve the logged in user's details.
+    const User &user() const;
+    const UserLogin &login() const;
+    int userID() const;
+    AccessLevel accessLevel() const;
+
+private:
+    Session() = default;
+
+    // Singleton instance of Session.
+    static Session *INSTANCE;
+
+    bool m_active = false; // Whether a user is logged in.
+    User m_user;           // The logged in user.
+    UserLogin m_login;     // The logged in user's login, without the password hash.
+};
+
+#endif // SESSION_H
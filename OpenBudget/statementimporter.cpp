@@ -0,0 +1,540 @@
+#include "statementimporter.h"
+#include <QFile>
+#include <QRegularExpression>
+#include <algorithm>
+#include "asyncdatabase.h"
+
+// Number of records each queue between the stages holds.
+static constexpr qsizetype ROW_QUEUE_CAPACITY = 1024;
+// Number of batches waiting to be inserted.
+static constexpr qsizetype BATCH_QUEUE_CAPACITY = 4;
+// Milliseconds between progress reports.
+static constexpr int PROGRESS_INTERVAL = 250;
+
+/**
+ * @brief Imports a bank statement into a user's ledger.
+ *
+ * @param userID The ID of the user.
+ * @param fallbackCategoryID The category of withdrawals that match no category.
+ * @param parent Pointer to the parent object.
+ */
+StatementImporter::StatementImporter(int userID, int fallbackCategoryID, QObject *parent)
+    : QObject{parent}
+    , m_userID{userID}
+    , m_fallbackCategoryID{fallbackCategoryID}
+    , m_parsedRows{ROW_QUEUE_CAPACITY}
+    , m_normalizedRows{ROW_QUEUE_CAPACITY}
+    , m_categorizedRows{ROW_QUEUE_CAPACITY}
+    , m_batches{BATCH_QUEUE_CAPACITY}
+{
+    // Report progress while the import runs.
+    m_progressTimer.setInterval(PROGRESS_INTERVAL);
+    connect(&m_progressTimer, &QTimer::timeout, this, &StatementImporter::reportProgress);
+}
+
+/**
+ * @brief Stops the import and waits for its stages.
+ */
+StatementImporter::~StatementImporter()
+{
+    cancel();
+    for (QThread *thread : std::as_const(m_threads)) {
+        thread->wait();
+        delete thread;
+    }
+}
+
+/**
+ * @brief Starts importing a statement file.
+ *        The categories and the last transaction ID are read first, then the stages start.
+ *
+ * @param fileName The path of the statement.
+ */
+void StatementImporter::start(const QString &fileName)
+{
+    m_elapsed.start();
+
+    // Read the categories, and remember which transactions existed before the import.
+    int userID = m_userID;
+    AsyncDatabase::getInstance()
+        ->run([userID](Database &db) {
+            ImportContext context;
+            context.maxTransactionID = db.getLastTransactionID();
+            context.categories = db.getCategoryNames(userID);
+            for (auto category = context.categories.begin(); category != context.categories.end();
+                 ++category) {
+                context.subcategories.insert(category.key(),
+                                             db.getSubcategoryNames(userID, category.key()));
+            }
+            return context;
+        })
+        .then(this, [this, fileName](const ImportContext &context) {
+            startPipeline(fileName, context);
+        });
+}
+
+/**
+ * @brief Stops the import. Every queue is closed, so each stage stops at its next record.
+ */
+void StatementImporter::cancel()
+{
+    m_canceled = true;
+    m_parsedRows.close();
+    m_normalizedRows.close();
+    m_categorizedRows.close();
+    m_batches.close();
+}
+
+/**
+ * @brief Builds the category rules and starts a thread for each stage.
+ *
+ * @param fileName The path of the statement.
+ * @param context The categories and the last transaction ID.
+ */
+void StatementImporter::startPipeline(const QString &fileName, const ImportContext &context)
+{
+    m_maxTransactionID = context.maxTransactionID;
+
+    // Match descriptions against every category and subcategory name.
+    for (auto category = context.categories.begin(); category != context.categories.end();
+         ++category) {
+        m_categoryRules.append({category.value().toLower(), category.key(), 0});
+        const QMap<int, QString> subcategories = context.subcategories.value(category.key());
+        for (auto subcategory = subcategories.begin(); subcategory != subcategories.end();
+             ++subcategory) {
+            m_categoryRules.append(
+                {subcategory.value().toLower(), category.key(), subcategory.key()});
+        }
+    }
+
+    // The longest name is the most specific match.
+    std::stable_sort(m_categoryRules.begin(),
+                     m_categoryRules.end(),
+                     [](const CategoryRule &a, const CategoryRule &b) {
+                         return a.name.size() > b.name.size();
+                     });
+
+    // Start the stages.
+    m_threads = {QThread::create([this, fileName]() { parseStage(fileName); }),
+                 QThread::create([this]() { normalizeStage(); }),
+                 QThread::create([this]() { categorizeStage(); }),
+                 QThread::create([this]() { dedupeStage(); }),
+                 QThread::create([this]() { insertStage(); })};
+    m_runningStages = m_threads.size();
+    for (QThread *thread : std::as_const(m_threads)) {
+        connect(thread, &QThread::finished, this, &StatementImporter::stageFinished);
+        thread->start();
+    }
+
+    m_progressTimer.start();
+}
+
+/**
+ * @brief Reads the statement's records.
+ *
+ * @param fileName The path of the statement.
+ */
+void StatementImporter::parseStage(const QString &fileName)
+{
+    // Open the statement.
+    QFile file(fileName);
+    std::unique_ptr<StatementParser> parser;
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        addError(0, "The statement could not be opened: " + file.errorString());
+    } else {
+        parser = StatementParser::create(&file, fileName);
+        if (!parser) {
+            addError(0, "The statement's format is not supported.");
+        }
+    }
+
+    // Pass each record on until the statement ends or the import is canceled.
+    StatementRow row;
+    while (parser && !m_canceled && parser->next(row)) {
+        ++m_rowsRead;
+        if (!m_parsedRows.push(std::move(row))) {
+            break;
+        }
+        row = StatementRow();
+    }
+
+    m_parsedRows.close();
+}
+
+/**
+ * @brief Reads the dates and amounts of the records.
+ */
+void StatementImporter::normalizeStage()
+{
+    while (std::optional<StatementRow> row = m_parsedRows.pop()) {
+        if (m_canceled) {
+            break;
+        }
+
+        // Read the date and the amount; a record without either cannot be imported.
+        std::optional<QDate> date = parseDate(row->date);
+        if (!date) {
+            addError(row->recordNumber, "The date \"" + row->date + "\" could not be read.");
+            continue;
+        }
+        std::optional<Money> amount = parseAmount(row->amount);
+        if (!amount) {
+            addError(row->recordNumber, "The amount \"" + row->amount + "\" could not be read.");
+            continue;
+        }
+
+        // Money coming in is a deposit.
+        ImportRow normalized;
+        normalized.recordNumber = row->recordNumber;
+        normalized.draft.date = *date;
+        normalized.draft.amount = *amount;
+        normalized.draft.isDeposit = *amount > Money();
+        normalized.draft.description = row->description.simplified();
+        normalized.category = row->category.trimmed();
+
+        if (!m_normalizedRows.push(std::move(normalized))) {
+            break;
+        }
+    }
+
+    m_normalizedRows.close();
+}
+
+/**
+ * @brief Files the records under categories.
+ */
+void StatementImporter::categorizeStage()
+{
+    while (std::optional<ImportRow> row = m_normalizedRows.pop()) {
+        if (m_canceled) {
+            break;
+        }
+
+        categorize(*row);
+
+        if (!m_categorizedRows.push(std::move(*row))) {
+            break;
+        }
+    }
+
+    m_categorizedRows.close();
+}
+
+/**
+ * @brief Drops the records already in the ledger and groups the rest into batches.
+ */
+void StatementImporter::dedupeStage()
+{
+    QVector<ImportRow> rows;
+    rows.reserve(BATCH_SIZE);
+
+    while (std::optional<ImportRow> row = m_categorizedRows.pop()) {
+        if (m_canceled) {
+            break;
+        }
+
+        rows.append(std::move(*row));
+        if (rows.size() == BATCH_SIZE && !flushDedupeBatch(rows)) {
+            break;
+        }
+    }
+
+    // Pass on the last partial batch.
+    if (!m_canceled) {
+        flushDedupeBatch(rows);
+    }
+
+    m_batches.close();
+}
+
+/**
+ * @brief Inserts the batches.
+ */
+void StatementImporter::insertStage()
+{
+    AsyncDatabase *db = AsyncDatabase::getInstance();
+
+    while (std::optional<ImportBatch> batch = m_batches.pop()) {
+        if (m_canceled) {
+            break;
+        }
+
+        // Insert the batch and wait for it, so only a few batches are ever in flight.
+        TransactionBatchResult result = db->createTransactions(m_userID, batch->drafts).result();
+
+        // Record the rows that were not inserted.
+        if (!result.committed) {
+            for (qint64 recordNumber : std::as_const(batch->recordNumbers)) {
+                addError(recordNumber, "The transaction could not be saved.");
+            }
+            continue;
+        }
+        for (auto error = result.errors.begin(); error != result.errors.end(); ++error) {
+            addError(batch->recordNumbers.at(error.key()), error.value());
+        }
+
+        m_rowsInserted += result.insertedCount();
+    }
+}
+
+/**
+ * @brief Reads a statement's date.
+ *        OFX dates start with yyyyMMdd; QIF dates may use an apostrophe before the year.
+ *
+ * @param text The date as written in the statement.
+ * @return The date; std::nullopt if it cannot be read.
+ */
+std::optional<QDate> StatementImporter::parseDate(const QString &text)
+{
+    QString trimmed = text.trimmed();
+
+    // OFX dates are followed by the time and time zone.
+    static const QRegularExpression ofxDate("^(\\d{8})(\\d{6})?(\\.\\d+)?(\\[.*\\])?$");
+    QRegularExpressionMatch ofxMatch = ofxDate.match(trimmed);
+    if (ofxMatch.hasMatch()) {
+        QDate date = QDate::fromString(ofxMatch.captured(1), "yyyyMMdd");
+        return date.isValid() ? std::optional<QDate>(date) : std::nullopt;
+    }
+
+    // QIF writes 1/ 5'24 for 1/5/2024.
+    trimmed.remove(' ');
+    trimmed.replace('\'', '/');
+
+    // Two digit years are read by Qt as 1900-1999; statements are recent.
+    static const QRegularExpression shortYearDate("^\\d{1,2}/\\d{1,2}/\\d{2}$");
+    if (shortYearDate.match(trimmed).hasMatch()) {
+        QDate date = QDate::fromString(trimmed, "M/d/yy");
+        if (date.isValid() && date.year() < 1950) {
+            date = date.addYears(100);
+        }
+        return date.isValid() ? std::optional<QDate>(date) : std::nullopt;
+    }
+
+    // Try the other formats banks use.
+    static const QStringList formats = {"yyyy-MM-dd", "M/d/yyyy", "d.M.yyyy", "M-d-yyyy"};
+    for (const QString &format : formats) {
+        QDate date = QDate::fromString(trimmed, format);
+        if (date.isValid()) {
+            return date;
+        }
+    }
+
+    return std::nullopt;
+}
+
+/**
+ * @brief Reads a statement's amount.
+ *        Currency symbols are ignored, parentheses or a trailing minus mean a negative amount,
+ *        and a comma followed by one or two digits is a decimal comma.
+ *
+ * @param text The amount as written in the statement.
+ * @return The amount; std::nullopt if it cannot be read.
+ */
+std::optional<Money> StatementImporter::parseAmount(const QString &text)
+{
+    // Keep only digits, signs, separators and parentheses.
+    QString cleaned;
+    for (QChar c : text) {
+        if (c.isDigit() || c == '-' || c == '+' || c == '.' || c == ',' || c == '(' || c == ')') {
+            cleaned += c;
+        }
+    }
+
+    // Accounting notation: (12.34) and 12.34- are negative.
+    bool negative = false;
+    if (cleaned.startsWith('(') && cleaned.endsWith(')')) {
+        negative = true;
+        cleaned = cleaned.mid(1, cleaned.size() - 2);
+    } else if (cleaned.size() > 1 && cleaned.endsWith('-')) {
+        negative = true;
+        cleaned.chop(1);
+    }
+
+    // A decimal comma is the last separator and has one or two digits after it.
+    qsizetype comma = cleaned.lastIndexOf(',');
+    qsizetype point = cleaned.lastIndexOf('.');
+    if (comma > point && cleaned.size() - comma - 1 <= 2) {
+        cleaned.remove('.');
+        cleaned.replace(',', '.');
+    } else {
+        cleaned.remove(',');
+    }
+
+    std::optional<Money> amount = Money::fromString(cleaned, QLocale::c());
+    if (amount && negative) {
+        amount = -amount->abs();
+    }
+    return amount;
+}
+
+/**
+ * @brief Files a transaction under a category.
+ *        A category named by the statement is used first, then the longest category or
+ *        subcategory name found in the description, then the fallback category.
+ *        Deposits are not categorized.
+ *
+ * @param row The transaction to categorize.
+ */
+void StatementImporter::categorize(ImportRow &row) const
+{
+    TransactionDraft &draft = row.draft;
+    draft.categoryID = 0;
+    draft.subcategoryID = 0;
+
+    if (draft.isDeposit) {
+        return;
+    }
+
+    // Use the statement's category, written as "Category" or "Category:Subcategory".
+    if (!row.category.isEmpty()) {
+        QStringList names = row.category.toLower().split(':');
+        QString categoryName = names.at(0).trimmed();
+        QString subcategoryName = names.size() > 1 ? names.at(1).trimmed() : QString();
+
+        for (const CategoryRule &rule : m_categoryRules) {
+            if (rule.subcategoryID == 0 && rule.name == categoryName) {
+                draft.categoryID = rule.categoryID;
+                break;
+            }
+        }
+        for (const CategoryRule &rule : m_categoryRules) {
+            if (draft.categoryID != 0 && rule.categoryID == draft.categoryID
+                && rule.subcategoryID != 0 && rule.name == subcategoryName) {
+                draft.subcategoryID = rule.subcategoryID;
+                break;
+            }
+        }
+        if (draft.categoryID != 0) {
+            return;
+        }
+    }
+
+    // Use the longest name found in the description.
+    QString description = draft.description.toLower();
+    for (const CategoryRule &rule : m_categoryRules) {
+        if (!rule.name.isEmpty() && description.contains(rule.name)) {
+            draft.categoryID = rule.categoryID;
+            draft.subcategoryID = rule.subcategoryID;
+            return;
+        }
+    }
+
+    draft.categoryID = m_fallbackCategoryID;
+}
+
+/**
+ * @brief Checks a batch against the ledger and queues the new transactions to be inserted.
+ *        Only transactions that existed before the import are compared, so repeated rows in
+ *        the statement itself, such as two identical purchases on one day, are all kept.
+ *
+ * @param rows The batch; it is cleared.
+ * @return false if the import was stopped.
+ */
+bool StatementImporter::flushDedupeBatch(QVector<ImportRow> &rows)
+{
+    if (rows.isEmpty()) {
+        return true;
+    }
+
+    QVector<TransactionDraft> drafts;
+    drafts.reserve(rows.size());
+    for (const ImportRow &row : std::as_const(rows)) {
+        drafts.append(row.draft);
+    }
+
+    // Find the drafts that are already in the ledger, with a reader's connection so the check
+    // does not wait behind the batches being inserted. Only rows up to maxTransactionID are
+    // compared, so it needs no ordering with them.
+    int userID = m_userID;
+    int maxTransactionID = m_maxTransactionID;
+    std::optional<QVector<bool>> existing
+        = AsyncDatabase::getInstance()
+              ->read([userID, maxTransactionID, drafts](Database &db) {
+                  return db.findExistingTransactions(userID, maxTransactionID, drafts);
+              })
+              .result();
+
+    // Record the rows that could not be checked; they are not inserted.
+    if (!existing) {
+        for (const ImportRow &row : std::as_const(rows)) {
+            addError(row.recordNumber, "The transaction could not be checked for duplicates.");
+        }
+        rows.clear();
+        return true;
+    }
+
+    // Queue the rest.
+    ImportBatch batch;
+    batch.recordNumbers.reserve(rows.size());
+    batch.drafts.reserve(rows.size());
+    for (int i = 0; i < rows.size(); ++i) {
+        if (existing->value(i)) {
+            ++m_duplicates;
+            continue;
+        }
+        batch.recordNumbers.append(rows.at(i).recordNumber);
+        batch.drafts.append(drafts.at(i));
+    }
+    rows.clear();
+
+    return batch.drafts.isEmpty() || m_batches.push(std::move(batch));
+}
+
+/**
+ * @brief Records a problem with a record. Only the first MAX_ERRORS are kept.
+ *
+ * @param recordNumber The record's position in the statement; 0 for the whole statement.
+ * @param message The problem.
+ */
+void StatementImporter::addError(qint64 recordNumber, const QString &message)
+{
+    if (recordNumber > 0) {
+        ++m_rejected;
+    }
+
+    QMutexLocker locker(&m_errorMutex);
+    if (m_errors.size() < MAX_ERRORS) {
+        m_errors.append(recordNumber > 0
+                            ? QString("Record %1: %2").arg(recordNumber).arg(message)
+                            : message);
+    }
+}
+
+/**
+ * @brief Emits the number of records read and inserted so far.
+ */
+void StatementImporter::reportProgress()
+{
+    double seconds = m_elapsed.elapsed() / 1000.0;
+    qint64 rowsRead = m_rowsRead;
+    emit progress(rowsRead, m_rowsInserted, seconds > 0 ? rowsRead / seconds : 0);
+}
+
+/**
+ * @brief Emits finished once the last stage has stopped.
+ */
+void StatementImporter::stageFinished()
+{
+    if (--m_runningStages > 0) {
+        return;
+    }
+
+    m_progressTimer.stop();
+    reportProgress();
+
+    // Summarize the import.
+    ImportSummary summary;
+    summary.rowsRead = m_rowsRead;
+    summary.rowsInserted = m_rowsInserted;
+    summary.duplicates = m_duplicates;
+    summary.rejected = m_rejected;
+    summary.seconds = m_elapsed.elapsed() / 1000.0;
+    summary.rowsPerSecond = summary.seconds > 0 ? summary.rowsRead / summary.seconds : 0;
+    summary.canceled = m_canceled;
+    {
+        QMutexLocker locker(&m_errorMutex);
+        summary.errors = m_errors;
+    }
+
+    emit finished(summary);
+}
@@ -0,0 +1,152 @@
+#ifndef STATEMENTIMPORTER_H
+#define STATEMENTIMPORTER_H
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QObject>
+#include <QStringList>
+#include <QThread>
+#include <QTimer>
+#include <QVector>
+#include <atomic>
+#include "boundedqueue.h"
+#include "database.h"
+#include "statementparser.h"
+
+// Outcome of a statement import.
+struct ImportSummary
+{
+    qint64 rowsRead = 0;       // Records read from the statement.
+    qint64 rowsInserted = 0;   // Transactions added to the ledger.
+    qint64 duplicates = 0;     // Records already in the ledger before the import.
+    qint64 rejected = 0;       // Records that could not be read or inserted.
+    double seconds = 0;        // Time taken by the import.
+    double rowsPerSecond = 0;  // Records read per second.
+    bool canceled = false;     // Whether the import was canceled.
+    QStringList errors;        // First MAX_ERRORS problems, by record.
+};
+
+/**
+ * @brief The StatementImporter class imports a bank statement into a user's ledger.
+ *        Records stream through five stages, each on its own thread and joined by bounded
+ *        queues: parse, normalize, categorize, dedupe and insert. Only a few batches are in
+ *        flight at any time, so memory stays constant whatever the size of the statement.
+ *        Transactions are written in batches through AsyncDatabase.
+ *        An importer imports a single statement.
+ */
+class StatementImporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Maximum number of errors kept in the summary.
+    static constexpr int MAX_ERRORS = 100;
+    // Number of transactions checked and inserted at a time.
+    static constexpr int BATCH_SIZE = 500;
+
+    // Import into the user's ledger; transactions that match no category are filed under
+    // fallbackCategoryID.
+    StatementImporter(int userID, int fallbackCategoryID, QObject *parent = nullptr);
+    ~StatementImporter();
+
+    // Start importing a statement file; finished() is emitted when it is done.
+    void start(const QString &fileName);
+
+    // Stop the import; transactions already inserted are kept.
+    void cancel();
+
+signals:
+    void progress(qint64 rowsRead, qint64 rowsInserted, double rowsPerSecond);
+    void finished(const ImportSummary &summary);
+
+private:
+    // A record on its way through the pipeline.
+    struct ImportRow
+    {
+        qint64 recordNumber = 0;
+        TransactionDraft draft;
+        QString category; // Category named by the statement.
+    };
+
+    // A batch of transactions ready to insert.
+    struct ImportBatch
+    {
+        QVector<qint64> recordNumbers;
+        QVector<TransactionDraft> drafts;
+    };
+
+    // A category or subcategory name that descriptions are matched against.
+    struct CategoryRule
+    {
+        QString name; // Lower case.
+        int categoryID = 0;
+        int subcategoryID = 0;
+    };
+
+    // Categories and the ledger's state, read before the pipeline starts.
+    struct ImportContext
+    {
+        int maxTransactionID = 0;
+        QMap<int, QString> categories;
+        QMap<int, QMap<int, QString>> subcategories;
+    };
+
+    // Start the stages once the context is read.
+    void startPipeline(const QString &fileName, const ImportContext &context);
+
+    // The stages, each run on its own thread.
+    void parseStage(const QString &fileName);
+    void normalizeStage();
+    void categorizeStage();
+    void dedupeStage();
+    void insertStage();
+
+    // Read a statement's date or amount; std::nullopt if it cannot be read.
+    static std::optional<QDate> parseDate(const QString &text);
+    static std::optional<Money> parseAmount(const QString &text);
+
+    // File a transaction under a category.
+    void categorize(ImportRow &row) const;
+
+    // Check a batch for duplicates and pass the rest on to be inserted.
+    bool flushDedupeBatch(QVector<ImportRow> &rows);
+
+    // Record a problem with a record.
+    void addError(qint64 recordNumber, const QString &message);
+
+    // Emit progress.
+    void reportProgress();
+
+    // Emit finished once every stage has stopped.
+    void stageFinished();
+
+    const int m_userID;
+    const int m_fallbackCategoryID;
+
+    int m_maxTransactionID = 0;           // Only transactions up to this ID are duplicates.
+    QVector<CategoryRule> m_categoryRules; // Longest name first.
+
+    // Queues between the stages.
+    BoundedQueue<StatementRow> m_parsedRows;
+    BoundedQueue<ImportRow> m_normalizedRows;
+    BoundedQueue<ImportRow> m_categorizedRows;
+    BoundedQueue<ImportBatch> m_batches;
+
+    QVector<QThread *> m_threads;
+    int m_runningStages = 0;
+
+    // Counters updated by the stages.
+    std::atomic<qint64> m_rowsRead{0};
+    std::atomic<qint64> m_rowsInserted{0};
+    std::atomic<qint64> m_duplicates{0};
+    std::atomic<qint64> m_rejected{0};
+    std::atomic<bool> m_canceled{false};
+
+    QMutex m_errorMutex;
+    QStringList m_errors;
+
+    QElapsedTimer m_elapsed;
+    QTimer m_progressTimer;
+};
+
+#endif // STATEMENTIMPORTER_H
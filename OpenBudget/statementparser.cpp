@@ -0,0 +1,429 @@
+#include "statementparser.h"
+#include <QFileInfo>
+
+/**
+ * @brief Reads a statement from a device.
+ *
+ * @param device The open device to read from.
+ */
+StatementParser::StatementParser(QIODevice *device)
+    : m_stream{device}
+{}
+
+/**
+ * @brief Creates the parser for a statement file, chosen by its extension.
+ *
+ * @param device The open device to read from.
+ * @param fileName The name of the statement file.
+ * @return The parser; nullptr if the format is not supported.
+ */
+std::unique_ptr<StatementParser> StatementParser::create(QIODevice *device,
+                                                         const QString &fileName)
+{
+    QString suffix = QFileInfo(fileName).suffix().toLower();
+
+    if (suffix == "csv" || suffix == "txt") {
+        return std::make_unique<CsvStatementParser>(device);
+    }
+    if (suffix == "ofx" || suffix == "qfx") {
+        return std::make_unique<OfxStatementParser>(device);
+    }
+    if (suffix == "qif") {
+        return std::make_unique<QifStatementParser>(device);
+    }
+
+    return nullptr;
+}
+
+/**
+ * @brief Splits a CSV record into its fields.
+ *        Fields may be quoted, and quotes inside quoted fields are doubled.
+ *
+ * @param record The record's text.
+ * @param delimiter The field delimiter.
+ * @return The fields.
+ */
+static QStringList splitFields(const QString &record, QChar delimiter)
+{
+    QStringList fields;
+    QString current;
+    bool quoted = false;
+
+    for (qsizetype i = 0; i < record.size(); ++i) {
+        QChar c = record.at(i);
+        if (quoted) {
+            if (c == '"' && i + 1 < record.size() && record.at(i + 1) == '"') {
+                // A doubled quote is a literal quote.
+                current += '"';
+                ++i;
+            } else if (c == '"') {
+                quoted = false;
+            } else {
+                current += c;
+            }
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == delimiter) {
+            fields.append(current.trimmed());
+            current.clear();
+        } else {
+            current += c;
+        }
+    }
+    fields.append(current.trimmed());
+
+    return fields;
+}
+
+/**
+ * @brief Reads a comma, semicolon or tab separated statement.
+ *
+ * @param device The open device to read from.
+ */
+CsvStatementParser::CsvStatementParser(QIODevice *device)
+    : StatementParser{device}
+{}
+
+/**
+ * @brief Reads the next transaction.
+ *
+ * @param row The row to read into.
+ * @return true if a transaction was read, false at the end of the statement.
+ */
+bool CsvStatementParser::next(StatementRow &row)
+{
+    if (!m_headerRead) {
+        readHeader();
+    }
+
+    // Use the first record if the statement had no header.
+    QStringList fields;
+    if (!m_pendingRecord.isEmpty()) {
+        fields = std::move(m_pendingRecord);
+        m_pendingRecord.clear();
+    } else if (!readRecord(fields)) {
+        return false;
+    }
+
+    row.recordNumber = ++m_recordNumber;
+    row.date = field(fields, m_dateColumn);
+    row.description = field(fields, m_descriptionColumn);
+    row.category = field(fields, m_categoryColumn);
+
+    // Statements with separate debit and credit columns fill one of them per row.
+    if (m_amountColumn == -1) {
+        QString debit = field(fields, m_debitColumn);
+        QString credit = field(fields, m_creditColumn);
+        if (!debit.isEmpty() && !debit.startsWith('-')) {
+            row.amount = "-" + debit;
+        } else if (!debit.isEmpty()) {
+            row.amount = debit;
+        } else {
+            row.amount = credit;
+        }
+    } else {
+        row.amount = field(fields, m_amountColumn);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Reads the fields of the next non-empty record.
+ *        A record continues onto the next line while a quoted field is open.
+ *
+ * @param fields The fields read.
+ * @return true if a record was read, false at the end of the statement.
+ */
+bool CsvStatementParser::readRecord(QStringList &fields)
+{
+    QString record;
+    while (record.trimmed().isEmpty()) {
+        if (m_stream.atEnd()) {
+            return false;
+        }
+        record = m_stream.readLine();
+    }
+
+    // Quotes come in pairs, so an odd count means a quoted field continues.
+    while (record.count('"') % 2 != 0 && !m_stream.atEnd()) {
+        record += '\n' + m_stream.readLine();
+    }
+
+    fields = splitFields(record, m_delimiter);
+    return true;
+}
+
+/**
+ * @brief Detects the delimiter and finds the columns from the header.
+ *        If the first record is not a header it is kept as the first transaction.
+ */
+void CsvStatementParser::readHeader()
+{
+    m_headerRead = true;
+
+    // Read the first line and use whichever delimiter it contains most.
+    QString firstLine;
+    while (firstLine.trimmed().isEmpty() && !m_stream.atEnd()) {
+        firstLine = m_stream.readLine();
+    }
+    qsizetype commas = firstLine.count(',');
+    qsizetype semicolons = firstLine.count(';');
+    qsizetype tabs = firstLine.count('\t');
+    if (semicolons > commas && semicolons >= tabs) {
+        m_delimiter = ';';
+    } else if (tabs > commas) {
+        m_delimiter = '\t';
+    }
+
+    QStringList fields = splitFields(firstLine, m_delimiter);
+
+    // Match each column by its name.
+    int dateColumn = -1;
+    int descriptionColumn = -1;
+    int amountColumn = -1;
+    int debitColumn = -1;
+    int creditColumn = -1;
+    int categoryColumn = -1;
+    for (int column = 0; column < fields.size(); ++column) {
+        QString name = fields.at(column).toLower();
+        if (dateColumn == -1 && name.contains("date")) {
+            dateColumn = column;
+        } else if (amountColumn == -1 && name.contains("amount")) {
+            amountColumn = column;
+        } else if (debitColumn == -1 && (name.contains("debit") || name.contains("withdrawal"))) {
+            debitColumn = column;
+        } else if (creditColumn == -1 && (name.contains("credit") || name.contains("deposit"))) {
+            creditColumn = column;
+        } else if (categoryColumn == -1 && name.contains("category")) {
+            categoryColumn = column;
+        } else if (descriptionColumn == -1
+                   && (name.contains("description") || name.contains("payee")
+                       || name.contains("name") || name.contains("memo")
+                       || name.contains("details"))) {
+            descriptionColumn = column;
+        }
+    }
+
+    // Without a date and an amount the first record is a transaction, not a header.
+    bool hasAmount = amountColumn != -1 || (debitColumn != -1 && creditColumn != -1);
+    if (dateColumn == -1 || !hasAmount) {
+        if (!firstLine.trimmed().isEmpty()) {
+            m_pendingRecord = fields;
+        }
+        return;
+    }
+
+    m_dateColumn = dateColumn;
+    m_descriptionColumn = descriptionColumn;
+    m_amountColumn = amountColumn;
+    m_debitColumn = amountColumn == -1 ? debitColumn : -1;
+    m_creditColumn = amountColumn == -1 ? creditColumn : -1;
+    m_categoryColumn = categoryColumn;
+}
+
+/**
+ * @brief Field of a column.
+ *
+ * @param fields The record's fields.
+ * @param column The column; -1 for a missing column.
+ * @return The field; an empty string if the record does not have the column.
+ */
+QString CsvStatementParser::field(const QStringList &fields, int column)
+{
+    return column >= 0 && column < fields.size() ? fields.at(column) : QString();
+}
+
+/**
+ * @brief Reads an OFX or QFX statement.
+ *
+ * @param device The open device to read from.
+ */
+OfxStatementParser::OfxStatementParser(QIODevice *device)
+    : StatementParser{device}
+{}
+
+/**
+ * @brief Reads the next STMTTRN record.
+ *
+ * @param row The row to read into.
+ * @return true if a transaction was read, false at the end of the statement.
+ */
+bool OfxStatementParser::next(StatementRow &row)
+{
+    QString tag;
+    QString value;
+    bool inTransaction = false;
+    QString name;
+    QString memo;
+
+    while (nextElement(tag, value)) {
+        if (tag == "STMTTRN") {
+            // Start a new transaction.
+            inTransaction = true;
+            row = StatementRow();
+            name.clear();
+            memo.clear();
+        } else if (tag == "/STMTTRN" && inTransaction) {
+            // The payee's name describes the transaction best; the memo is used without it.
+            row.recordNumber = ++m_recordNumber;
+            row.description = name.isEmpty() ? memo : name;
+            return true;
+        } else if (inTransaction) {
+            if (tag == "DTPOSTED") {
+                row.date = value;
+            } else if (tag == "TRNAMT") {
+                row.amount = value;
+            } else if (tag == "NAME" || tag == "PAYEE") {
+                name = value;
+            } else if (tag == "MEMO") {
+                memo = value;
+            }
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Reads the next tag and the text that follows it up to the next tag.
+ *        SGML statements leave elements unclosed, so the value always ends at the next '<'.
+ *
+ * @param tag The tag's name in upper case, with a leading '/' for closing tags.
+ * @param value The text after the tag, with entities decoded.
+ * @return true if a tag was read, false at the end of the statement.
+ */
+bool OfxStatementParser::nextElement(QString &tag, QString &value)
+{
+    // Find the start of the next tag, dropping the text before it.
+    qsizetype start = m_buffer.indexOf('<');
+    while (start < 0) {
+        m_buffer.clear();
+        if (!readMore()) {
+            return false;
+        }
+        start = m_buffer.indexOf('<');
+    }
+    m_buffer.remove(0, start);
+
+    // Find the end of the tag and the start of the tag after it.
+    qsizetype end = m_buffer.indexOf('>');
+    qsizetype nextStart = end < 0 ? -1 : m_buffer.indexOf('<', end);
+    while (nextStart < 0) {
+        if (!readMore()) {
+            if (end < 0) {
+                return false;
+            }
+            nextStart = m_buffer.size();
+            break;
+        }
+        end = m_buffer.indexOf('>');
+        nextStart = end < 0 ? -1 : m_buffer.indexOf('<', end);
+    }
+
+    tag = m_buffer.mid(1, end - 1).trimmed().toUpper();
+    value = m_buffer.mid(end + 1, nextStart - end - 1).trimmed();
+    value.replace("&lt;", "<").replace("&gt;", ">").replace("&amp;", "&");
+    m_buffer.remove(0, nextStart);
+
+    return true;
+}
+
+/**
+ * @brief Appends the next chunk of the statement to the buffer.
+ *
+ * @return true if text was read, false at the end of the statement.
+ */
+bool OfxStatementParser::readMore()
+{
+    if (m_stream.atEnd()) {
+        return false;
+    }
+    m_buffer += m_stream.read(CHUNK_SIZE);
+    return true;
+}
+
+/**
+ * @brief Reads a Quicken Interchange Format statement.
+ *
+ * @param device The open device to read from.
+ */
+QifStatementParser::QifStatementParser(QIODevice *device)
+    : StatementParser{device}
+{}
+
+/**
+ * @brief Reads the next record, which ends with a '^' line.
+ *
+ * @param row The row to read into.
+ * @return true if a transaction was read, false at the end of the statement.
+ */
+bool QifStatementParser::next(StatementRow &row)
+{
+    row = StatementRow();
+    QString payee;
+    QString memo;
+    bool hasFields = false;
+
+    while (!m_stream.atEnd()) {
+        QString line = m_stream.readLine().trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+
+        // Each line starts with a code naming its field.
+        QChar code = line.at(0);
+        QString value = line.mid(1).trimmed();
+
+        if (code == '^') {
+            // End of the record; skip records without a transaction.
+            if (hasFields && !row.date.isEmpty()) {
+                break;
+            }
+            row = StatementRow();
+            payee.clear();
+            memo.clear();
+            hasFields = false;
+            continue;
+        }
+
+        switch (code.unicode()) {
+        case 'D':
+            row.date = value;
+            break;
+        case 'T':
+            row.amount = value;
+            break;
+        case 'U':
+            // Some programs write the amount twice; T is preferred.
+            if (row.amount.isEmpty()) {
+                row.amount = value;
+            }
+            break;
+        case 'P':
+            payee = value;
+            break;
+        case 'M':
+            memo = value;
+            break;
+        case 'L':
+            // Transfers name an account in brackets rather than a category.
+            if (!value.startsWith('[')) {
+                row.category = value;
+            }
+            break;
+        default:
+            // Headers such as !Type:Bank and fields the ledger does not keep.
+            continue;
+        }
+        hasFields = true;
+    }
+
+    if (!hasFields || row.date.isEmpty()) {
+        return false;
+    }
+
+    row.recordNumber = ++m_recordNumber;
+    row.description = payee.isEmpty() ? memo : payee;
+    return true;
+}
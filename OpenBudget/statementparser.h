@@ -0,0 +1,108 @@
+#ifndef STATEMENTPARSER_H
+#define STATEMENTPARSER_H
+
+#include <QIODevice>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+#include <memory>
+
+// A transaction as written in a bank statement, before its fields are interpreted.
+struct StatementRow
+{
+    qint64 recordNumber = 0; // Position of the record in the statement, from 1.
+    QString date;
+    QString amount;
+    QString description;
+    QString category; // Category named by the statement, such as "Food:Groceries"; may be empty.
+};
+
+/**
+ * @brief The StatementParser class reads the transactions of a bank statement one record at
+ *        a time, so a statement of any size is parsed in constant memory.
+ */
+class StatementParser
+{
+public:
+    explicit StatementParser(QIODevice *device);
+    virtual ~StatementParser() = default;
+
+    // Create the parser for a statement file, chosen by its extension.
+    // Returns nullptr if the format is not supported.
+    static std::unique_ptr<StatementParser> create(QIODevice *device, const QString &fileName);
+
+    // Read the next transaction into row.
+    // Returns false at the end of the statement.
+    virtual bool next(StatementRow &row) = 0;
+
+protected:
+    QTextStream m_stream;      // The statement's text.
+    qint64 m_recordNumber = 0; // Number of records read.
+};
+
+/**
+ * @brief The CsvStatementParser class reads comma, semicolon or tab separated statements.
+ *        Columns are found by their header names; statements without a header are read as
+ *        date, description, amount.
+ */
+class CsvStatementParser : public StatementParser
+{
+public:
+    explicit CsvStatementParser(QIODevice *device);
+
+    bool next(StatementRow &row) override;
+
+private:
+    // Read the fields of the next record, which may span lines inside quotes.
+    bool readRecord(QStringList &fields);
+    // Find the columns from the header, or keep the header as the first record.
+    void readHeader();
+    // Field of a column, or an empty string if the column is missing.
+    static QString field(const QStringList &fields, int column);
+
+    QChar m_delimiter = ',';
+    bool m_headerRead = false;
+    QStringList m_pendingRecord; // First record when the statement has no header.
+    int m_dateColumn = 0;
+    int m_descriptionColumn = 1;
+    int m_amountColumn = 2;
+    int m_debitColumn = -1;
+    int m_creditColumn = -1;
+    int m_categoryColumn = -1;
+};
+
+/**
+ * @brief The OfxStatementParser class reads the STMTTRN records of OFX and QFX statements,
+ *        in both the SGML and the XML forms.
+ */
+class OfxStatementParser : public StatementParser
+{
+public:
+    explicit OfxStatementParser(QIODevice *device);
+
+    bool next(StatementRow &row) override;
+
+private:
+    // Read the next tag and the text that follows it.
+    bool nextElement(QString &tag, QString &value);
+    // Append the next chunk of the statement to the buffer.
+    bool readMore();
+
+    // Number of characters read at a time; the buffer stays near this size.
+    static constexpr qint64 CHUNK_SIZE = 16384;
+
+    QString m_buffer; // Text read but not yet parsed.
+};
+
+/**
+ * @brief The QifStatementParser class reads Quicken Interchange Format statements.
+ */
+class QifStatementParser : public StatementParser
+{
+public:
+    explicit QifStatementParser(QIODevice *device);
+
+    bool next(StatementRow &row) override;
+};
+
+#endif // STATEMENTPARSER_H
@@ -1,4 +1,5 @@
 #include "transaction.h"
+#include <utility>
 
 /**
  * @brief Default constructor creates empty Transaction object.
@@ -6,12 +7,13 @@
  * @return Transaction object.
  */
 Transaction::Transaction()
-    : m_amount{0.0}
+    : m_transactionID{0}
+    , m_amount{}
     , m_description{""}
-    , m_date{""}
+    , m_date{}
     , m_categoryID{0}
     , m_subcategoryID{0}
-    , m_balance{0.0}
+    , m_balance{}
     , m_userID{0}
     , m_isDeposit{false}
 {}
@@ -30,17 +32,17 @@ Transaction::Transaction()
  * @return Transaction object.
  */
 Transaction::Transaction(int transactionID,
-                         double amount,
+                         Money amount,
                          QString description,
-                         QString date,
+                         QDate date,
                          int categoryID,
                          int subcategoryID,
-                         double balance,
+                         Money balance,
                          int userID,
                          bool isDeposit)
     : m_transactionID{transactionID}
     , m_amount{amount}
-    , m_description{description}
+    , m_description{std::move(description)}
     , m_date{date}
     , m_categoryID{categoryID}
     , m_subcategoryID{subcategoryID}
@@ -61,15 +63,16 @@ Transaction::Transaction(int transactionID,
  * @param isDeposit Transaction is a deposit.
  * @return Transaction object.
  */
-Transaction::Transaction(double amount,
+Transaction::Transaction(Money amount,
                          QString description,
-                         QString date,
+                         QDate date,
                          int categoryID,
                          int subcategoryID,
                          int userID,
                          bool isDeposit)
-    : m_amount{amount}
-    , m_description{description}
+    : m_transactionID{0}
+    , m_amount{amount}
+    , m_description{std::move(description)}
     , m_date{date}
     , m_categoryID{categoryID}
     , m_subcategoryID{subcategoryID}
@@ -77,14 +80,6 @@ Transaction::Transaction(double amount,
     , m_isDeposit{isDeposit}
 {}
 
-/**
- * @brief Transaction destructor.
- */
-Transaction::~Transaction()
-{
-    delete this;
-}
-
 /**
  * @brief Getter for transactionID.
  * 
@@ -100,7 +95,7 @@ int Transaction::transactionID() const
  * 
  * @return Transaction amount.
  */
-double Transaction::amount() const
+Money Transaction::amount() const
 {
     return m_amount;
 }
@@ -120,7 +115,7 @@ QString Transaction::description() const
  * 
  * @return Transaction date.
  */
-QString Transaction::date() const
+QDate Transaction::date() const
 {
     return m_date;
 }
@@ -150,7 +145,7 @@ int Transaction::subcategoryID() const
  * 
  * @return Transaction balance.
  */
-double Transaction::balance() const
+Money Transaction::balance() const
 {
     return m_balance;
 }
@@ -175,6 +170,26 @@ bool Transaction::isDeposit() const
     return m_isDeposit;
 }
 
+/**
+ * @brief Getter for categoryName.
+ * 
+ * @return Transaction category name; empty unless loaded with the ledger.
+ */
+QString Transaction::categoryName() const
+{
+    return m_categoryName;
+}
+
+/**
+ * @brief Getter for subcategoryName.
+ * 
+ * @return Transaction subcategory name; empty unless loaded with the ledger.
+ */
+QString Transaction::subcategoryName() const
+{
+    return m_subcategoryName;
+}
+
 /**
  * @brief Setter for transactionID.
  * 
@@ -190,7 +205,7 @@ void Transaction::setTransactionID(const int &transactionID)
  * 
  * @param amount Transaction amount.
  */
-void Transaction::setAmount(const double &amount)
+void Transaction::setAmount(const Money &amount)
 {
     m_amount = amount;
 }
@@ -210,7 +225,7 @@ void Transaction::setDescription(const QString &description)
  * 
  * @param date Transaction date.
  */
-void Transaction::setDate(const QString &date)
+void Transaction::setDate(const QDate &date)
 {
     m_date = date;
 }
@@ -240,7 +255,7 @@ void Transaction::setSubcategoryID(const int &subcategoryID)
  * 
  * @param balance Transaction balance.
  */
-void Transaction::setBalance(const double &balance)
+void Transaction::setBalance(const Money &balance)
 {
     m_balance = balance;
 }
@@ -255,6 +270,26 @@ void Transaction::setUserID(const int &userID)
     m_userID = userID;
 }
 
+/**
+ * @brief Setter for categoryName.
+ * 
+ * @param categoryName Transaction category name.
+ */
+void Transaction::setCategoryName(const QString &categoryName)
+{
+    m_categoryName = categoryName;
+}
+
+/**
+ * @brief Setter for subcategoryName.
+ * 
+ * @param subcategoryName Transaction subcategory name.
+ */
+void Transaction::setSubcategoryName(const QString &subcategoryName)
+{
+    m_subcategoryName = subcategoryName;
+}
+
 /**
  * @brief Returns a string representation of the Transaction object.
  * 
@@ -264,12 +299,12 @@ QString Transaction::toString() const
 {
     QString transactionString;
     transactionString += "TransactionID: " + QString::number(m_transactionID) + " ";
-    transactionString += "Amount: " + QString::number(m_amount) + " ";
+    transactionString += "Amount: " + m_amount.toString() + " ";
     transactionString += "Desc: " + m_description + " ";
-    transactionString += "Date: " + m_date + " ";
+    transactionString += "Date: " + m_date.toString("MM/dd/yyyy") + " ";
     transactionString += "CategoryID: " + QString::number(m_categoryID) + " ";
     transactionString += "SubcategoryID: " + QString::number(m_subcategoryID) + " ";
-    transactionString += "Balance: " + QString::number(m_balance) + " ";
+    transactionString += "Balance: " + m_balance.toString() + " ";
     transactionString += "UserID: " + QString::number(m_userID) + " ";
     transactionString += "isDeposit: " + QString::number(m_isDeposit) + " ";
     return transactionString;
@@ -1,7 +1,9 @@
 #ifndef TRANSACTION_H
 #define TRANSACTION_H
 
+#include <QDate>
 #include <QString>
+#include "money.h"
 
 class Transaction
 {
@@ -9,58 +11,66 @@ public:
     Transaction();
     // Constructor for transactions retrieved from database.
     Transaction(int transactionID,
-                double amount,
+                Money amount,
                 QString description,
-                QString date,
+                QDate date,
                 int categoryID,
                 int subcategoryID,
-                double balance,
+                Money balance,
                 int userID,
                 bool isDeposit = false);
     // Constructor for transactions created by the user.
-    Transaction(double amount,
+    Transaction(Money amount,
                 QString description,
-                QString date,
+                QDate date,
                 int categoryID,
                 int subcategoryID,
                 int userID,
                 bool isDeposit = false);
-    ~Transaction();
 
     // Retrieve transaction details.
     int transactionID() const;
-    double amount() const;
+    Money amount() const;
     QString description() const;
-    QString date() const;
+    QDate date() const;
     int categoryID() const;
     int subcategoryID() const;
-    double balance() const;
+    Money balance() const;
     int userID() const;
     bool isDeposit() const;
+    QString categoryName() const;
+    QString subcategoryName() const;
 
     // Set transaction details.
     void setTransactionID(const int &transactionID);
-    void setAmount(const double &amount);
+    void setAmount(const Money &amount);
     void setDescription(const QString &description);
-    void setDate(const QString &date);
+    void setDate(const QDate &date);
     void setCategoryID(const int &categoryID);
     void setSubcategoryID(const int &subcategoryID);
-    void setBalance(const double &balance);
+    void setBalance(const Money &balance);
     void setUserID(const int &userID);
+    void setCategoryName(const QString &categoryName);
+    void setSubcategoryName(const QString &subcategoryName);
 
     // To string.
     QString toString() const;
 
 private:
     int m_transactionID;
-    double m_amount;
+    Money m_amount;
     QString m_description;
-    QString m_date;
+    QDate m_date;
     int m_categoryID;
     int m_subcategoryID;
-    double m_balance;
+    Money m_balance;
     int m_userID;
     bool m_isDeposit;
+    QString m_categoryName;
+    QString m_subcategoryName;
 };
 
+// Transactions are stored contiguously and moved with memcpy when a vector grows.
+Q_DECLARE_TYPEINFO(Transaction, Q_RELOCATABLE_TYPE);
+
 #endif // TRANSACTION_H
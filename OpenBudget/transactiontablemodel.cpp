@@ -0,0 +1,477 @@
+#include "transactiontablemodel.h"
+#include "asyncdatabase.h"
+#include <algorithm>
+
+/**
+ * @brief Table model for the user's ledger.
+ *
+ * @param parent Pointer to the parent object.
+ */
+TransactionTableModel::TransactionTableModel(QObject *parent)
+    : QAbstractTableModel{parent}
+{
+    // Apply the database's changes to the fetched rows.
+    connect(ChangeNotifier::getInstance(),
+            &ChangeNotifier::ledgerChanged,
+            this,
+            &TransactionTableModel::applyChange);
+}
+
+/**
+ * @brief Shows the user's transactions.
+ *        Rows are read from the database when the view fetches them.
+ *        A page still being read for the previous ledger is discarded when it arrives.
+ *
+ * @param userID The ID of the user.
+ * @param categoryID The ID of the category; -1 shows every category.
+ */
+void TransactionTableModel::load(int userID, int categoryID)
+{
+    reset(userID, categoryID, QString());
+}
+
+/**
+ * @brief Shows the user's transactions whose descriptions match a search.
+ *        Matches are read a page at a time, most relevant first, when the view fetches them.
+ *
+ * @param userID The ID of the user.
+ * @param text The search text.
+ */
+void TransactionTableModel::search(int userID, const QString &text)
+{
+    reset(userID, -1, text);
+}
+
+/**
+ * @brief Forgets the shown rows; the next fetch reads the new ledger or search.
+ *
+ * @param userID The ID of the user.
+ * @param categoryID The ID of the category; -1 shows every category.
+ * @param searchText The search text; empty shows the ledger.
+ */
+void TransactionTableModel::reset(int userID, int categoryID, const QString &searchText)
+{
+    beginResetModel();
+
+    // Forget the previous ledger.
+    m_userID = userID;
+    m_categoryID = categoryID;
+    m_searchText = searchText;
+    m_atEnd = false;
+    m_fetching = false;
+    ++m_generation;
+    m_rows.clear();
+    m_categoryNames.clear();
+    m_subcategoryNames.clear();
+
+    endResetModel();
+}
+
+/**
+ * @brief Number of rows fetched by the view.
+ *
+ * @param parent Parent index; only the root has rows.
+ * @return The number of fetched rows.
+ */
+int TransactionTableModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_rows.size();
+}
+
+/**
+ * @brief Number of columns in the ledger.
+ *
+ * @param parent Parent index; only the root has columns.
+ * @return The number of columns.
+ */
+int TransactionTableModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+/**
+ * @brief Produces the data for a cell when the view asks for it.
+ *        Amounts and balances are returned as Money and formatted by the CurrencyDelegate.
+ *
+ * @param index The cell.
+ * @param role The data role.
+ * @return The cell's data; an invalid QVariant if there is none.
+ */
+QVariant TransactionTableModel::data(const QModelIndex &index, int role) const
+{
+    // Only fetched rows have data.
+    if (!index.isValid() || index.row() >= m_rows.size() || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    const Row &row = m_rows.at(index.row());
+
+    switch (index.column()) {
+    case DateColumn:
+        return row.date.toString("MM/dd/yyyy");
+    case DescriptionColumn:
+        return row.description;
+    case CategoryColumn:
+        return m_categoryNames.value(row.categoryID);
+    case SubcategoryColumn:
+        return m_subcategoryNames.value(subcategoryKey(row.categoryID, row.subcategoryID));
+    case AmountColumn:
+        return QVariant::fromValue(row.amount);
+    case BalanceColumn:
+        return QVariant::fromValue(row.balance);
+    default:
+        return QVariant();
+    }
+}
+
+/**
+ * @brief Column headers for the ledger.
+ *
+ * @param section The column.
+ * @param orientation The header orientation.
+ * @param role The data role.
+ * @return The column's title.
+ */
+QVariant TransactionTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    // Only horizontal headers have titles.
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+
+    switch (section) {
+    case DateColumn:
+        return "Date";
+    case DescriptionColumn:
+        return "Description";
+    case CategoryColumn:
+        return "Category";
+    case SubcategoryColumn:
+        return "Subcategory";
+    case AmountColumn:
+        return "Amount";
+    case BalanceColumn:
+        return "Balance";
+    default:
+        return QVariant();
+    }
+}
+
+/**
+ * @brief Whether the ledger has rows the view has not fetched yet.
+ *
+ * @param parent Parent index; only the root has rows.
+ * @return true if more rows can be fetched, false otherwise.
+ */
+bool TransactionTableModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && !m_atEnd && !m_fetching;
+}
+
+/**
+ * @brief Requests the page of the ledger after the last fetched row.
+ *        The page is read on the database thread and appended when it arrives.
+ *
+ * @param parent Parent index; only the root has rows.
+ */
+void TransactionTableModel::fetchMore(const QModelIndex &parent)
+{
+    if (parent.isValid() || m_atEnd || m_fetching) {
+        return;
+    }
+
+    m_fetching = true;
+    int generation = m_generation;
+    AsyncDatabase *db = AsyncDatabase::getInstance();
+
+    // Search results are ranked, so continue after the number of fetched rows.
+    if (!m_searchText.isEmpty()) {
+        db->searchTransactions(m_userID, m_searchText, FETCH_SIZE, m_rows.size())
+            .then(this, [this, generation](const QVector<Transaction> &transactions) {
+                appendPage(generation, transactions);
+            });
+        return;
+    }
+
+    // Continue after the last fetched row.
+    LedgerCursor cursor;
+    if (!m_rows.isEmpty()) {
+        cursor.date = m_rows.constLast().date;
+        cursor.transactionID = m_rows.constLast().transactionID;
+    }
+
+    // Read the next page on a reader thread.
+    db->getLedgerPage(m_userID, m_categoryID, cursor, FETCH_SIZE)
+        .then(this, [this, generation](const QVector<Transaction> &transactions) {
+            appendPage(generation, transactions);
+        });
+}
+
+/**
+ * @brief Appends a page of the ledger read by fetchMore.
+ *
+ * @param generation The load the page was requested for.
+ * @param transactions The transactions of the page, in ledger order.
+ */
+void TransactionTableModel::appendPage(int generation, const QVector<Transaction> &transactions)
+{
+    // Discard pages requested before the ledger was reloaded.
+    if (generation != m_generation) {
+        return;
+    }
+    m_fetching = false;
+
+    // A short page is the end of the ledger.
+    m_atEnd = transactions.size() < FETCH_SIZE;
+    if (transactions.isEmpty()) {
+        return;
+    }
+
+    beginInsertRows(QModelIndex(), m_rows.size(), m_rows.size() + transactions.size() - 1);
+    m_rows.reserve(m_rows.size() + transactions.size());
+
+    // Copy each transaction into a compact row and record its names once.
+    for (const Transaction &transaction : transactions) {
+        m_rows.push_back({transaction.transactionID(),
+                          transaction.categoryID(),
+                          transaction.subcategoryID(),
+                          transaction.amount(),
+                          transaction.balance(),
+                          transaction.date(),
+                          transaction.description()});
+        addNames(transaction);
+    }
+
+    endInsertRows();
+}
+
+/**
+ * @brief Applies transactions inserted into or deleted from the shown ledger.
+ *        Only the fetched rows after the first change are visited: their balances are shifted
+ *        by the changes before them, deleted rows are removed and inserted rows are added where
+ *        they belong. Rows after the last fetched row arrive with later pages. Search results
+ *        are ranked rather than in ledger order, so a search is run again instead.
+ *        Pages are read on reader connections alongside the writes, so a page still being read
+ *        may predate the change; it is discarded and read again.
+ *
+ * @param change The changes, in ledger order.
+ */
+void TransactionTableModel::applyChange(const LedgerChange &change)
+{
+    // Only the shown user's ledger is affected.
+    if (change.userID != m_userID || change.changes.isEmpty()) {
+        return;
+    }
+
+    // Discard the page in flight; it may have been read before the change.
+    bool refetch = m_fetching;
+    if (refetch) {
+        ++m_generation;
+        m_fetching = false;
+    }
+
+    // Search results are not in ledger order; search again.
+    if (!m_searchText.isEmpty()) {
+        search(m_userID, m_searchText);
+        return;
+    }
+
+    // Find the rows to insert: those shown by the category filter within the fetched range.
+    QVector<const Transaction *> inserted;
+    for (const TransactionChange &transactionChange : change.changes) {
+        const Transaction &transaction = transactionChange.transaction;
+        if (transactionChange.kind != ChangeKind::Inserted
+            || (m_categoryID != -1 && transaction.categoryID() != m_categoryID)) {
+            continue;
+        }
+        if (!m_atEnd && lowerBound(transaction.date(), transaction.transactionID())
+                            == m_rows.size()) {
+            continue;
+        }
+        inserted.append(&transaction);
+    }
+
+    // A large batch, such as an import, is cheaper to read again a page at a time.
+    if (inserted.size() > FETCH_SIZE) {
+        load(m_userID, m_categoryID);
+        return;
+    }
+
+    // Shift the balances after the first change.
+    const TransactionChange &firstChange = change.changes.constFirst();
+    int first = lowerBound(firstChange.transaction.date(),
+                           firstChange.transaction.transactionID());
+    BalanceSweep sweep(change);
+    for (int i = first; i < m_rows.size(); ++i) {
+        Row &row = m_rows[i];
+        std::optional<Money> delta = sweep.deltaAt(row.date, row.transactionID);
+        std::optional<Money> balance = delta ? row.balance.checkedAdd(*delta) : std::nullopt;
+
+        // Balances that cannot be shifted exactly are read again.
+        if (!balance) {
+            load(m_userID, m_categoryID);
+            return;
+        }
+        row.balance = *balance;
+    }
+    if (first < m_rows.size()) {
+        emit dataChanged(index(first, BalanceColumn), index(m_rows.size() - 1, BalanceColumn));
+    }
+
+    // Remove the deleted rows.
+    for (const TransactionChange &transactionChange : change.changes) {
+        const Transaction &transaction = transactionChange.transaction;
+        if (transactionChange.kind != ChangeKind::Deleted) {
+            continue;
+        }
+        int row = lowerBound(transaction.date(), transaction.transactionID());
+        if (row < m_rows.size() && m_rows.at(row).transactionID == transaction.transactionID()) {
+            beginRemoveRows(QModelIndex(), row, row);
+            m_rows.remove(row);
+            endRemoveRows();
+        }
+    }
+
+    // Add the inserted rows with their stored balances.
+    for (const Transaction *transaction : std::as_const(inserted)) {
+        int row = lowerBound(transaction->date(), transaction->transactionID());
+        if (row < m_rows.size() && m_rows.at(row).transactionID == transaction->transactionID()) {
+            continue;
+        }
+        beginInsertRows(QModelIndex(), row, row);
+        m_rows.insert(row,
+                      {transaction->transactionID(),
+                       transaction->categoryID(),
+                       transaction->subcategoryID(),
+                       transaction->amount(),
+                       transaction->balance(),
+                       transaction->date(),
+                       transaction->description()});
+        addNames(*transaction);
+        endInsertRows();
+    }
+
+    // Read the discarded page again after the updated rows.
+    if (refetch) {
+        fetchMore(QModelIndex());
+    }
+}
+
+/**
+ * @brief Finds where a ledger position falls among the fetched rows.
+ *        Rows are in ledger order, by date and then by transaction ID.
+ *
+ * @param date The date of the position.
+ * @param transactionID The transaction ID of the position.
+ * @return The first row at or after the position; the row count if there is none.
+ */
+int TransactionTableModel::lowerBound(const QDate &date, int transactionID) const
+{
+    auto position = std::lower_bound(m_rows.cbegin(), m_rows.cend(), 0, [&](const Row &row, int) {
+        return row.date < date || (row.date == date && row.transactionID < transactionID);
+    });
+    return int(position - m_rows.cbegin());
+}
+
+/**
+ * @brief Records the names of a transaction's category and subcategory, once per ID.
+ *
+ * @param transaction The transaction, with its joined names.
+ */
+void TransactionTableModel::addNames(const Transaction &transaction)
+{
+    if (!m_categoryNames.contains(transaction.categoryID())) {
+        m_categoryNames.insert(transaction.categoryID(), transaction.categoryName());
+    }
+    qint64 key = subcategoryKey(transaction.categoryID(), transaction.subcategoryID());
+    if (!m_subcategoryNames.contains(key)) {
+        m_subcategoryNames.insert(key, transaction.subcategoryName());
+    }
+}
+
+/**
+ * @brief Getter for userID.
+ *
+ * @return The ID of the user whose ledger is shown.
+ */
+int TransactionTableModel::userID() const
+{
+    return m_userID;
+}
+
+/**
+ * @brief Getter for categoryID.
+ *
+ * @return The ID of the category shown; -1 for every category.
+ */
+int TransactionTableModel::categoryID() const
+{
+    return m_categoryID;
+}
+
+/**
+ * @brief Getter for a row's transactionID.
+ *
+ * @param row The row.
+ * @return Transaction ID.
+ */
+int TransactionTableModel::transactionID(int row) const
+{
+    return m_rows.at(row).transactionID;
+}
+
+/**
+ * @brief Getter for a row's date.
+ *
+ * @param row The row.
+ * @return Transaction date.
+ */
+QDate TransactionTableModel::date(int row) const
+{
+    return m_rows.at(row).date;
+}
+
+/**
+ * @brief Getter for a row's description.
+ *
+ * @param row The row.
+ * @return Transaction description.
+ */
+QString TransactionTableModel::description(int row) const
+{
+    return m_rows.at(row).description;
+}
+
+/**
+ * @brief Getter for a row's amount.
+ *
+ * @param row The row.
+ * @return Transaction amount.
+ */
+Money TransactionTableModel::amount(int row) const
+{
+    return m_rows.at(row).amount;
+}
+
+/**
+ * @brief Getter for a row's balance.
+ *
+ * @param row The row.
+ * @return Transaction balance.
+ */
+Money TransactionTableModel::balance(int row) const
+{
+    return m_rows.at(row).balance;
+}
+
+/**
+ * @brief Builds the key of a subcategory name.
+ *
+ * @param categoryID The ID of the parent category.
+ * @param subcategoryID The ID of the subcategory.
+ * @return The key.
+ */
+qint64 TransactionTableModel::subcategoryKey(int categoryID, int subcategoryID)
+{
+    return (qint64(categoryID) << 32) | quint32(subcategoryID);
+}
@@ -0,0 +1,106 @@
+#ifndef TRANSACTIONTABLEMODEL_H
+#define TRANSACTIONTABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QDate>
+#include <QHash>
+#include <QVector>
+#include "changenotifier.h"
+#include "money.h"
+#include "transaction.h"
+
+/**
+ * @brief The TransactionTableModel class exposes a user's ledger to a QTableView.
+ *        Rows are read from the database thread a page at a time as the view scrolls to them
+ *        and stored as compact typed records. Changes reported by the ChangeNotifier are
+ *        applied to the fetched rows in place.
+ */
+class TransactionTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    // Columns shown by the ledger view.
+    enum Column {
+        DateColumn,
+        DescriptionColumn,
+        CategoryColumn,
+        SubcategoryColumn,
+        AmountColumn,
+        BalanceColumn,
+        ColumnCount
+    };
+
+    explicit TransactionTableModel(QObject *parent = nullptr);
+
+    // Show the user's transactions; a categoryID of -1 shows every category.
+    void load(int userID, int categoryID = -1);
+
+    // Show the user's transactions whose descriptions match a search, most relevant first.
+    void search(int userID, const QString &text);
+
+    // QAbstractTableModel interface.
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section,
+                        Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+    // Retrieve row details.
+    int userID() const;
+    int categoryID() const;
+    int transactionID(int row) const;
+    QDate date(int row) const;
+    QString description(int row) const;
+    Money amount(int row) const;
+    Money balance(int row) const;
+
+private:
+    // Compact record for a single ledger row; names are stored once per ID.
+    struct Row
+    {
+        int transactionID;
+        int categoryID;
+        int subcategoryID;
+        Money amount;
+        Money balance;
+        QDate date;
+        QString description;
+    };
+
+    // Number of rows read from the database per fetch.
+    static constexpr int FETCH_SIZE = 256;
+
+    // Forget the shown rows and show another ledger or search.
+    void reset(int userID, int categoryID, const QString &searchText);
+
+    // Append a page read for the given load; pages of earlier loads are discarded.
+    void appendPage(int generation, const QVector<Transaction> &transactions);
+
+    // Apply inserted and deleted transactions to the fetched rows.
+    void applyChange(const LedgerChange &change);
+
+    // Get the first fetched row at or after a ledger position.
+    int lowerBound(const QDate &date, int transactionID) const;
+
+    // Record the names of a transaction's category and subcategory.
+    void addNames(const Transaction &transaction);
+
+    // Key for a subcategory name; subcategories are identified within their category.
+    static qint64 subcategoryKey(int categoryID, int subcategoryID);
+
+    int m_userID = 0;                          // The user whose ledger is shown.
+    int m_categoryID = -1;                     // The category shown; -1 for every category.
+    QString m_searchText;                      // The search shown; empty for the ledger.
+    bool m_atEnd = true;                       // Whether the last page has been read.
+    bool m_fetching = false;                   // Whether a page is being read.
+    int m_generation = 0;                      // Number of loads; identifies stale pages.
+    QVector<Row> m_rows;                       // Every fetched row.
+    QHash<int, QString> m_categoryNames;       // Category names by categoryID.
+    QHash<qint64, QString> m_subcategoryNames; // Subcategory names by subcategoryKey.
+};
+
+#endif // TRANSACTIONTABLEMODEL_H
@@ -1,4 +1,9 @@
 #include "user.h"
+#include <iterator>
+#include <utility>
+
+// Names of each Position, indexed by its value.
+static const char *const POSITION_NAMES[] = {"User", "Developer", "Admin"};
 
 /**
  * @brief Default constructor creates empty User object.
@@ -22,21 +27,11 @@ User::User()
  * @return User object.
  */
 User::User(QString firstName, QString lastName, Position position, int userID)
-    : m_firstName{firstName}
-    , m_lastName{lastName}
+    : m_firstName{std::move(firstName)}
+    , m_lastName{std::move(lastName)}
     , m_position{position}
     , m_userID{userID}
-{
-    m_positionName = m_positionNames[position];
-}
-
-/**
- * @brief User destructor.
- */
-User::~User()
-{
-    delete this;
-}
+{}
 
 /**
  * @brief Getter for firstName.
@@ -75,7 +70,11 @@ Position User::position() const
  */
 QString User::positionName() const
 {
-    return m_positionName;
+    int index = static_cast<int>(m_position);
+    if (index < 0 || index >= int(std::size(POSITION_NAMES))) {
+        return QString();
+    }
+    return QString::fromLatin1(POSITION_NAMES[index]);
 }
 
 /**
@@ -203,6 +202,6 @@ QString User::toString() const
     return QString("User: %1 %2 %3 %4")
         .arg(m_firstName)
         .arg(m_lastName)
-        .arg(m_positionName)
+        .arg(positionName())
         .arg(m_userID);
 }
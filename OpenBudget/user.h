@@ -3,7 +3,6 @@
 
 #include "position.h"
 #include <QString>
-#include <map>
 
 /**
  * @brief The User class contains the personal information of a User.
@@ -13,7 +12,6 @@ class User
 public:
     User();
     User(QString firstName, QString lastName, Position position, int userID);
-    ~User();
 
     // Retrieve user's attributes.
     QString firstName() const;
@@ -43,12 +41,9 @@ private:
     QString m_firstName;
     QString m_lastName;
     Position m_position;
-    QString m_positionName;
-    // Maps Position to QString representation.
-    std::map<Position, QString> m_positionNames = {{Position::User, "User"},
-                                                   {Position::Developer, "Developer"},
-                                                   {Position::Admin, "Admin"}};
     int m_userID;
 };
 
+Q_DECLARE_TYPEINFO(User, Q_RELOCATABLE_TYPE);
+
 #endif // USER_H
@@ -1,5 +1,10 @@
 #include "userlogin.h"
-#include <QCryptographicHash>
+#include "passwordhasher.h"
+#include <iterator>
+#include <utility>
+
+// Names of each AccessLevel, indexed by its value.
+static const char *const ACCESS_LEVEL_NAMES[] = {"Read", "Read/Write", "Read/Write/Delete"};
 
 /**
  * @brief Defaul constructor creates empty UserLogin object.
@@ -10,7 +15,6 @@ UserLogin::UserLogin()
     : m_username{""}
     , m_password{""}
     , m_accessLevel{0}
-    , m_accessLevelName{""}
     , m_email{""}
     , m_userID{0}
 
@@ -18,39 +22,27 @@ UserLogin::UserLogin()
 
 /**
  * @brief Stores the user's account login information.
+ *        Passwords are hashed with PasswordHasher before a login is built, off the GUI and
+ *        database threads, so a login only ever holds a stored hash.
  *
  * @param username The user's username.
- * @param password The user's password.
+ * @param password The hash of the user's password.
  * @param accessLevel The user's access level.
  * @param email The user's email address.
  * @param userID The user's userID.
- * @param newUser Whether or not the user is a new user.
  * @return UserLogin object.
  */
 UserLogin::UserLogin(QString username,
                      QString password,
                      AccessLevel accessLevel,
                      QString email,
-                     int userID,
-                     bool newUser)
-    : m_username{username}
+                     int userID)
+    : m_username{std::move(username)}
+    , m_password{std::move(password)}
     , m_accessLevel{accessLevel}
-    , m_email{email}
+    , m_email{std::move(email)}
     , m_userID{userID}
-{
-    // If a new user is being created, hash their password.
-    m_password = newUser ? hashPassword(password) : password;
-    // Convert access level to string.
-    m_accessLevelName = m_accessLevelNames[accessLevel];
-}
-
-/**
- * @brief UserLogin destructor.
- */
-UserLogin::~UserLogin()
-{
-    delete this;
-}
+{}
 
 /**
  * @brief Getter for username.
@@ -89,7 +81,11 @@ AccessLevel UserLogin::accessLevel() const
  */
 QString UserLogin::accessLevelName() const
 {
-    return m_accessLevelName;
+    int index = static_cast<int>(m_accessLevel);
+    if (index < 0 || index >= int(std::size(ACCESS_LEVEL_NAMES))) {
+        return QString();
+    }
+    return QString::fromLatin1(ACCESS_LEVEL_NAMES[index]);
 }
 
 /**
@@ -122,16 +118,6 @@ void UserLogin::setUsername(const QString &username)
     m_username = username;
 }
 
-/**
- * @brief Setter for password.
- *
- * @param password The user's password.
- */
-void UserLogin::setPassword(const QString &password)
-{
-    m_password = hashPassword(password);
-}
-
 /**
  * @brief Resets the user's password.
  *
@@ -173,14 +159,13 @@ void UserLogin::setUserID(const int &userID)
 }
 
 /**
- * @brief Checks if given password matches password of UserLogin object.
+ * @brief Checks if the stored password hash is legacy or much cheaper than new hashes.
  *
- * @param password The password to verify.
- * @return true if password matches, false otherwise.
+ * @return true if the password should be hashed again, false otherwise.
  */
-bool UserLogin::checkPassword(const QString &password) const
+bool UserLogin::needsRehash() const
 {
-    return (m_password == hashPassword(password));
+    return PasswordHasher::needsRehash(m_password);
 }
 
 /**
@@ -257,38 +242,6 @@ bool UserLogin::operator>=(const UserLogin &other) const
 QString UserLogin::toString() const
 {
     return QString("UserLogin: %1 %2 %3 %4 %5")
-        .arg(m_username, m_password, m_accessLevelName, m_email)
+        .arg(m_username, m_password, accessLevelName(), m_email)
         .arg(m_userID);
 }
-
-/**
- * @brief Hashes and salts password using MD5 hashing algorithm.
- * 
- * @param password The password to hash.
- * @return The hashed password.
- */
-QString UserLogin::hashPassword(const QString &password) const
-{
-    // Generate salt and append to password.
-    QString salt = generateSalt();
-    QString saltedPassword = password + salt;
-
-    // Hash salted password using MD5 hashing algorithm.
-    QString hashedPassword
-        = QCryptographicHash::hash(saltedPassword.toUtf8(), QCryptographicHash::Md5).toHex();
-
-    return hashedPassword;
-}
-
-/**
- * @brief Generates salt for password hashing.
- *
- * @return The generated salt.
- */
-QString UserLogin::generateSalt() const
-{
-    // Generate salt by adding 32 to userID.
-    QString salt = QString::number(m_userID + 32);
-
-    return salt;
-}